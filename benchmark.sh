@@ -7,6 +7,7 @@ SAMPLE_SIZES=0.001,0.01,0.1,1.0
 SOSD_DATASETS="data/books_200M_uint32:4 data/books_200M_uint64:8 data/fb_200M_uint64:8 data/osm_cellids_200M_uint64:8 data/wiki_ts_200M_uint64:8"
 SYNTH_DATASETS="data/consecutive_200M_uint64:8 data/gapped_1permill_200M_uint64:8 data/gapped_1percent_200M_uint64:8 data/gapped_10percent_200M_uint64:8"
 DATASETS="$SOSD_DATASETS $SYNTH_DATASETS"
+STRING_DATASETS="data/urls:newline data/emails:newline"
 
 # Stop on error & cd to script directory
 set -e
@@ -16,7 +17,7 @@ cd "$(dirname "$0")"
 ./build.sh
 
 # Ensure output directory exists
-mkdir -p results/{throughput_hash,throughput_learned,collisions_hash,collisions_learned,hashtable_hash,hashtable_learned}
+mkdir -p results/{throughput_hash,throughput_learned,collisions_hash,collisions_learned,drift_learned,hashtable_hash,hashtable_learned,filter_hash,hashtable_string,snapshot_hash}
 
 # Build with various compilers. SET THIS ACCORDING TO YOUR SYSTEM CONFIG
 for c in clang,clang++ gcc,g++
@@ -49,6 +50,13 @@ do
     --max-threads=${MAX_THREADS} \
     $DATASETS
 
+  benchmark/drift_learned-${2} \
+    --load-factors=${LOAD_FACTORS} \
+    --sample-sizes=${SAMPLE_SIZES} \
+    --outfile results/drift_learned/drift_learned-${2}.csv \
+    --max-threads=${MAX_THREADS} \
+    $DATASETS
+
   benchmark/throughput_hash-${2} \
     --outfile results/throughput_hash/throughput_hash-${2}.csv \
     --max-threads=${MAX_THREADS} \
@@ -59,4 +67,20 @@ do
     --sample-sizes=${SAMPLE_SIZES} \
     --max-threads=${MAX_THREADS} \
     $DATASETS
+
+  benchmark/filter_hash-${2} \
+    --outfile results/filter_hash/filter_hash-${2}.csv \
+    --max-threads=${MAX_THREADS} \
+    $DATASETS
+
+  benchmark/hashtable_string-${2} \
+    --outfile results/hashtable_string/hashtable_string-${2}.csv \
+    --max-threads=${MAX_THREADS} \
+    $STRING_DATASETS
+
+  benchmark/snapshot_hash-${2} \
+    --outfile results/snapshot_hash/snapshot_hash-${2}.csv \
+    --snapshot-dir=benchmark/snapshots \
+    --max-threads=${MAX_THREADS} \
+    $DATASETS
 done
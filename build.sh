@@ -31,10 +31,18 @@ do
   mv src/collisions_hash benchmark/collisions_hash-${2}
   cmake --build . --clean-first -DCMAKE_BUILD_TYPE=Release --target collisions_learned -j
   mv src/collisions_learned benchmark/collisions_learned-${2}
+  cmake --build . --clean-first -DCMAKE_BUILD_TYPE=Release --target drift_learned -j
+  mv src/drift_learned benchmark/drift_learned-${2}
   cmake --build . --clean-first -DCMAKE_BUILD_TYPE=Release --target hashtable_hash -j
   mv src/hashtable_hash benchmark/hashtable_hash-${2}
   cmake --build . --clean-first -DCMAKE_BUILD_TYPE=Release --target hashtable_learned -j
   mv src/hashtable_learned benchmark/hashtable_learned-${2}
+  cmake --build . --clean-first -DCMAKE_BUILD_TYPE=Release --target filter_hash -j
+  mv src/filter_hash benchmark/filter_hash-${2}
+  cmake --build . --clean-first -DCMAKE_BUILD_TYPE=Release --target hashtable_string -j
+  mv src/hashtable_string benchmark/hashtable_string-${2}
+  cmake --build . --clean-first -DCMAKE_BUILD_TYPE=Release --target snapshot_hash -j
+  mv src/snapshot_hash benchmark/snapshot_hash-${2}
 done
 
 # Leave clean slate (important for clion interop)
@@ -1,7 +1,10 @@
 #pragma once
 
+#include "include/aligned.hpp"
+#include "include/batch.hpp"
 #include "include/builtins.hpp"
 #include "include/cache.hpp"
+#include "include/cpu.hpp"
 #include "include/conversion.hpp"
 #include "include/math.hpp"
 #include "include/optimizer.hpp"
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/**
+ * Allocator returning Alignment aligned memory, e.g., to start arrays on a
+ * cache line boundary
+ */
+template<class T, size_t Alignment = 64>
+struct AlignedAllocator {
+   static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0);
+
+   using value_type = T;
+
+   template<class U>
+   struct rebind {
+      using other = AlignedAllocator<U, Alignment>;
+   };
+
+   AlignedAllocator() = default;
+
+   template<class U>
+   AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+   T* allocate(const size_t n) {
+      return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+   }
+
+   void deallocate(T* ptr, const size_t) {
+      ::operator delete(ptr, std::align_val_t(Alignment));
+   }
+
+   template<class U>
+   bool operator==(const AlignedAllocator<U, Alignment>&) const {
+      return true;
+   }
+};
+
+/**
+ * std::vector with cache line aligned storage
+ */
+template<class T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
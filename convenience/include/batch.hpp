@@ -0,0 +1,862 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// GCC 12 reports the _mm512_undefined_*() placeholder (__Y) of AVX-512 intrinsics as (maybe) uninitialized
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+
+#include "builtins.hpp"
+#include "cpu.hpp"
+#include "tidy.hpp"
+#include "types.hpp"
+
+/**
+ * Building blocks for batch kernels, e.g., hash_batch() and reduce_batch().
+ * Kernels are written once as generic lambdas over a vector type V (__m512i,
+ * __m256i or __m128i, each lane holding one 64-bit value) using the overloads
+ * below, for_each_lane() then instantiates them for every instruction set and
+ * runs the one selected by Cpu::isa().
+ *
+ * Overloads for instruction sets the build does not target (-march) carry a
+ * target attribute instead of being force inlined, see Cpu::runtime_dispatch.
+ * They are inlined into the lanes_*() dispatch targets below (flatten), hence
+ * never execute on CPUs lacking the respective instructions
+ */
+#define BATCH_TARGET_AVX512 "avx512f,avx512bw,avx512dq,avx512vl"
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512DQ__) && defined(__AVX512VL__)
+   #define BATCH_AVX512 forceinline
+   #define BATCH_DISPATCH_AVX512 forceinline
+#else
+   #define BATCH_AVX512 inline __attribute__((target(BATCH_TARGET_AVX512)))
+   #define BATCH_DISPATCH_AVX512 __attribute__((target(BATCH_TARGET_AVX512), flatten))
+#endif
+#ifdef __AVX2__
+   #define BATCH_AVX2 forceinline
+   #define BATCH_DISPATCH_AVX2 forceinline
+#else
+   #define BATCH_AVX2 inline __attribute__((target("avx2")))
+   #define BATCH_DISPATCH_AVX2 __attribute__((target("avx2"), flatten))
+#endif
+#ifdef __SSE4_2__
+   #define BATCH_SSE42 forceinline
+   #define BATCH_DISPATCH_SSE42 forceinline
+#else
+   #define BATCH_SSE42 inline __attribute__((target("sse4.2")))
+   #define BATCH_DISPATCH_SSE42 __attribute__((target("sse4.2"), flatten))
+#endif
+#if defined(__VAES__) && defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512DQ__) && \
+   defined(__AVX512VL__)
+   #define BATCH_VAES512 forceinline
+   #define BATCH_DISPATCH_VAES512 forceinline
+#else
+   #define BATCH_VAES512 inline __attribute__((target(BATCH_TARGET_AVX512 ",vaes,aes")))
+   #define BATCH_DISPATCH_VAES512 __attribute__((target(BATCH_TARGET_AVX512 ",vaes,aes"), flatten))
+#endif
+#if defined(__VAES__) && defined(__AVX2__)
+   #define BATCH_VAES256 forceinline
+   #define BATCH_DISPATCH_VAES256 forceinline
+#else
+   #define BATCH_VAES256 inline __attribute__((target("avx2,vaes,aes")))
+   #define BATCH_DISPATCH_VAES256 __attribute__((target("avx2,vaes,aes"), flatten))
+#endif
+#if defined(__AES__) && defined(__SSE4_2__)
+   #define BATCH_AES forceinline
+   #define BATCH_DISPATCH_AES forceinline
+#else
+   #define BATCH_AES inline __attribute__((target("sse4.2,aes")))
+   #define BATCH_DISPATCH_AES __attribute__((target("sse4.2,aes"), flatten))
+#endif
+// lanes() and blocks() must not be force inlined into their dispatch targets: GCC would
+// do so before flattening them, leaving the kernel's calls to target specific overloads
+#ifdef RUNTIME_DISPATCH
+   #define BATCH_LANES inline
+#else
+   #define BATCH_LANES forceinline
+#endif
+
+namespace Batch {
+   // AVX-512 overloads inline the intrinsics GCC 12 misreports, see <immintrin.h> above
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+   BATCH_AVX512 __m512i xor64(const __m512i& a, const __m512i& b) {
+      return _mm512_xor_si512(a, b);
+   }
+
+   BATCH_AVX512 __m512i and64(const __m512i& a, const __m512i& b) {
+      return _mm512_and_si512(a, b);
+   }
+
+   BATCH_AVX512 __m512i add64(const __m512i& a, const __m512i& b) {
+      return _mm512_add_epi64(a, b);
+   }
+
+   BATCH_AVX512 __m512i sub64(const __m512i& a, const __m512i& b) {
+      return _mm512_sub_epi64(a, b);
+   }
+
+   /// lower 32 bits of a times lower 32 bits of b
+   BATCH_AVX512 __m512i mul32(const __m512i& a, const __m512i& b) {
+      return _mm512_mul_epu32(a, b);
+   }
+
+   template<int Shift>
+   BATCH_AVX512 __m512i srli64(const __m512i& a) {
+      return _mm512_srli_epi64(a, Shift);
+   }
+
+   /// shift by a runtime amount, equal for all lanes
+   BATCH_AVX512 __m512i srl64(const __m512i& a, const int& shift) {
+      return _mm512_srl_epi64(a, _mm_cvtsi32_si128(shift));
+   }
+
+   template<int Shift>
+   BATCH_AVX512 __m512i slli64(const __m512i& a) {
+      return _mm512_slli_epi64(a, Shift);
+   }
+
+   template<int Rot>
+   BATCH_AVX512 __m512i rotl64(const __m512i& a) {
+      return _mm512_rol_epi64(a, Rot);
+   }
+
+   BATCH_AVX512 __m512i mullo64(const __m512i& a, const __m512i& b) {
+      // vpmullq
+      return _mm512_mullo_epi64(a, b);
+   }
+
+   BATCH_AVX512 __m512i gather64(const HASH_64* base, const __m512i& index) {
+      return _mm512_i64gather_epi64(index, reinterpret_cast<const void*>(base), sizeof(HASH_64));
+   }
+
+   /// gathers zero extended entries narrower than 64 bits. Loads 8 bytes per
+   /// entry, i.e., 8 - sizeof(E) bytes past each entry must be readable
+   template<class E>
+   BATCH_AVX512 __m512i gather_narrow(const E* base, const __m512i& index) {
+      static_assert(sizeof(E) < 8);
+      return _mm512_and_si512(_mm512_i64gather_epi64(index, reinterpret_cast<const void*>(base), sizeof(E)),
+                              _mm512_set1_epi64(static_cast<long long>((1ULL << (8 * sizeof(E))) - 1)));
+   }
+
+   BATCH_AVX512 void broadcast(__m512i& v, const std::uint64_t& c) {
+      v = _mm512_set1_epi64(static_cast<long long>(c));
+   }
+
+   /// loads 8 keys, zero extending 32-bit keys
+   template<class T>
+   BATCH_AVX512 void load(__m512i& v, const T* in) {
+      if constexpr (sizeof(T) == 8)
+         v = _mm512_loadu_si512(reinterpret_cast<const void*>(in));
+      else
+         v = _mm512_cvtepu32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in)));
+   }
+
+   BATCH_AVX512 void store(HASH_64* out, const __m512i& v) {
+      _mm512_storeu_si512(reinterpret_cast<void*>(out), v);
+   }
+
+   /// converts unsigned 64-bit lanes to double, rounding like static_cast<double>
+   BATCH_AVX512 __m512d cvt_f64(const __m512i& a) {
+      return _mm512_cvtepu64_pd(a);
+   }
+
+   /// truncates non-negative doubles to unsigned 64-bit lanes like static_cast<std::uint64_t>
+   BATCH_AVX512 __m512i cvt_index(const __m512d& a) {
+      return _mm512_cvttpd_epu64(a);
+   }
+
+   BATCH_AVX512 __m512d sub_f64(const __m512d& a, const __m512d& b) {
+      return _mm512_sub_pd(a, b);
+   }
+
+   BATCH_AVX512 __m512d mul_f64(const __m512d& a, const __m512d& b) {
+      return _mm512_mul_pd(a, b);
+   }
+
+   /// a * b + c, fused iff the build targets FMA (-march), i.e., rounds like
+   /// scalar code that uses std::fma under the same condition
+   BATCH_AVX512 __m512d fmadd_f64(const __m512d& a, const __m512d& b, const __m512d& c) {
+#ifdef __FMA__
+      return _mm512_fmadd_pd(a, b, c);
+#else
+      return _mm512_add_pd(_mm512_mul_pd(a, b), c);
+#endif
+   }
+
+   /// lanes where c is zero are taken from if_zero, all others from otherwise
+   BATCH_AVX512 __m512d blend_zero_f64(const __m512i& c, const __m512d& if_zero, const __m512d& otherwise) {
+      return _mm512_mask_blend_pd(_mm512_cmpeq_epi64_mask(c, _mm512_setzero_si512()), otherwise, if_zero);
+   }
+
+   BATCH_AVX512 __m512d min_f64(const __m512d& a, const __m512d& b) {
+      return _mm512_min_pd(a, b);
+   }
+
+   BATCH_AVX512 __m512d max_f64(const __m512d& a, const __m512d& b) {
+      return _mm512_max_pd(a, b);
+   }
+
+   BATCH_AVX512 __m512d gather_f64(const double* base, const __m512i& index) {
+      return _mm512_i64gather_pd(index, reinterpret_cast<const void*>(base), sizeof(double));
+   }
+
+   BATCH_AVX512 void broadcast(__m512d& v, const double& c) {
+      v = _mm512_set1_pd(c);
+   }
+#pragma GCC diagnostic pop
+
+   BATCH_AVX2 __m256i xor64(const __m256i& a, const __m256i& b) {
+      return _mm256_xor_si256(a, b);
+   }
+
+   BATCH_AVX2 __m256i and64(const __m256i& a, const __m256i& b) {
+      return _mm256_and_si256(a, b);
+   }
+
+   BATCH_AVX2 __m256i add64(const __m256i& a, const __m256i& b) {
+      return _mm256_add_epi64(a, b);
+   }
+
+   BATCH_AVX2 __m256i sub64(const __m256i& a, const __m256i& b) {
+      return _mm256_sub_epi64(a, b);
+   }
+
+   /// lower 32 bits of a times lower 32 bits of b
+   BATCH_AVX2 __m256i mul32(const __m256i& a, const __m256i& b) {
+      return _mm256_mul_epu32(a, b);
+   }
+
+   template<int Shift>
+   BATCH_AVX2 __m256i srli64(const __m256i& a) {
+      return _mm256_srli_epi64(a, Shift);
+   }
+
+   /// shift by a runtime amount, equal for all lanes
+   BATCH_AVX2 __m256i srl64(const __m256i& a, const int& shift) {
+      return _mm256_srl_epi64(a, _mm_cvtsi32_si128(shift));
+   }
+
+   template<int Shift>
+   BATCH_AVX2 __m256i slli64(const __m256i& a) {
+      return _mm256_slli_epi64(a, Shift);
+   }
+
+   template<int Rot>
+   BATCH_AVX2 __m256i rotl64(const __m256i& a) {
+      return _mm256_or_si256(_mm256_slli_epi64(a, Rot), _mm256_srli_epi64(a, 64 - Rot));
+   }
+
+   BATCH_AVX2 __m256i mullo64(const __m256i& a, const __m256i& b) {
+#if defined(__AVX512DQ__) && defined(__AVX512VL__)
+      return _mm256_mullo_epi64(a, b);
+#else
+      // AVX2 lacks 64-bit multiplication: lo(a)*lo(b) + ((hi(a)*lo(b) + lo(a)*hi(b)) << 32)
+      const auto lo = _mm256_mul_epu32(a, b);
+      const auto cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+                                          _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+      return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+#endif
+   }
+
+   BATCH_AVX2 __m256i gather64(const HASH_64* base, const __m256i& index) {
+      return _mm256_i64gather_epi64(reinterpret_cast<const long long*>(base), index, sizeof(HASH_64));
+   }
+
+   template<class E>
+   BATCH_AVX2 __m256i gather_narrow(const E* base, const __m256i& index) {
+      static_assert(sizeof(E) < 8);
+      return _mm256_and_si256(_mm256_i64gather_epi64(reinterpret_cast<const long long*>(base), index, sizeof(E)),
+                              _mm256_set1_epi64x(static_cast<long long>((1ULL << (8 * sizeof(E))) - 1)));
+   }
+
+   BATCH_AVX2 void broadcast(__m256i& v, const std::uint64_t& c) {
+      v = _mm256_set1_epi64x(static_cast<long long>(c));
+   }
+
+   /// loads 4 keys, zero extending 32-bit keys
+   template<class T>
+   BATCH_AVX2 void load(__m256i& v, const T* in) {
+      if constexpr (sizeof(T) == 8)
+         v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+      else
+         v = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)));
+   }
+
+   BATCH_AVX2 void store(HASH_64* out, const __m256i& v) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), v);
+   }
+
+   BATCH_AVX2 __m256d cvt_f64(const __m256i& a) {
+      // AVX2 lacks 64-bit integer conversion: (2^84 + hi * 2^32) - (2^84 + 2^52) + (2^52 + lo), rounding once
+      const auto lo = _mm256_or_si256(_mm256_and_si256(a, _mm256_set1_epi64x(0xFFFFFFFF)),
+                                      _mm256_castpd_si256(_mm256_set1_pd(0x1p52)));
+      const auto hi = _mm256_or_si256(_mm256_srli_epi64(a, 32), _mm256_castpd_si256(_mm256_set1_pd(0x1p84)));
+      return _mm256_add_pd(_mm256_sub_pd(_mm256_castsi256_pd(hi), _mm256_set1_pd(0x1.00000001p84)),
+                           _mm256_castsi256_pd(lo));
+   }
+
+   /// only valid for a < 2^52
+   BATCH_AVX2 __m256i cvt_index(const __m256d& a) {
+      const auto magic = _mm256_set1_pd(0x1p52);
+      const auto truncated = _mm256_round_pd(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+      return _mm256_xor_si256(_mm256_castpd_si256(_mm256_add_pd(truncated, magic)), _mm256_castpd_si256(magic));
+   }
+
+   BATCH_AVX2 __m256d sub_f64(const __m256d& a, const __m256d& b) {
+      return _mm256_sub_pd(a, b);
+   }
+
+   BATCH_AVX2 __m256d mul_f64(const __m256d& a, const __m256d& b) {
+      return _mm256_mul_pd(a, b);
+   }
+
+   BATCH_AVX2 __m256d fmadd_f64(const __m256d& a, const __m256d& b, const __m256d& c) {
+#ifdef __FMA__
+      return _mm256_fmadd_pd(a, b, c);
+#else
+      return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+#endif
+   }
+
+   BATCH_AVX2 __m256d blend_zero_f64(const __m256i& c, const __m256d& if_zero, const __m256d& otherwise) {
+      return _mm256_blendv_pd(otherwise, if_zero, _mm256_castsi256_pd(_mm256_cmpeq_epi64(c, _mm256_setzero_si256())));
+   }
+
+   BATCH_AVX2 __m256d min_f64(const __m256d& a, const __m256d& b) {
+      return _mm256_min_pd(a, b);
+   }
+
+   BATCH_AVX2 __m256d max_f64(const __m256d& a, const __m256d& b) {
+      return _mm256_max_pd(a, b);
+   }
+
+   BATCH_AVX2 __m256d gather_f64(const double* base, const __m256i& index) {
+      return _mm256_i64gather_pd(base, index, sizeof(double));
+   }
+
+   BATCH_AVX2 void broadcast(__m256d& v, const double& c) {
+      v = _mm256_set1_pd(c);
+   }
+
+   BATCH_SSE42 __m128i xor64(const __m128i& a, const __m128i& b) {
+      return _mm_xor_si128(a, b);
+   }
+
+   BATCH_SSE42 __m128i and64(const __m128i& a, const __m128i& b) {
+      return _mm_and_si128(a, b);
+   }
+
+   BATCH_SSE42 __m128i add64(const __m128i& a, const __m128i& b) {
+      return _mm_add_epi64(a, b);
+   }
+
+   BATCH_SSE42 __m128i sub64(const __m128i& a, const __m128i& b) {
+      return _mm_sub_epi64(a, b);
+   }
+
+   /// lower 32 bits of a times lower 32 bits of b
+   BATCH_SSE42 __m128i mul32(const __m128i& a, const __m128i& b) {
+      return _mm_mul_epu32(a, b);
+   }
+
+   template<int Shift>
+   BATCH_SSE42 __m128i srli64(const __m128i& a) {
+      return _mm_srli_epi64(a, Shift);
+   }
+
+   /// shift by a runtime amount, equal for all lanes
+   BATCH_SSE42 __m128i srl64(const __m128i& a, const int& shift) {
+      return _mm_srl_epi64(a, _mm_cvtsi32_si128(shift));
+   }
+
+   template<int Shift>
+   BATCH_SSE42 __m128i slli64(const __m128i& a) {
+      return _mm_slli_epi64(a, Shift);
+   }
+
+   template<int Rot>
+   BATCH_SSE42 __m128i rotl64(const __m128i& a) {
+      return _mm_or_si128(_mm_slli_epi64(a, Rot), _mm_srli_epi64(a, 64 - Rot));
+   }
+
+   BATCH_SSE42 __m128i mullo64(const __m128i& a, const __m128i& b) {
+      // see AVX2 variant
+      const auto lo = _mm_mul_epu32(a, b);
+      const auto cross =
+         _mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(a, 32), b), _mm_mul_epu32(a, _mm_srli_epi64(b, 32)));
+      return _mm_add_epi64(lo, _mm_slli_epi64(cross, 32));
+   }
+
+   /// SSE lacks gather instructions, i.e., this performs two scalar loads
+   BATCH_SSE42 __m128i gather64(const HASH_64* base, const __m128i& index) {
+      return _mm_set_epi64x(static_cast<long long>(base[_mm_extract_epi64(index, 1)]),
+                            static_cast<long long>(base[_mm_cvtsi128_si64(index)]));
+   }
+
+   template<class E>
+   BATCH_SSE42 __m128i gather_narrow(const E* base, const __m128i& index) {
+      return _mm_set_epi64x(static_cast<long long>(base[_mm_extract_epi64(index, 1)]),
+                            static_cast<long long>(base[_mm_cvtsi128_si64(index)]));
+   }
+
+   BATCH_SSE42 void broadcast(__m128i& v, const std::uint64_t& c) {
+      v = _mm_set1_epi64x(static_cast<long long>(c));
+   }
+
+   /// loads 2 keys, zero extending 32-bit keys
+   template<class T>
+   BATCH_SSE42 void load(__m128i& v, const T* in) {
+      if constexpr (sizeof(T) == 8)
+         v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+      else
+         v = _mm_cvtepu32_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in)));
+   }
+
+   BATCH_SSE42 void store(HASH_64* out, const __m128i& v) {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out), v);
+   }
+
+   BATCH_SSE42 __m128d cvt_f64(const __m128i& a) {
+      // see the AVX2 overload
+      const auto lo =
+         _mm_or_si128(_mm_and_si128(a, _mm_set1_epi64x(0xFFFFFFFF)), _mm_castpd_si128(_mm_set1_pd(0x1p52)));
+      const auto hi = _mm_or_si128(_mm_srli_epi64(a, 32), _mm_castpd_si128(_mm_set1_pd(0x1p84)));
+      return _mm_add_pd(_mm_sub_pd(_mm_castsi128_pd(hi), _mm_set1_pd(0x1.00000001p84)), _mm_castsi128_pd(lo));
+   }
+
+   /// only valid for a < 2^52
+   BATCH_SSE42 __m128i cvt_index(const __m128d& a) {
+      const auto magic = _mm_set1_pd(0x1p52);
+      const auto truncated = _mm_round_pd(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+      return _mm_xor_si128(_mm_castpd_si128(_mm_add_pd(truncated, magic)), _mm_castpd_si128(magic));
+   }
+
+   BATCH_SSE42 __m128d sub_f64(const __m128d& a, const __m128d& b) {
+      return _mm_sub_pd(a, b);
+   }
+
+   BATCH_SSE42 __m128d mul_f64(const __m128d& a, const __m128d& b) {
+      return _mm_mul_pd(a, b);
+   }
+
+   BATCH_SSE42 __m128d fmadd_f64(const __m128d& a, const __m128d& b, const __m128d& c) {
+#ifdef __FMA__
+      return _mm_fmadd_pd(a, b, c);
+#else
+      return _mm_add_pd(_mm_mul_pd(a, b), c);
+#endif
+   }
+
+   BATCH_SSE42 __m128d blend_zero_f64(const __m128i& c, const __m128d& if_zero, const __m128d& otherwise) {
+      return _mm_blendv_pd(otherwise, if_zero, _mm_castsi128_pd(_mm_cmpeq_epi64(c, _mm_setzero_si128())));
+   }
+
+   BATCH_SSE42 __m128d min_f64(const __m128d& a, const __m128d& b) {
+      return _mm_min_pd(a, b);
+   }
+
+   BATCH_SSE42 __m128d max_f64(const __m128d& a, const __m128d& b) {
+      return _mm_max_pd(a, b);
+   }
+
+   /// SSE lacks gather instructions, i.e., this performs two scalar loads
+   BATCH_SSE42 __m128d gather_f64(const double* base, const __m128i& index) {
+      return _mm_set_pd(base[_mm_extract_epi64(index, 1)], base[_mm_cvtsi128_si64(index)]);
+   }
+
+   BATCH_SSE42 void broadcast(__m128d& v, const double& c) {
+      v = _mm_set1_pd(c);
+   }
+
+   /*
+    * Block primitives for kernels operating on independent 128-bit blocks, one
+    * key per block (see for_each_block()), e.g., AES rounds. __m512i and __m256i
+    * variants require VAES, the __m128i variants AES-NI
+    */
+
+   /// one AES encryption round on each block
+   BATCH_VAES512 __m512i aesenc(const __m512i& a, const __m512i& round_key) {
+      return _mm512_aesenc_epi128(a, round_key);
+   }
+
+   /// one AES decryption round on each block
+   BATCH_VAES512 __m512i aesdec(const __m512i& a, const __m512i& round_key) {
+      return _mm512_aesdec_epi128(a, round_key);
+   }
+
+   /// byte shift of each block
+   template<int Bytes>
+   BATCH_VAES512 __m512i bslli128(const __m512i& a) {
+      return _mm512_bslli_epi128(a, Bytes);
+   }
+
+   template<int Bytes>
+   BATCH_VAES512 __m512i bsrli128(const __m512i& a) {
+      return _mm512_bsrli_epi128(a, Bytes);
+   }
+
+   /// (hi, lo) in every block
+   BATCH_VAES512 void broadcast128(__m512i& v, const std::uint64_t& hi, const std::uint64_t& lo) {
+      v = _mm512_broadcast_i32x4(_mm_set_epi64x(static_cast<long long>(hi), static_cast<long long>(lo)));
+   }
+
+   /// loads 4 keys, zero extending each to a block
+   template<class T>
+   BATCH_VAES512 void load_blocks(__m512i& v, const T* in) {
+      __m256i keys;
+      if constexpr (sizeof(T) == 8)
+         keys = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+      else
+         keys = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)));
+      // qword 4 of the zero extended register is zero
+      v = _mm512_permutexvar_epi64(_mm512_set_epi64(4, 3, 4, 2, 4, 1, 4, 0), _mm512_zextsi256_si512(keys));
+   }
+
+   /// stores the lower 64 bits of each block
+   BATCH_VAES512 void store_blocks(HASH_64* out, const __m512i& v) {
+      const auto lo = _mm512_permutexvar_epi64(_mm512_set_epi64(6, 4, 2, 0, 6, 4, 2, 0), v);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm512_castsi512_si256(lo));
+   }
+
+   BATCH_VAES256 __m256i aesenc(const __m256i& a, const __m256i& round_key) {
+      return _mm256_aesenc_epi128(a, round_key);
+   }
+
+   BATCH_VAES256 __m256i aesdec(const __m256i& a, const __m256i& round_key) {
+      return _mm256_aesdec_epi128(a, round_key);
+   }
+
+   template<int Bytes>
+   BATCH_VAES256 __m256i bslli128(const __m256i& a) {
+      return _mm256_bslli_epi128(a, Bytes);
+   }
+
+   template<int Bytes>
+   BATCH_VAES256 __m256i bsrli128(const __m256i& a) {
+      return _mm256_bsrli_epi128(a, Bytes);
+   }
+
+   BATCH_VAES256 void broadcast128(__m256i& v, const std::uint64_t& hi, const std::uint64_t& lo) {
+      v = _mm256_set_epi64x(static_cast<long long>(hi), static_cast<long long>(lo), static_cast<long long>(hi),
+                            static_cast<long long>(lo));
+   }
+
+   /// loads 2 keys, zero extending each to a block
+   template<class T>
+   BATCH_VAES256 void load_blocks(__m256i& v, const T* in) {
+      __m128i keys;
+      if constexpr (sizeof(T) == 8)
+         keys = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+      else
+         keys = _mm_cvtepu32_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in)));
+      v = _mm256_permute4x64_epi64(_mm256_zextsi128_si256(keys), _MM_SHUFFLE(2, 1, 2, 0));
+   }
+
+   BATCH_VAES256 void store_blocks(HASH_64* out, const __m256i& v) {
+      const auto lo = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(2, 0, 2, 0));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(lo));
+   }
+
+   BATCH_AES __m128i aesenc(const __m128i& a, const __m128i& round_key) {
+      return _mm_aesenc_si128(a, round_key);
+   }
+
+   BATCH_AES __m128i aesdec(const __m128i& a, const __m128i& round_key) {
+      return _mm_aesdec_si128(a, round_key);
+   }
+
+   template<int Bytes>
+   BATCH_AES __m128i bslli128(const __m128i& a) {
+      return _mm_slli_si128(a, Bytes);
+   }
+
+   template<int Bytes>
+   BATCH_AES __m128i bsrli128(const __m128i& a) {
+      return _mm_srli_si128(a, Bytes);
+   }
+
+   BATCH_AES void broadcast128(__m128i& v, const std::uint64_t& hi, const std::uint64_t& lo) {
+      v = _mm_set_epi64x(static_cast<long long>(hi), static_cast<long long>(lo));
+   }
+
+   /// loads 1 key, zero extended to a block
+   template<class T>
+   BATCH_AES void load_blocks(__m128i& v, const T* in) {
+      v = _mm_cvtsi64_si128(static_cast<long long>(*in));
+   }
+
+   BATCH_AES void store_blocks(HASH_64* out, const __m128i& v) {
+      *out = static_cast<HASH_64>(_mm_cvtsi128_si64(v));
+   }
+
+   /**
+    * @return vector of type V with c in every lane
+    */
+   template<class V>
+   forceinline V set1(const std::uint64_t& c) {
+      V v;
+      broadcast(v, c);
+      return v;
+   }
+
+   /**
+    * Double precision vector with as many lanes as the integer vector V, i.e.,
+    * __m128d, __m256d and __m512d for __m128i, __m256i and __m512i. Selected by
+    * width since naming vector types as template arguments drops their
+    * attributes (-Wignored-attributes)
+    */
+   template<class V, size_t Bytes = sizeof(V)>
+   struct f64_of;
+
+   template<class V>
+   struct f64_of<V, 16> {
+      using type = __m128d;
+   };
+
+   template<class V>
+   struct f64_of<V, 32> {
+      using type = __m256d;
+   };
+
+   template<class V>
+   struct f64_of<V, 64> {
+      using type = __m512d;
+   };
+
+   template<class V>
+   using F64 = typename f64_of<V>::type;
+
+   /**
+    * @return double precision vector with as many lanes as V and c in every lane
+    */
+   template<class V>
+   forceinline F64<V> set1_f64(const double& c) {
+      F64<V> v;
+      broadcast(v, c);
+      return v;
+   }
+
+   /**
+    * @return vector of type V with (hi, lo) in every 128-bit block
+    */
+   template<class V>
+   forceinline V set128(const std::uint64_t& hi, const std::uint64_t& lo) {
+      V v;
+      broadcast128(v, hi, lo);
+      return v;
+   }
+
+   /**
+    * Upper 64 bits of the 128-bit product a * b, composed of four 32x32 bit
+    * multiplications since neither SSE, AVX2 nor AVX-512 offer a 64-bit mulhi
+    */
+   template<class V>
+   forceinline V mulhi64(const V& a, const V& b) {
+      const auto lo_mask = set1<V>(0xFFFFFFFF);
+      const auto a_hi = srli64<32>(a);
+      const auto b_hi = srli64<32>(b);
+
+      const auto ll = mul32(a, b);
+      const auto t = add64(mul32(a_hi, b), srli64<32>(ll));
+      const auto u = add64(mul32(a, b_hi), and64(t, lo_mask));
+      return add64(add64(mul32(a_hi, b_hi), srli64<32>(t)), srli64<32>(u));
+   }
+
+   /**
+    * Applies kernel to as many whole vectors of type V as fit into n values
+    *
+    * @return amount of values processed
+    */
+   template<class V, class T, class Kernel>
+   BATCH_LANES size_t lanes(const T* in, HASH_64* out, const size_t& n, const Kernel& kernel) {
+      constexpr size_t width = sizeof(V) / sizeof(HASH_64);
+
+      size_t i = 0;
+      for (; i + width <= n; i += width) {
+         V keys;
+         load(keys, in + i);
+         store(out + i, kernel(keys));
+      }
+      return i;
+   }
+
+   template<class T, class Kernel>
+   BATCH_DISPATCH_AVX512 size_t lanes_avx512(const T* in, HASH_64* out, const size_t& n, const Kernel& kernel) {
+      return lanes<__m512i>(in, out, n, kernel);
+   }
+
+   template<class T, class Kernel>
+   BATCH_DISPATCH_AVX2 size_t lanes_avx2(const T* in, HASH_64* out, const size_t& n, const Kernel& kernel) {
+      return lanes<__m256i>(in, out, n, kernel);
+   }
+
+   template<class T, class Kernel>
+   BATCH_DISPATCH_SSE42 size_t lanes_sse42(const T* in, HASH_64* out, const size_t& n, const Kernel& kernel) {
+      return lanes<__m128i>(in, out, n, kernel);
+   }
+
+   /**
+    * Applies a vectorized kernel to n values, values of the tail that does not
+    * fill a whole vector are processed by scalar. 32-bit values are zero
+    * extended to 64-bit lanes, i.e., kernels always operate on 64-bit lanes.
+    *
+    * Without runtime dispatch, only the kernel for Cpu::static_isa() is
+    * instantiated and called directly. Otherwise one kernel per instruction
+    * set is compiled and Cpu::isa() selects amongst them per call
+    *
+    * @param in values, e.g., keys or hashes
+    * @param out results, out[i] = scalar(in[i]). May alias in
+    * @param n amount of values
+    * @param kernel generic lambda, V(V) for each vector type V
+    * @param scalar scalar counterpart of kernel
+    */
+   template<class T, class Kernel, class Scalar>
+   forceinline void for_each_lane(const T* in, HASH_64* out, const size_t& n, const Kernel& kernel,
+                                  const Scalar& scalar) {
+      static_assert(sizeof(T) == 4 || sizeof(T) == 8, "lanes hold 32 or 64-bit keys");
+      size_t i = 0;
+
+      if constexpr (!Cpu::runtime_dispatch) {
+         if constexpr (Cpu::static_isa() == Cpu::ISA::AVX512)
+            i = lanes<__m512i>(in, out, n, kernel);
+         else if constexpr (Cpu::static_isa() == Cpu::ISA::AVX2)
+            i = lanes<__m256i>(in, out, n, kernel);
+         else if constexpr (Cpu::static_isa() == Cpu::ISA::SSE42)
+            i = lanes<__m128i>(in, out, n, kernel);
+         else
+            UNUSED(kernel);
+      } else {
+         switch (Cpu::isa()) {
+            case Cpu::ISA::AVX512:
+               i = lanes_avx512(in, out, n, kernel);
+               break;
+            case Cpu::ISA::AVX2:
+               i = lanes_avx2(in, out, n, kernel);
+               break;
+            case Cpu::ISA::SSE42:
+               i = lanes_sse42(in, out, n, kernel);
+               break;
+            case Cpu::ISA::Scalar:
+               break;
+         }
+      }
+
+      for (; i < n; i++)
+         out[i] = scalar(in[i]);
+   }
+
+   /**
+    * Applies kernel to as many whole vectors of blocks as fit into n keys, see
+    * for_each_block(). Unroll vectors are processed at once, i.e., the
+    * kernel's dependency chains are interleaved Unroll times
+    *
+    * @return amount of keys processed
+    */
+   template<class V, size_t Unroll, class T, class Kernel>
+   BATCH_LANES size_t blocks(const T* in, HASH_64* out, const size_t& n, const Kernel& kernel) {
+      constexpr size_t width = sizeof(V) / 16;
+
+      size_t i = 0;
+      for (; i + Unroll * width <= n; i += Unroll * width) {
+         V b[Unroll];
+         for (size_t u = 0; u < Unroll; u++)
+            load_blocks(b[u], in + i + u * width);
+         for (size_t u = 0; u < Unroll; u++)
+            b[u] = kernel(b[u]);
+         for (size_t u = 0; u < Unroll; u++)
+            store_blocks(out + i + u * width, b[u]);
+      }
+      for (; i + width <= n; i += width) {
+         V b;
+         load_blocks(b, in + i);
+         store_blocks(out + i, kernel(b));
+      }
+      return i;
+   }
+
+   template<size_t Unroll, class T, class Kernel>
+   BATCH_DISPATCH_VAES512 size_t blocks_vaes512(const T* in, HASH_64* out, const size_t& n, const Kernel& kernel) {
+      return blocks<__m512i, Unroll>(in, out, n, kernel);
+   }
+
+   template<size_t Unroll, class T, class Kernel>
+   BATCH_DISPATCH_VAES256 size_t blocks_vaes256(const T* in, HASH_64* out, const size_t& n, const Kernel& kernel) {
+      return blocks<__m256i, Unroll>(in, out, n, kernel);
+   }
+
+   template<size_t Unroll, class T, class Kernel>
+   BATCH_DISPATCH_AES size_t blocks_aes(const T* in, HASH_64* out, const size_t& n, const Kernel& kernel) {
+      return blocks<__m128i, Unroll>(in, out, n, kernel);
+   }
+
+   /**
+    * Counterpart of for_each_lane() for kernels operating on 128-bit blocks,
+    * e.g., AES based hash functions. Each key is zero extended to its own
+    * block and the kernel's result is expected in the lower 64 bits of each
+    * block. Runs 4 (VAES + AVX-512), 2 (VAES + AVX2) or 1 (AES-NI) key(s) per
+    * vector, CPUs without AES-NI only execute scalar
+    *
+    * @tparam Unroll amount of independent vectors in flight, see blocks()
+    * @param in keys
+    * @param out results, out[i] = scalar(in[i]). May alias in
+    * @param n amount of keys
+    * @param kernel generic lambda, V(V) for each vector type V
+    * @param scalar scalar counterpart of kernel
+    */
+   template<size_t Unroll = 4, class T, class Kernel, class Scalar>
+   forceinline void for_each_block(const T* in, HASH_64* out, const size_t& n, const Kernel& kernel,
+                                   const Scalar& scalar) {
+      static_assert(sizeof(T) == 4 || sizeof(T) == 8, "blocks hold 32 or 64-bit keys");
+      size_t i = 0;
+
+      if constexpr (!Cpu::runtime_dispatch) {
+#if defined(__VAES__) && defined(__AES__)
+         if constexpr (Cpu::static_isa() == Cpu::ISA::AVX512)
+            i = blocks<__m512i, Unroll>(in, out, n, kernel);
+         else if constexpr (Cpu::static_isa() == Cpu::ISA::AVX2)
+            i = blocks<__m256i, Unroll>(in, out, n, kernel);
+         else
+#endif
+#if defined(__AES__) && defined(__SSE4_2__)
+            i = blocks<__m128i, Unroll>(in, out, n, kernel);
+#else
+            UNUSED(kernel);
+#endif
+      } else {
+         if (Cpu::has_vaes() && Cpu::isa() == Cpu::ISA::AVX512)
+            i = blocks_vaes512<Unroll>(in, out, n, kernel);
+         else if (Cpu::has_vaes() && Cpu::isa() == Cpu::ISA::AVX2)
+            i = blocks_vaes256<Unroll>(in, out, n, kernel);
+         else if (Cpu::has_aes() && Cpu::isa() != Cpu::ISA::Scalar)
+            i = blocks_aes<Unroll>(in, out, n, kernel);
+      }
+
+      for (; i < n; i++)
+         out[i] = scalar(in[i]);
+   }
+} // namespace Batch
+
+/**
+ * Hashes n keys at once, i.e., out[i] = fn(in[i]). Uses the functor's
+ * vectorized hash_batch() if it has one and falls back to a scalar loop otherwise
+ *
+ * @param fn hash functor
+ * @param in keys
+ * @param out hash values
+ * @param n amount of keys
+ */
+template<class Hashfn, class T>
+forceinline void hash_batch(Hashfn& fn, const T* in, HASH_64* out, const size_t& n) {
+   if constexpr (requires { fn.hash_batch(in, out, n); }) {
+      fn.hash_batch(in, out, n);
+   } else {
+      for (size_t i = 0; i < n; i++)
+         out[i] = static_cast<HASH_64>(fn(in[i]));
+   }
+}
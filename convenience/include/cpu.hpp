@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdlib>
+#include <string>
+#include <strings.h>
+
+/**
+ * Instruction set selection for vectorized kernels, see Batch::for_each_lane().
+ *
+ * By default everything is compiled for the build host (-march=native) and the
+ * widest instruction set is chosen at compile time. Portable builds
+ * (cmake -DPORTABLE=ON) target a baseline CPU and define RUNTIME_DISPATCH,
+ * i.e., kernels are additionally compiled for every supported instruction set
+ * and the widest one the executing CPU supports is selected at startup. The
+ * environment variable HASHING_ISA (scalar, sse4.2, avx2 or avx512) may further
+ * restrict the selection, e.g., to compare paths on a single machine.
+ */
+namespace Cpu {
+   /// Instruction sets with a dedicated kernel path, ordered by vector width
+   enum class ISA { Scalar = 0, SSE42 = 1, AVX2 = 2, AVX512 = 3 };
+
+#ifdef RUNTIME_DISPATCH
+   constexpr bool runtime_dispatch = true;
+#else
+   constexpr bool runtime_dispatch = false;
+#endif
+
+   /**
+    * @return widest instruction set the build targets. AVX-512 kernels rely on
+    *    the BW (byte shifts), DQ (64-bit multiplication) and VL (256/128-bit
+    *    forms) extensions
+    */
+   constexpr ISA static_isa() {
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512DQ__) && defined(__AVX512VL__)
+      return ISA::AVX512;
+#elif defined(__AVX2__)
+      return ISA::AVX2;
+#elif defined(__SSE4_2__)
+      return ISA::SSE42;
+#else
+      return ISA::Scalar;
+#endif
+   }
+
+   inline std::string name(const ISA& isa) {
+      switch (isa) {
+         case ISA::AVX512:
+            return "avx512";
+         case ISA::AVX2:
+            return "avx2";
+         case ISA::SSE42:
+            return "sse4.2";
+         case ISA::Scalar:
+            break;
+      }
+      return "scalar";
+   }
+
+   /**
+    * @return widest instruction set supported by the executing CPU,
+    *    restricted by HASHING_ISA if set
+    */
+   inline ISA detect_isa() {
+      __builtin_cpu_init();
+
+      ISA isa = ISA::Scalar;
+      if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+          __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl"))
+         isa = ISA::AVX512;
+      else if (__builtin_cpu_supports("avx2"))
+         isa = ISA::AVX2;
+      else if (__builtin_cpu_supports("sse4.2"))
+         isa = ISA::SSE42;
+
+      if (const char* requested = std::getenv("HASHING_ISA")) {
+         for (const auto candidate : {ISA::Scalar, ISA::SSE42, ISA::AVX2, ISA::AVX512})
+            if (strcasecmp(requested, name(candidate).c_str()) == 0 && candidate < isa)
+               isa = candidate;
+      }
+
+      return isa;
+   }
+
+   /**
+    * @return instruction set vectorized kernels use. Without RUNTIME_DISPATCH
+    *    this is static_isa(), otherwise detect_isa() evaluated once
+    */
+   inline ISA isa() {
+      if constexpr (runtime_dispatch) {
+         static const ISA detected = detect_isa();
+         return detected;
+      } else {
+         return static_isa();
+      }
+   }
+
+   /**
+    * @return human readable name of isa(), e.g., for benchmark output
+    */
+   inline std::string isa_name() {
+      return name(isa());
+   }
+
+   /**
+    * @return whether AES-NI instructions may be executed, i.e., whether
+    *    AES based hash functions (aqua, meow) are available
+    */
+   inline bool has_aes() {
+#ifdef __AES__
+      return true;
+#else
+      static const bool supported = (__builtin_cpu_init(), __builtin_cpu_supports("aes"));
+      return supported;
+#endif
+   }
+
+   /**
+    * @return whether vector AES instructions (VAES), i.e., AES rounds on
+    *    256/512-bit registers, may be executed
+    */
+   inline bool has_vaes() {
+#ifdef __VAES__
+      return true;
+#else
+      static const bool supported = (__builtin_cpu_init(), __builtin_cpu_supports("vaes"));
+      return supported;
+#endif
+   }
+} // namespace Cpu
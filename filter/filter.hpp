@@ -0,0 +1,4 @@
+#pragma once
+
+#include "include/cuckoo.hpp"
+#include "include/quotient.hpp"
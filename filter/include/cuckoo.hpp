@@ -0,0 +1,269 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <convenience.hpp>
+#include <hashtable.hpp>
+
+namespace Filter {
+   /**
+    * Cuckoo filter (Fan et al., "Cuckoo Filter: Practically Better Than Bloom", CoNEXT'14)
+    * storing FingerprintBits wide fingerprints in BucketSize slot buckets. Relocation
+    * of fingerprints is delegated to the kicking strategies of Hashtable::Cuckoo.
+    *
+    * Since only fingerprints are stored, the alternate bucket of an entry is derived
+    * from its current bucket and its fingerprint (partial-key cuckoo hashing). To
+    * support arbitrary (non power of two) directory sizes, we use
+    * i2 = (h(fp) - i1) mod N which, just like the original xor, is an involution.
+    *
+    * @tparam Key key type
+    * @tparam FingerprintBits amount of fingerprint bits, 12-16. Fingerprint 0 marks empty slots
+    * @tparam HashFn hash function used to derive primary bucket & fingerprint
+    * @tparam ReductionFn reducer mapping hash values to bucket indices
+    * @tparam KickingFn one of Hashtable::BalancedKicking, Hashtable::BiasedKicking
+    * @tparam BucketSize amount of fingerprint slots per bucket
+    */
+   template<class Key, size_t FingerprintBits, class HashFn, class ReductionFn,
+            class KickingFn = Hashtable::BalancedKicking, size_t BucketSize = 4>
+   class Cuckoo {
+      static_assert(FingerprintBits >= 12 && FingerprintBits <= 16,
+                    "cuckoo filter fingerprints must be between 12 and 16 bits wide");
+
+     public:
+      using KeyType = Key;
+
+     private:
+      using Fingerprint = std::uint16_t;
+      static constexpr Fingerprint Empty = 0;
+      static constexpr Fingerprint FingerprintMask = static_cast<Fingerprint>((1LLU << FingerprintBits) - 1);
+
+      struct Bucket {
+         struct Slot {
+            Fingerprint key = Empty;
+            // Kicking functors move (key, payload) pairs around. Filters have no payload
+            [[no_unique_address]] Hashtable::NoPayload payload;
+         };
+
+         std::array<Slot, BucketSize> slots;
+      };
+      // Empty payloads take no space, i.e., buckets are dense without packing
+      static_assert(sizeof(Bucket) == BucketSize * sizeof(Fingerprint));
+
+      const size_t MaxKickCycleLength;
+      const HashFn hashfn;
+      const ReductionFn reductionfn;
+      KickingFn kickingfn;
+
+      std::vector<Bucket> buckets;
+      size_t count = 0;
+
+      /// fingerprint that could not be placed during a failed insert. Kept to
+      /// avoid introducing false negatives for previously inserted keys
+      std::optional<std::pair<size_t, Fingerprint>> victim = std::nullopt;
+
+     public:
+      explicit Cuckoo(const size_t& capacity, const HashFn hashfn = HashFn())
+         : MaxKickCycleLength(500), hashfn(hashfn), reductionfn(ReductionFn(directory_address_count(capacity))),
+           kickingfn(KickingFn()), buckets(directory_address_count(capacity)) {}
+
+      /**
+       * Inserts a key into the filter
+       *
+       * @param key
+       * @return whether or not the key was inserted. Insertion fails iff the filter is
+       *    considered full, i.e., MaxKickCycleLength was exceeded on this or a previous insert
+       */
+      bool insert(const Key& key) {
+         if (unlikely(victim.has_value()))
+            return false;
+
+         const auto h = hashfn(key);
+         count++;
+         return place(reductionfn(h), fingerprint(h));
+      }
+
+      /**
+       * Approximate membership query. Never returns false for a key that was inserted
+       * (and not erased since), but may return true for keys that were never inserted
+       *
+       * @param key
+       */
+      bool contains(const Key& key) const {
+         const auto h = hashfn(key);
+         const auto fp = fingerprint(h);
+         const auto i1 = reductionfn(h);
+         const auto i2 = alternate_index(i1, fp);
+
+         if (bucket_contains(buckets[i1], fp) || bucket_contains(buckets[i2], fp))
+            return true;
+
+         return unlikely(victim.has_value()) && victim->second == fp &&
+            (victim->first == i1 || victim->first == i2);
+      }
+
+      /**
+       * Removes one occurrence of key's fingerprint from the filter. Erasing a key
+       * that was never inserted may remove another key's fingerprint and thereby
+       * introduce false negatives!
+       *
+       * @param key
+       * @return whether or not a matching fingerprint was found and removed
+       */
+      bool erase(const Key& key) {
+         const auto h = hashfn(key);
+         const auto fp = fingerprint(h);
+         const auto i1 = reductionfn(h);
+         const auto i2 = alternate_index(i1, fp);
+
+         if (bucket_erase(buckets[i1], fp) || bucket_erase(buckets[i2], fp)) {
+            count--;
+            reinsert_victim();
+            return true;
+         }
+
+         if (victim.has_value() && victim->second == fp && (victim->first == i1 || victim->first == i2)) {
+            victim = std::nullopt;
+            count--;
+            return true;
+         }
+
+         return false;
+      }
+
+      std::map<std::string, std::string> lookup_statistics() const {
+         size_t empty_slots = 0;
+         for (const auto& bucket : buckets)
+            for (const auto& slot : bucket.slots)
+               empty_slots += slot.key == Empty ? 1 : 0;
+
+         return {{"empty_slots", std::to_string(empty_slots)},
+                 {"bits_per_key", std::to_string(bits_per_key())},
+                 {"filter_full", std::to_string(victim.has_value())}};
+      }
+
+      /**
+       * @return bits per key with respect to the amount of currently stored keys
+       */
+      double bits_per_key() const {
+         if (count == 0)
+            return 0;
+         return static_cast<double>(byte_size() * 8) / static_cast<double>(count);
+      }
+
+      size_t byte_size() const {
+         return buckets.size() * sizeof(Bucket);
+      }
+
+      size_t size() const {
+         return count;
+      }
+
+      static forceinline std::string name() {
+         return "cuckoo_filter_" + std::to_string(FingerprintBits) + "_" + std::to_string(BucketSize) + "_" +
+            KickingFn::name();
+      }
+
+      static forceinline std::string hash_name() {
+         return HashFn::name();
+      }
+
+      static forceinline std::string reducer_name() {
+         return ReductionFn::name();
+      }
+
+      static constexpr forceinline size_t bucket_size() {
+         return BucketSize;
+      }
+
+      static constexpr forceinline size_t directory_address_count(const size_t& capacity) {
+         return (capacity + BucketSize - 1) / BucketSize;
+      }
+
+      void clear() {
+         for (auto& bucket : buckets)
+            for (auto& slot : bucket.slots)
+               slot.key = Empty;
+         victim = std::nullopt;
+         count = 0;
+      }
+
+     private:
+      static forceinline Fingerprint fingerprint(const HASH_64& hash) {
+         // Reducers consume either the lower (modulo) or the upper (fastrange) bits
+         // of the hash. Rehash via fibonacci hashing to not correlate fingerprint &
+         // primary bucket index
+         const auto fp = static_cast<Fingerprint>((hash * 0x9E3779B97F4A7C15LLU) >> (64 - FingerprintBits));
+         return fp == Empty ? 1 : fp & FingerprintMask;
+      }
+
+      forceinline size_t alternate_index(const size_t& index, const Fingerprint& fp) const {
+         const size_t h = reductionfn(static_cast<HASH_64>(fp) * 0xC6A4A7935BD1E995LLU);
+         return h >= index ? h - index : h + buckets.size() - index;
+      }
+
+      static forceinline bool bucket_contains(const Bucket& bucket, const Fingerprint& fp) {
+         bool found = false;
+         for (size_t i = 0; i < BucketSize; i++)
+            found |= bucket.slots[i].key == fp;
+         return found;
+      }
+
+      static forceinline bool bucket_erase(Bucket& bucket, const Fingerprint& fp) {
+         for (size_t i = 0; i < BucketSize; i++) {
+            if (bucket.slots[i].key == fp) {
+               // Keep buckets compact (occupied slots first) as expected by the kicking functors
+               size_t last = i;
+               while (last + 1 < BucketSize && bucket.slots[last + 1].key != Empty)
+                  last++;
+               bucket.slots[i].key = bucket.slots[last].key;
+               bucket.slots[last].key = Empty;
+               return true;
+            }
+         }
+         return false;
+      }
+
+      /**
+       * Places fp in bucket index or in its alternate bucket, relocating other
+       * fingerprints if necessary.
+       *
+       * @return false iff MaxKickCycleLength was exceeded, in which case the
+       *    currently homeless fingerprint is stored as victim
+       */
+      bool place(size_t index, Fingerprint fp) {
+         for (size_t kick_count = 0; kick_count <= MaxKickCycleLength; kick_count++) {
+            Bucket* b1 = &buckets[index];
+            Bucket* b2 = &buckets[alternate_index(index, fp)];
+            Bucket* kicked_from = nullptr;
+
+            const auto kicked = kickingfn.template operator()<Bucket, Fingerprint, Hashtable::NoPayload, BucketSize, Empty>(
+               b1, b2, fp, Hashtable::NoPayload(), &kicked_from);
+            if (!kicked)
+               return true;
+
+            fp = kicked.value().first;
+            index = alternate_index(static_cast<size_t>(kicked_from - buckets.data()), fp);
+         }
+
+         victim = std::make_optional(std::make_pair(index, fp));
+         return false;
+      }
+
+      void reinsert_victim() {
+         if (likely(!victim.has_value()))
+            return;
+
+         // Retry placing the homeless fingerprint now that there is space again
+         const auto [index, fp] = victim.value();
+         victim = std::nullopt;
+         place(index, fp);
+      }
+   };
+} // namespace Filter
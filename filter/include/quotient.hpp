@@ -0,0 +1,379 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <immintrin.h>
+
+#include <convenience.hpp>
+
+namespace Filter {
+   /**
+    * Rank-and-select based quotient filter (Pandey et al., "A General-Purpose Counting Filter:
+    * Making Every Bit Count", SIGMOD'17). Instead of the three metadata bits of the classic
+    * quotient filter, each slot is annotated with an occupieds and a runends bit. Runs are located
+    * via rank (popcount) on occupieds and select on runends, starting from a per block offset.
+    *
+    * A hash value h is split into quotient q = reductionfn(h) and a RemainderBits wide remainder.
+    * Runs never wrap around, instead the directory is over allocated by a few blocks.
+    *
+    * @tparam Key key type
+    * @tparam RemainderBits amount of remainder bits, 8 or 16
+    * @tparam HashFn hash function used to derive quotient & remainder
+    * @tparam ReductionFn reducer mapping hash values to canonical slot indices, i.e., quotients
+    */
+   template<class Key, size_t RemainderBits, class HashFn, class ReductionFn>
+   class Quotient {
+      static_assert(RemainderBits == 8 || RemainderBits == 16, "quotient filter remainders must be 8 or 16 bits wide");
+
+     public:
+      using KeyType = Key;
+
+     private:
+      using Remainder = std::conditional_t<RemainderBits == 8, std::uint8_t, std::uint16_t>;
+      static constexpr size_t SlotsPerBlock = 64;
+
+      struct Block {
+         /// bit i is set iff at least one key with quotient block_start + i exists
+         std::uint64_t occupieds = 0;
+         /// bit i is set iff slot block_start + i is the last slot of a run
+         std::uint64_t runends = 0;
+         /// amount of slots at the start of this block that are used by runs of
+         /// quotients < block_start
+         std::uint32_t offset = 0;
+         std::array<Remainder, SlotsPerBlock> remainders;
+      } packed;
+
+      const HashFn hashfn;
+      const ReductionFn reductionfn;
+
+      std::vector<Block> blocks;
+      size_t count = 0;
+
+     public:
+      explicit Quotient(const size_t& capacity, const HashFn hashfn = HashFn())
+         : hashfn(hashfn), reductionfn(ReductionFn(capacity)), blocks(directory_block_count(capacity)) {}
+
+      /**
+       * Inserts a key into the filter. Inserting the same key multiple times is
+       * supported, i.e., the filter behaves like a multiset
+       *
+       * @param key
+       * @return whether or not the key was inserted. Insertion fails iff a run would
+       *    be shifted beyond the overflow blocks at the end of the directory
+       */
+      bool insert(const Key& key) {
+         const auto h = hashfn(key);
+         const size_t q = reductionfn(h);
+         const auto r = remainder(h);
+
+         const auto end = run_end(q);
+         if (end < static_cast<std::int64_t>(q)) {
+            // canonical slot is empty
+            set_remainder(q, r);
+            set_bit<&Block::runends>(q);
+            set_bit<&Block::occupieds>(q);
+            count++;
+            return true;
+         }
+
+         const size_t pos = static_cast<size_t>(end) + 1;
+         const size_t empty = first_empty_slot(pos);
+         if (unlikely(empty >= slot_count()))
+            return false;
+
+         shift_right(pos, empty);
+         set_remainder(pos, r);
+         set_bit<&Block::runends>(pos);
+         if (test_bit<&Block::occupieds>(q)) {
+            // append to existing run
+            clear_bit<&Block::runends>(static_cast<size_t>(end));
+         } else {
+            set_bit<&Block::occupieds>(q);
+         }
+         update_offsets(q, empty);
+
+         count++;
+         return true;
+      }
+
+      /**
+       * Approximate membership query. Never returns false for a key that was inserted
+       * (and not erased since), but may return true for keys that were never inserted
+       *
+       * @param key
+       */
+      bool contains(const Key& key) const {
+         const auto h = hashfn(key);
+         const size_t q = reductionfn(h);
+         if (!test_bit<&Block::occupieds>(q))
+            return false;
+
+         const auto r = remainder(h);
+         const auto end = static_cast<size_t>(run_end(q));
+         for (size_t i = run_start(q); i <= end; i++)
+            if (get_remainder(i) == r)
+               return true;
+         return false;
+      }
+
+      /**
+       * Removes one occurrence of key's remainder from the filter. Erasing a key
+       * that was never inserted may remove another key's remainder and thereby
+       * introduce false negatives!
+       *
+       * @param key
+       * @return whether or not a matching remainder was found and removed
+       */
+      bool erase(const Key& key) {
+         const auto h = hashfn(key);
+         const size_t q = reductionfn(h);
+         if (!test_bit<&Block::occupieds>(q))
+            return false;
+
+         const auto r = remainder(h);
+         const auto start = run_start(q);
+         const auto end = static_cast<size_t>(run_end(q));
+         size_t i = start;
+         while (i <= end && get_remainder(i) != r)
+            i++;
+         if (i > end)
+            return false;
+
+         // Order within a run does not matter, i.e., fill hole with last remainder of run
+         set_remainder(i, get_remainder(end));
+         clear_bit<&Block::runends>(end);
+         if (start == end)
+            clear_bit<&Block::occupieds>(q);
+         else
+            set_bit<&Block::runends>(end - 1);
+
+         // Slot end is now a hole. Shift subsequent runs of this cluster left by one
+         // slot until we encounter an empty slot or a run starting at its canonical slot
+         size_t hole = end;
+         for (size_t next_q = next_occupied(q + 1); next_q <= hole; next_q = next_occupied(next_q + 1)) {
+            const size_t next_end = next_runend(hole + 1);
+            for (size_t j = hole; j < next_end; j++)
+               set_remainder(j, get_remainder(j + 1));
+            clear_bit<&Block::runends>(next_end);
+            set_bit<&Block::runends>(next_end - 1);
+            hole = next_end;
+         }
+         update_offsets(q, hole);
+
+         count--;
+         return true;
+      }
+
+      std::map<std::string, std::string> lookup_statistics() const {
+         return {{"bits_per_key", std::to_string(bits_per_key())}};
+      }
+
+      /**
+       * @return bits per key with respect to the amount of currently stored keys
+       */
+      double bits_per_key() const {
+         if (count == 0)
+            return 0;
+         return static_cast<double>(byte_size() * 8) / static_cast<double>(count);
+      }
+
+      size_t byte_size() const {
+         return blocks.size() * sizeof(Block);
+      }
+
+      size_t size() const {
+         return count;
+      }
+
+      static forceinline std::string name() {
+         return "rank_select_quotient_filter_" + std::to_string(RemainderBits);
+      }
+
+      static forceinline std::string hash_name() {
+         return HashFn::name();
+      }
+
+      static forceinline std::string reducer_name() {
+         return ReductionFn::name();
+      }
+
+      /**
+       * Amount of blocks necessary to store capacity many canonical slots plus
+       * overflow slots, as runs don't wrap around
+       */
+      static forceinline size_t directory_block_count(const size_t& capacity) {
+         const auto overflow_slots = static_cast<size_t>(10.0 * std::sqrt(static_cast<double>(capacity)));
+         return (capacity + overflow_slots + SlotsPerBlock - 1) / SlotsPerBlock + 1;
+      }
+
+      void clear() {
+         for (auto& block : blocks) {
+            block.occupieds = 0;
+            block.runends = 0;
+            block.offset = 0;
+         }
+         count = 0;
+      }
+
+     private:
+      static forceinline Remainder remainder(const HASH_64& hash) {
+         // Reducers consume either the lower (modulo) or the upper (fastrange) bits
+         // of the hash. Rehash via fibonacci hashing to not correlate quotient & remainder
+         return static_cast<Remainder>((hash * 0x9E3779B97F4A7C15LLU) >> (64 - RemainderBits));
+      }
+
+      forceinline size_t slot_count() const {
+         return blocks.size() * SlotsPerBlock;
+      }
+
+      template<std::uint64_t Block::*Bits>
+      forceinline bool test_bit(const size_t& slot) const {
+         return (blocks[slot / SlotsPerBlock].*Bits >> (slot % SlotsPerBlock)) & 0x1;
+      }
+
+      template<std::uint64_t Block::*Bits>
+      forceinline void set_bit(const size_t& slot) {
+         blocks[slot / SlotsPerBlock].*Bits |= 0x1LLU << (slot % SlotsPerBlock);
+      }
+
+      template<std::uint64_t Block::*Bits>
+      forceinline void clear_bit(const size_t& slot) {
+         blocks[slot / SlotsPerBlock].*Bits &= ~(0x1LLU << (slot % SlotsPerBlock));
+      }
+
+      forceinline Remainder get_remainder(const size_t& slot) const {
+         return blocks[slot / SlotsPerBlock].remainders[slot % SlotsPerBlock];
+      }
+
+      forceinline void set_remainder(const size_t& slot, const Remainder& r) {
+         blocks[slot / SlotsPerBlock].remainders[slot % SlotsPerBlock] = r;
+      }
+
+      /**
+       * @return index of the rank-th (0 indexed) set bit in word
+       */
+      static forceinline size_t select(const std::uint64_t& word, const size_t& rank) {
+#ifdef __BMI2__
+         return _tzcnt_u64(_pdep_u64(0x1LLU << rank, word));
+#else
+         auto w = word;
+         for (size_t i = 0; i < rank; i++)
+            w &= w - 1;
+         return __builtin_ctzll(w);
+#endif
+      }
+
+      /**
+       * @return last slot of the run belonging to the largest occupied quotient <= x. If
+       *    no such run extends up to slot x (i.e., slot x is empty), the result is < x
+       */
+      std::int64_t run_end(const size_t& x) const {
+         const size_t block_index = x / SlotsPerBlock;
+         const auto& block = blocks[block_index];
+         const size_t block_start = block_index * SlotsPerBlock;
+
+         // amount of occupied quotients in [block_start, x]
+         const auto upto_mask = ~0x0LLU >> (SlotsPerBlock - 1 - (x % SlotsPerBlock));
+         size_t rank = __builtin_popcountll(block.occupieds & upto_mask);
+         if (rank == 0)
+            return static_cast<std::int64_t>(block_start + block.offset) - 1;
+
+         // runends of quotients >= block_start start after block.offset
+         size_t pos = block_start + block.offset;
+         size_t word_index = pos / SlotsPerBlock;
+         std::uint64_t word = blocks[word_index].runends & (~0x0LLU << (pos % SlotsPerBlock));
+         for (;;) {
+            const size_t cnt = __builtin_popcountll(word);
+            if (rank <= cnt)
+               return static_cast<std::int64_t>(word_index * SlotsPerBlock + select(word, rank - 1));
+            rank -= cnt;
+            word = blocks[++word_index].runends;
+         }
+      }
+
+      /**
+       * @return first slot of q's run. q must be occupied
+       */
+      forceinline size_t run_start(const size_t& q) const {
+         if (q == 0)
+            return 0;
+         return std::max(static_cast<std::int64_t>(q), run_end(q - 1) + 1);
+      }
+
+      /**
+       * @return first empty slot >= x
+       */
+      size_t first_empty_slot(size_t x) const {
+         while (x < slot_count()) {
+            const auto end = run_end(x);
+            if (end < static_cast<std::int64_t>(x))
+               return x;
+            x = static_cast<size_t>(end) + 1;
+         }
+         return x;
+      }
+
+      /**
+       * @return smallest occupied quotient >= x or slot_count() if there is none
+       */
+      size_t next_occupied(const size_t& x) const {
+         return next_set<&Block::occupieds>(x);
+      }
+
+      /**
+       * @return smallest slot >= x with runends bit set
+       */
+      size_t next_runend(const size_t& x) const {
+         return next_set<&Block::runends>(x);
+      }
+
+      template<std::uint64_t Block::*Bits>
+      size_t next_set(const size_t& x) const {
+         size_t word_index = x / SlotsPerBlock;
+         if (word_index >= blocks.size())
+            return slot_count();
+
+         std::uint64_t word = blocks[word_index].*Bits & (~0x0LLU << (x % SlotsPerBlock));
+         while (word == 0) {
+            if (++word_index >= blocks.size())
+               return slot_count();
+            word = blocks[word_index].*Bits;
+         }
+         return word_index * SlotsPerBlock + __builtin_ctzll(word);
+      }
+
+      /**
+       * Shifts remainders & runends in [from, to) one slot to the right, overwriting slot to.
+       * Slot from is left unchanged and its runends bit is cleared
+       */
+      void shift_right(const size_t& from, const size_t& to) {
+         for (size_t j = to; j > from; j--) {
+            set_remainder(j, get_remainder(j - 1));
+            if (test_bit<&Block::runends>(j - 1))
+               set_bit<&Block::runends>(j);
+            else
+               clear_bit<&Block::runends>(j);
+         }
+         clear_bit<&Block::runends>(from);
+      }
+
+      /**
+       * Recomputes offsets for all blocks whose runs might have changed
+       * after modifying the cluster in [q, last_slot]
+       */
+      void update_offsets(const size_t& q, const size_t& last_slot) {
+         for (size_t b = q / SlotsPerBlock + 1; b <= last_slot / SlotsPerBlock && b < blocks.size(); b++) {
+            const auto block_start = static_cast<std::int64_t>(b * SlotsPerBlock);
+            const auto end = run_end(b * SlotsPerBlock - 1);
+            blocks[b].offset = static_cast<std::uint32_t>(std::max(static_cast<std::int64_t>(0), end - block_start + 1));
+         }
+      }
+   };
+} // namespace Filter
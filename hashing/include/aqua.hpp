@@ -226,12 +226,29 @@
 #include <cstring>
 #include <limits>
 #include <string>
+#include <type_traits>
 #include <smmintrin.h>
 #include <wmmintrin.h>
 
 #include <convenience.hpp>
 #include <reduction.hpp>
 
+// AES-NI is not part of the baseline portable builds target (cmake -DPORTABLE=ON).
+// Compile for it regardless, callers have to check Cpu::has_aes() beforehand.
+// Force inlining into callers compiled without AES-NI is impossible, hence disabled
+#ifndef __AES__
+   #ifdef __clang__
+      #pragma clang attribute push(__attribute__((target("sse4.2,aes"))), apply_to = function)
+   #else
+      #pragma GCC push_options
+      #pragma GCC target("sse4.2,aes")
+   #endif
+   #pragma push_macro("forceinline")
+   #undef forceinline
+   #define forceinline inline
+   #define AQUA_AES_TARGET
+#endif
+
 template<class T, const int select = 0>
 struct AquaHash {
    static std::string name() {
@@ -240,9 +257,40 @@ struct AquaHash {
 
    forceinline T operator()(const T& value, const __m128i seed = _mm_setzero_si128()) const;
 
-   //   forceinline __m128i operator()(const HASH_128& value, const __m128i seed = _mm_setzero_si128()) const {
-   //      return Hash(&value, sizeof(HASH_128), seed);
-   //   }
+   /**
+    * Hashes n keys at once (seed = 0), see hash_batch(). Runs the small key
+    * algorithm for one key per 128-bit block, i.e., up to 16 keys in flight with
+    * VAES, see Batch::for_each_block(). Results are identical to operator()
+    */
+   forceinline void hash_batch(const T* in, HASH_64* out, const size_t& n) const
+      requires(std::is_same_v<T, HASH_32> || std::is_same_v<T, HASH_64>)
+   {
+      Batch::for_each_block(
+         in, out, n,
+         [&](auto key) {
+            using namespace Batch;
+            using V = decltype(key);
+
+            // AES sub-block processor, i.e., initialize ^ _mm_set_epi64x(key, 0xa11202c9b468bea1) for 8 byte
+            // and initialize ^ _mm_set_epi32(0xb1293b33, 0x05418592, key, 0xd210d232) for 4 byte keys
+            V hash;
+            if constexpr (sizeof(T) == 8)
+               hash = xor64(bslli128<8>(key), set128<V>(0, 0xa11202c9b468bea1));
+            else
+               hash = xor64(bslli128<4>(key), set128<V>(0xb1293b3305418592, 0xd210d232));
+
+            hash = aesenc(hash, set128<V>(0x8e51ef21fabb4522, 0xe43d7a0656954b6c));
+            hash = aesenc(hash, set128<V>(0x56082007c71ab18f, 0x76435569a03af7fa));
+            hash = aesenc(hash, set128<V>(0xd2600de7157abc68, 0x6339e901c3031efb));
+
+            // extract_64<select> / extract_32<select>, moved to the lower bits of each block
+            if constexpr (sizeof(T) == 8)
+               return bsrli128<8 * select>(hash);
+            else
+               return and64(bsrli128<4 * select>(hash), set128<V>(0, 0xFFFFFFFF));
+         },
+         [&](const T& key) { return static_cast<HASH_64>((*this)(key)); });
+   }
 
   private:
    // INCREMENTAL CONSTRUCTION STATE
@@ -552,6 +600,23 @@ HASH_64 AquaHash<HASH_64, 1>::operator()(const HASH_64& value, const __m128i see
    return Reduction::extract_64<1>(Hash(reinterpret_cast<const uint8_t*>(&value), sizeof(HASH_64), seed));
 }
 
+/// 128-bit keys, e.g., (tenant_id, object_id) pairs, run one bulk AES round. Returns the entire hash
+template<>
+HASH_128 AquaHash<HASH_128, 0>::operator()(const HASH_128& value, const __m128i seed) const {
+   const auto hash = Hash(reinterpret_cast<const uint8_t*>(&value), sizeof(HASH_128), seed);
+   return to_hash128(Reduction::extract_64<1>(hash), Reduction::extract_64<0>(hash));
+}
+
+#ifdef AQUA_AES_TARGET
+   #undef AQUA_AES_TARGET
+   #pragma pop_macro("forceinline")
+   #ifdef __clang__
+      #pragma clang attribute pop
+   #else
+      #pragma GCC pop_options
+   #endif
+#endif
+
 /// TEST CODE
 //// Verifies the implementation matches test vectors computed several ways.
 //// Returns zero on success or line number on test failure.
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <convenience.hpp>
+
+/**
+ * Whether T is a variable length byte string (e.g., URL or email keys) rather
+ * than a fixed size value. Byte stream hashes hash the string's contents
+ * instead of the object representation of T for those
+ */
+template<class T>
+constexpr bool is_byte_string = std::is_same_v<T, std::string_view> || std::is_same_v<T, std::string>;
+
+/**
+ * @return pointer to the bytes of key that should be hashed
+ */
+template<class T>
+forceinline const char* key_bytes(const T& key) {
+   if constexpr (is_byte_string<T>)
+      return key.data();
+   else
+      return reinterpret_cast<const char*>(&key);
+}
+
+/**
+ * @return amount of bytes of key that should be hashed
+ */
+template<class T>
+forceinline size_t key_length(const T& key) {
+   if constexpr (is_byte_string<T>) {
+      return key.size();
+   } else {
+      UNUSED(key);
+      return sizeof(T);
+   }
+}
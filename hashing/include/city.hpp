@@ -40,6 +40,7 @@
 #include <convenience.hpp>
 #include <reduction.hpp>
 
+#include "bytes.hpp"
 #include "city.config.hpp"
 
 #ifdef _MSC_VER
@@ -501,8 +502,8 @@ struct CityHash32 : private CityHash {
    }
 
    forceinline HASH_32 operator()(const T& key) const {
-      auto* s = reinterpret_cast<const char*>(&key);
-      size_t len = sizeof(T);
+      auto* s = key_bytes(key);
+      size_t len = key_length(key);
 
       if (len <= 24) {
          return len <= 12 ? (len <= 4 ? Hash32Len0to4(s, len) : Hash32Len5to12(s, len)) : Hash32Len13to24(s, len);
@@ -582,8 +583,8 @@ struct CityHash64 : private CityHash {
    }
 
    forceinline HASH_64 operator()(const T& key) const {
-      auto s = reinterpret_cast<const char*>(&key);
-      size_t len = sizeof(T);
+      auto s = key_bytes(key);
+      size_t len = key_length(key);
 
       if (len <= 32) {
          if (len <= 16) {
@@ -672,8 +673,8 @@ struct CityHash128 : private CityHash {
    }
 
    forceinline HASH_128 operator()(const T& key) const {
-      const auto* s = reinterpret_cast<const char*>(&key);
-      size_t len = sizeof(T);
+      const auto* s = key_bytes(key);
+      size_t len = key_length(key);
 
       return len >= 16 ? CityHash128WithSeed(s + 16, len - 16, to_hash128(Fetch64(s), Fetch64(s + 8) + k0)) :
                          CityHash128WithSeed(s, len, to_hash128(k0, k1));
@@ -692,8 +693,8 @@ struct CityHash128Seed : private CityHash {
    }
 
    forceinline HASH_64 operator()(const T& key) const {
-      const auto* s = reinterpret_cast<const char*>(&key);
-      size_t len = sizeof(T);
+      const auto* s = key_bytes(key);
+      size_t len = key_length(key);
 
       return CityHash128WithSeed(s, len, seed);
    }
@@ -713,8 +714,8 @@ struct CityHashCrc256 : private CityHash {
    }
 
    forceinline HASH_256 operator()(const T& key) const {
-      const auto* s = reinterpret_cast<const char*>(&key);
-      size_t len = sizeof(T);
+      const auto* s = key_bytes(key);
+      size_t len = key_length(key);
 
       HASH_256 result;
       if (likely(len >= 240)) {
@@ -738,7 +739,7 @@ struct CityHashCrc128 : private CityHash {
    }
 
    forceinline HASH_128 operator()(const T& key) {
-      size_t len = sizeof(T);
+      size_t len = key_length(key);
 
       if (len <= 900) {
          CityHash128<T> hash;
@@ -764,8 +765,8 @@ struct CityHashCrc128Seed : private CityHash {
    }
 
    forceinline HASH_128 operator()(const T& key) {
-      const auto* s = reinterpret_cast<const char*>(&key);
-      size_t len = sizeof(T);
+      const auto* s = key_bytes(key);
+      size_t len = key_length(key);
 
       if (len <= 900) {
          return CityHash128WithSeed(s, len, seed);
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <string>
+
+#include <convenience.hpp>
+#include <thirdparty/xxhash.h>
+
+#include "bytes.hpp"
+
+/**
+ * Family of hash functions, i.e., a functor type whose instances are
+ * independent members selected by a 64-bit seed. Tables reseed members of a
+ * family to rehash, e.g., on a failed cuckoo build
+ */
+template<class F>
+concept HashFamily = std::constructible_from<F, std::uint64_t> && requires(const F& f) {
+   { f.seed() } -> std::convertible_to<std::uint64_t>;
+};
+
+/**
+ * splitmix64 step, used to expand a seed into several independent parameters
+ */
+constexpr forceinline std::uint64_t splitmix64(std::uint64_t& state) {
+   std::uint64_t z = (state += 0x9E3779B97F4A7C15LLU);
+   z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9LLU;
+   z = (z ^ (z >> 27)) * 0x94D049BB133111EBLLU;
+   return z ^ (z >> 31);
+}
+
+/**
+ * Multiply-add-shift family (Dietzfelbinger), i.e., hash = ((a * key + b) mod
+ * 2^128) >> 64 for random 128-bit a (odd) and b, which is strongly universal
+ * for 64-bit keys. See MultAddHash64 regarding the cost of 128-bit arithmetic
+ */
+template<class T>
+struct MultiplyShiftFamily {
+   static std::string name() {
+      return "mult_shift_family_" + std::to_string(sizeof(T) * 8);
+   }
+
+   explicit MultiplyShiftFamily(std::uint64_t seed = 0) : seed_(seed) {
+      std::uint64_t state = seed;
+      const auto a_hi = splitmix64(state), a_lo = splitmix64(state);
+      const auto b_hi = splitmix64(state), b_lo = splitmix64(state);
+      a = to_hash128(a_hi, a_lo | 1);
+      b = to_hash128(b_hi, b_lo);
+   }
+
+   constexpr forceinline HASH_64 operator()(const T& key) const {
+      return static_cast<HASH_64>((a * static_cast<HASH_128>(key) + b) >> 64);
+   }
+
+   std::uint64_t seed() const {
+      return seed_;
+   }
+
+  private:
+   HASH_128 a, b;
+   std::uint64_t seed_;
+};
+
+/**
+ * XXH3 with a runtime seed. Unlike XXHash3Seeded, members are selected at
+ * runtime, e.g., when rehashing
+ */
+template<class T>
+struct XXHash3Family {
+   static std::string name() {
+      return "xxh3_family";
+   }
+
+   explicit XXHash3Family(std::uint64_t seed = 0) : seed_(seed) {}
+
+   forceinline HASH_64 operator()(const T& data) const {
+      return _XXHash::XXH3_64bits_withSeed(key_bytes(data), key_length(data), seed_);
+   }
+
+   std::uint64_t seed() const {
+      return seed_;
+   }
+
+  private:
+   std::uint64_t seed_;
+};
+
+/**
+ * i-th derived hash g_i = h1 + i * h2 of h1 (Kirsch & Mitzenmacher). h2 is
+ * obtained by swapping h1's halves, forced to be odd, such that reducers
+ * consuming either the upper (fastrange) or the lower bits (modulo) see bits
+ * of both halves of h1
+ */
+constexpr forceinline HASH_64 double_hashing(const HASH_64& h1, const size_t& i) {
+   const HASH_64 h2 = ((h1 >> 32) | (h1 << 32)) | 1;
+   return h1 + i * h2;
+}
+
+/**
+ * Derives K hash functions from a single evaluation of Hashfn, see
+ * double_hashing()
+ *
+ * @tparam K amount of derived hash functions
+ * @tparam Hashfn base hash function, e.g., a HashFamily member
+ */
+template<size_t K, class Hashfn>
+struct DoubleHashing {
+   static std::string name() {
+      return "double_hashing_" + std::to_string(K) + "_" + Hashfn::name();
+   }
+
+   explicit DoubleHashing(const Hashfn hashfn = Hashfn()) : hashfn(hashfn) {}
+
+   template<class T>
+   forceinline std::array<HASH_64, K> operator()(const T& key) const {
+      const HASH_64 h1 = hashfn(key);
+      std::array<HASH_64, K> hashes;
+      for (size_t i = 0; i < K; i++)
+         hashes[i] = double_hashing(h1, i);
+      return hashes;
+   }
+
+  private:
+   Hashfn hashfn;
+};
+
+/**
+ * Secondary cuckoo hash function derived from the primary hash via double
+ * hashing, i.e., g_1 = h1 + h2, see DoubleHashing. Costs no additional
+ * evaluation of the (primary) hash function
+ */
+struct DoubleHashingCuckoo2Func {
+   static std::string name() {
+      return "double_hashing_2";
+   }
+
+   template<class T>
+   constexpr forceinline HASH_64 operator()(const T&, const HASH_64& h1) const {
+      return double_hashing(h1, 1);
+   }
+};
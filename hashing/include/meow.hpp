@@ -32,6 +32,10 @@
 #include <reduction.hpp>
 
 #include <array>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
 
 #define MEOW_HASH_VERSION 5
 #define MEOW_HASH_VERSION_NAME "0.5/calico"
@@ -81,6 +85,20 @@
 
 #endif
 
+// Meow requires AES-NI, which portable builds do not assume. See aqua.hpp
+#ifndef __AES__
+   #ifdef __clang__
+      #pragma clang attribute push(__attribute__((target("sse4.2,aes"))), apply_to = function)
+   #else
+      #pragma GCC push_options
+      #pragma GCC target("sse4.2,aes")
+   #endif
+   #pragma push_macro("forceinline")
+   #undef forceinline
+   #define forceinline inline
+   #define MEOW_AES_TARGET
+#endif
+
 #define prefetcht0(A) _mm_prefetch((char*) (A), _MM_HINT_T0)
 #define movdqu(A, B) A = _mm_loadu_si128((__m128i*) (B))
 #define movdqu_mem(A, B) _mm_storeu_si128((__m128i*) (A), B)
@@ -157,6 +175,77 @@ struct MeowHash {
    static forceinline meow_u128 hash(const T& value,
                                      const meow_u8 seed[128] = const_cast<unsigned char*>(MeowDefaultSeed));
 
+   /**
+    * _hash() of up to 15 byte integer keys using the default seed, computed for
+    * one key per 128-bit block, e.g., for four keys at once using VAES. See
+    * Batch::for_each_block()
+    *
+    * @param key vector of blocks, each holding one zero extended key
+    * @return vector of 128-bit hashes
+    */
+   template<typename T, class V>
+   static forceinline V hash_blocks(const V& key) {
+      static_assert(sizeof(T) < 16);
+      using namespace Batch;
+
+      // (aesdec) suppresses expansion of the aesdec macro above
+      const auto mix_reg = [](V& r1, V& r2, V& r3, V& r4, V& r5, const V& i1, const V& i2, const V& i3,
+                              const V& i4) {
+         r1 = (aesdec)(r1, r2);
+         r3 = add64(r3, i1);
+         r2 = xor64(r2, i2);
+         r2 = (aesdec)(r2, r4);
+         r5 = add64(r5, i3);
+         r4 = xor64(r4, i4);
+      };
+      const auto shuffle = [](V& r1, V& r2, V& r3, V& r4, V& r5, V& r6) {
+         r1 = (aesdec)(r1, r4);
+         r2 = add64(r2, r5);
+         r4 = xor64(r4, r6);
+         r4 = (aesdec)(r4, r2);
+         r5 = add64(r5, r6);
+         r2 = xor64(r2, r3);
+      };
+
+      // hash accumulation lanes, seeded
+      V xmm[8];
+      for (size_t i = 0; i < 8; i++) {
+         std::uint64_t lo, hi;
+         std::memcpy(&lo, MeowDefaultSeed + 16 * i, sizeof(lo));
+         std::memcpy(&hi, MeowDefaultSeed + 16 * i + 8, sizeof(hi));
+         xmm[i] = set128<V>(hi, lo);
+      }
+
+      // residual (the key, as there are no full 16 byte blocks) and length injests. Since the 16 byte
+      // aligned part is empty, palignr shifts in zeros, i.e., degenerates to byte shifts
+      const auto zero = set128<V>(0, 0);
+      const auto length = set128<V>(0, sizeof(T));
+      mix_reg(xmm[0], xmm[4], xmm[6], xmm[1], xmm[2], bslli128<1>(key), key, bslli128<15>(key), zero);
+      mix_reg(xmm[1], xmm[5], xmm[7], xmm[2], xmm[3], zero, zero, zero, length);
+
+      // mix the eight lanes down to one 128-bit hash
+      shuffle(xmm[0], xmm[1], xmm[2], xmm[4], xmm[5], xmm[6]);
+      shuffle(xmm[1], xmm[2], xmm[3], xmm[5], xmm[6], xmm[7]);
+      shuffle(xmm[2], xmm[3], xmm[4], xmm[6], xmm[7], xmm[0]);
+      shuffle(xmm[3], xmm[4], xmm[5], xmm[7], xmm[0], xmm[1]);
+      shuffle(xmm[4], xmm[5], xmm[6], xmm[0], xmm[1], xmm[2]);
+      shuffle(xmm[5], xmm[6], xmm[7], xmm[1], xmm[2], xmm[3]);
+      shuffle(xmm[6], xmm[7], xmm[0], xmm[2], xmm[3], xmm[4]);
+      shuffle(xmm[7], xmm[0], xmm[1], xmm[3], xmm[4], xmm[5]);
+      shuffle(xmm[0], xmm[1], xmm[2], xmm[4], xmm[5], xmm[6]);
+      shuffle(xmm[1], xmm[2], xmm[3], xmm[5], xmm[6], xmm[7]);
+      shuffle(xmm[2], xmm[3], xmm[4], xmm[6], xmm[7], xmm[0]);
+      shuffle(xmm[3], xmm[4], xmm[5], xmm[7], xmm[0], xmm[1]);
+
+      xmm[0] = add64(xmm[0], xmm[2]);
+      xmm[1] = add64(xmm[1], xmm[3]);
+      xmm[4] = add64(xmm[4], xmm[6]);
+      xmm[5] = add64(xmm[5], xmm[7]);
+      xmm[0] = xor64(xmm[0], xmm[1]);
+      xmm[4] = xor64(xmm[4], xmm[5]);
+      return add64(xmm[0], xmm[4]);
+   }
+
   private:
    constexpr static const meow_u8 MeowShiftAdjust[32] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
                                                          0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
@@ -690,6 +779,16 @@ forceinline meow_u128 MeowHash::hash(const HASH_64& value, const meow_u8 seed[12
    return _hash(reinterpret_cast<const void*>(seed), sizeof(HASH_64), reinterpret_cast<const void*>(&dat));
 }
 
+template<>
+forceinline meow_u128 MeowHash::hash(const std::string_view& value, const meow_u8 seed[128]) {
+   return _hash(reinterpret_cast<const void*>(seed), value.size(), reinterpret_cast<const void*>(value.data()));
+}
+
+template<>
+forceinline meow_u128 MeowHash::hash(const std::string& value, const meow_u8 seed[128]) {
+   return _hash(reinterpret_cast<const void*>(seed), value.size(), reinterpret_cast<const void*>(value.data()));
+}
+
 template<class T, unsigned int select = 0>
 struct MeowHash32 : private MeowHash {
    static std::string name() {
@@ -708,6 +807,22 @@ struct MeowHash32 : private MeowHash {
    forceinline HASH_32 operator()(const T& data) const {
       return Reduction::extract_32<select>(hash(data));
    }
+
+   /**
+    * Hashes n keys at once, see hash_batch() and hash_blocks()
+    */
+   forceinline void hash_batch(const T* in, HASH_64* out, const size_t& n) const
+      requires(std::is_same_v<T, HASH_32> || std::is_same_v<T, HASH_64>)
+   {
+      Batch::for_each_block<2>(
+         in, out, n,
+         [&](auto key) {
+            using namespace Batch;
+            using V = decltype(key);
+            return and64(bsrli128<4 * select>(hash_blocks<T>(key)), set128<V>(0, 0xFFFFFFFF));
+         },
+         *this);
+   }
 };
 template<class T, unsigned int select = 0>
 struct MeowHash64 : private MeowHash {
@@ -727,6 +842,16 @@ struct MeowHash64 : private MeowHash {
    forceinline HASH_64 operator()(const T& data) const {
       return Reduction::extract_64<select>(hash(data));
    }
+
+   /**
+    * Hashes n keys at once, see hash_batch() and hash_blocks()
+    */
+   forceinline void hash_batch(const T* in, HASH_64* out, const size_t& n) const
+      requires(std::is_same_v<T, HASH_32> || std::is_same_v<T, HASH_64>)
+   {
+      Batch::for_each_block<2>(
+         in, out, n, [&](auto key) { return Batch::bsrli128<8 * select>(hash_blocks<T>(key)); }, *this);
+   }
 };
 
 template<class T, unsigned int select = 0>
@@ -739,3 +864,13 @@ struct MeowHash128 : private MeowHash {
       return hash(key);
    }
 };
+
+#ifdef MEOW_AES_TARGET
+   #undef MEOW_AES_TARGET
+   #pragma pop_macro("forceinline")
+   #ifdef __clang__
+      #pragma clang attribute pop
+   #else
+      #pragma GCC pop_options
+   #endif
+#endif
@@ -32,6 +32,26 @@ struct MultiplicationHash {
       assert(p >= 0 && p <= t);
       return (key * constant) >> (t - p);
    }
+
+   /**
+    * Hashes n keys at once, multiplying one key per 64-bit vector lane (vpmullq
+    * on AVX-512), see hash_batch()
+    */
+   forceinline void hash_batch(const T* in, HASH_64* out, const size_t& n) const {
+      Batch::for_each_lane(
+         in, out, n,
+         [](auto key) {
+            using namespace Batch;
+            using V = decltype(key);
+            constexpr auto t = sizeof(T) * 8;
+
+            auto product = mullo64(key, set1<V>(constant));
+            if constexpr (t < 64)
+               product = and64(product, set1<V>((1LLU << t) - 1));
+            return srli64<t - p>(product);
+         },
+         *this);
+   }
 };
 
 const char MULT_PRIME_32[] = "mult_prime";
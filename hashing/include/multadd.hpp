@@ -23,6 +23,31 @@ struct MultiplicationAddHash {
       assert(p >= 0 && p <= t);
       return (key * constant1 + constant2) >> (t - p);
    }
+
+   /**
+    * Hashes n keys at once, see hash_batch(). Only 64-bit arithmetic (R) is
+    * vectorized, 128-bit arithmetic has no SIMD equivalent and stays scalar
+    */
+   forceinline void hash_batch(const T* in, HASH_64* out, const size_t& n) const {
+      if constexpr (sizeof(R) == 8) {
+         Batch::for_each_lane(
+            in, out, n,
+            [](auto key) {
+               using namespace Batch;
+               using V = decltype(key);
+               constexpr auto t = sizeof(T) * 8;
+
+               auto h = srli64<t - p>(add64(mullo64(key, set1<V>(constant1)), set1<V>(constant2)));
+               if constexpr (t < 64)
+                  h = and64(h, set1<V>((1LLU << t) - 1));
+               return h;
+            },
+            *this);
+      } else {
+         for (size_t i = 0; i < n; i++)
+            out[i] = (*this)(in[i]);
+      }
+   }
 };
 
 const char MA32[] = "mult_add";
@@ -20,6 +20,38 @@ struct MurmurFinalizer {
    }
 
    constexpr forceinline T operator()(T key) const;
+
+   /**
+    * Hashes n keys at once using one murmur fmix per 64-bit vector lane, see hash_batch()
+    */
+   forceinline void hash_batch(const T* in, HASH_64* out, const size_t& n) const
+      requires(sizeof(T) == 4 || sizeof(T) == 8)
+   {
+      Batch::for_each_lane(
+         in, out, n,
+         [](auto key) {
+            using namespace Batch;
+            using V = decltype(key);
+
+            if constexpr (sizeof(T) == 8) {
+               key = xor64(key, srli64<33>(key));
+               key = mullo64(key, set1<V>(0xff51afd7ed558ccdLLU));
+               key = xor64(key, srli64<33>(key));
+               key = mullo64(key, set1<V>(0xc4ceb9fe1a85ec53LLU));
+               key = xor64(key, srli64<33>(key));
+            } else {
+               // 32-bit multiplication overflow, i.e., keep lower 32 bits
+               const auto mask = set1<V>(0xFFFFFFFFLLU);
+               key = xor64(key, srli64<16>(key));
+               key = and64(mullo64(key, set1<V>(0x85ebca6bLU)), mask);
+               key = xor64(key, srli64<13>(key));
+               key = and64(mullo64(key, set1<V>(0xc2b2ae35LU)), mask);
+               key = xor64(key, srli64<16>(key));
+            }
+            return key;
+         },
+         *this);
+   }
 };
 
 template<>
@@ -44,6 +76,28 @@ constexpr HASH_64 MurmurFinalizer<HASH_64>::operator()(HASH_64 key) const {
    return key;
 }
 
+/**
+ * 128-bit keys, e.g., (tenant_id, object_id) pairs. Mixes both key halves like
+ * murmur3 x64_128's finalization, i.e., every output bit depends on both halves
+ */
+template<>
+constexpr HASH_128 MurmurFinalizer<HASH_128>::operator()(HASH_128 key) const {
+   const MurmurFinalizer<HASH_64> fmix64;
+   auto h1 = static_cast<HASH_64>(key);
+   auto h2 = static_cast<HASH_64>(key >> 64);
+
+   h1 += h2;
+   h2 += h1;
+
+   h1 = fmix64(h1);
+   h2 = fmix64(h2);
+
+   h1 += h2;
+   h2 += h1;
+
+   return to_hash128(h2, h1);
+}
+
 /**
  * Murmur3 32-bit, adjusted to fixed 32-bit input values (compiler would presumably perform the same optimizations.
  * However, in this explicit form it is clear what computation actually happens. This might be important for the
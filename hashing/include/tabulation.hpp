@@ -1,57 +1,106 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <random>
 #include <string>
+#include <utility>
 
 #include <convenience.hpp>
 
-template<class T, const T seed = 0, size_t COLUMNS = sizeof(T), size_t ROWS = 0xFF>
+/**
+ * Simple tabulation hashing, i.e., xor of one random table entry per key byte
+ *
+ * @tparam T key type
+ * @tparam init initial hash value
+ * @tparam COLUMNS amount of tables. Bytes i and i + COLUMNS share a table
+ * @tparam ROWS entries per table. 0xFF reduces each byte modulo 255
+ * @tparam Entry table entry type, i.e., hash width. Narrower entries keep the
+ *    tables cache resident (8x256 16-bit entries occupy 4KB instead of 16KB)
+ *    at the cost of a hash of only sizeof(Entry) * 8 bits
+ */
+template<class T, const T init = 0, size_t COLUMNS = sizeof(T), size_t ROWS = 0xFF, class Entry = T>
 struct _TabulationHashImplementation {
+   static_assert(sizeof(Entry) <= sizeof(T));
+
    static std::string name() {
-      return "tabulation_" + std::to_string(COLUMNS) + "x" + std::to_string(ROWS) + "_" + std::to_string(sizeof(T) * 8);
+      return "tabulation_" + std::to_string(COLUMNS) + "x" + std::to_string(ROWS) + "_" +
+         std::to_string(sizeof(T) * 8) + (sizeof(Entry) != sizeof(T) ? "_e" + std::to_string(sizeof(Entry) * 8) : "");
    }
 
    /**
-       * Initializes a tabulation hash tables with random data, depending on seed
-       * @tparam T hash output type, e.g., HASH_64
-       * @param table, must have 255 rows
-       * @param seed defaults to 1
-       */
-   _TabulationHashImplementation(unsigned int rand_seed = 0x238EF8E3LU) {
-      // TODO: consider better (but unseeded) random function:
-      //      std::ifstream file("/dev/random", std::ios::in | std::ios::binary | std::ios::ate);
-      //      if (file.is_open()) {
-      //         file.seekg(0, std::ios::beg);
-      //         file.read((char*) table, sizeof(T) * sizeof(T) * 0xFF);
-      //      }
-
-      const auto gen_column = [](std::array<T, ROWS>& column) {
-         for (auto& r : column) {
-            r = 0;
-            for (size_t i = 0; i < sizeof(T); i++) {
-               r |= static_cast<T>(rand() % 256) << 8 * i;
-            }
-         }
-      };
-
-      srand(rand_seed);
-      for (size_t c = 0; c < COLUMNS; c++) {
-         gen_column(table[c]);
-      }
+    * Initializes the tables with random data. Each instance draws from its own
+    * generator, i.e., this is thread safe and instances with equal rand_seed
+    * hash identically
+    *
+    * @param rand_seed seed for the table generator
+    */
+   explicit _TabulationHashImplementation(std::uint64_t rand_seed = 0x238EF8E3LU) : rand_seed(rand_seed) {
+      std::mt19937_64 rng(rand_seed);
+      for (size_t i = 0; i < COLUMNS * ROWS; i++)
+         table[i] = static_cast<Entry>(rng());
    }
 
    constexpr forceinline T operator()(const T& key) const {
-      T out = seed;
+      Entry out = static_cast<Entry>(init);
 
       for (size_t i = 0; i < sizeof(T); i++) {
-         out ^= table[i % COLUMNS][static_cast<uint8_t>(key >> (8 * i)) % ROWS];
+         out ^= table[(i % COLUMNS) * ROWS + static_cast<uint8_t>(key >> (8 * i)) % ROWS];
       }
       return out;
    }
 
+   /**
+    * @return seed the tables were generated from, see HashFamily
+    */
+   std::uint64_t seed() const {
+      return rand_seed;
+   }
+
+   /**
+    * Hashes n keys at once, gathering each column's table entries for a whole
+    * vector of keys, see hash_batch(). Only 64-bit tables are vectorized
+    */
+   forceinline void hash_batch(const T* in, HASH_64* out, const size_t& n) const
+      requires(sizeof(T) == 8)
+   {
+      Batch::for_each_lane(
+         in, out, n,
+         [&](auto key) {
+            using namespace Batch;
+            using V = decltype(key);
+            const auto byte_mask = set1<V>(0xFF);
+
+            auto h = set1<V>(static_cast<Entry>(init));
+            const auto lookup = [&]<size_t i>() {
+               auto index = and64(srli64<8 * i>(key), byte_mask);
+               if constexpr (ROWS == 0xFF) {
+                  // index % 255, i.e., 255 -> 0: (index + ((index + 1) >> 8)) & 0xFF
+                  index = and64(add64(index, srli64<8>(add64(index, set1<V>(1)))), byte_mask);
+               } else {
+                  static_assert(ROWS >= 0x100, "vectorized tabulation requires 255 or at least 256 rows");
+               }
+               const auto column = table.data() + (i % COLUMNS) * ROWS;
+               if constexpr (sizeof(Entry) == 8)
+                  h = xor64(h, gather64(column, index));
+               else
+                  h = xor64(h, gather_narrow(column, index));
+            };
+            [&]<size_t... i>(std::index_sequence<i...>) {
+               (lookup.template operator()<i>(), ...);
+            }(std::make_index_sequence<sizeof(T)>());
+
+            return h;
+         },
+         *this);
+   }
+
   private:
-   std::array<std::array<T, ROWS>, COLUMNS> table;
+   std::uint64_t rand_seed;
+   /// column major, padded such that gather_narrow() may read past the last entry
+   std::array<Entry, COLUMNS * ROWS + sizeof(HASH_64) / sizeof(Entry) - 1> table{};
 
    void print_table() {
       std::cout << "addr\t";
@@ -63,13 +112,95 @@ struct _TabulationHashImplementation {
       for (size_t r = 0; r < ROWS; r++) {
          std::cout << std::hex << r << "\t\t";
          for (size_t c = 0; c < COLUMNS; c++) {
-            std::cout << std::hex << table[c][r] << "\t\t";
+            std::cout << std::hex << table[c * ROWS + r] << "\t\t";
          }
          std::cout << std::endl;
       }
    }
 };
 
+/**
+ * Twisted tabulation hashing (Patrascu & Thorup), i.e., simple tabulation
+ * whose last key byte is first xored with a random byte ("twister") derived
+ * from the other bytes. Offers stronger guarantees than simple tabulation,
+ * e.g., for linear probing, at the cost of sizeof(T) - 1 byte lookups
+ *
+ * @tparam T key type
+ * @tparam init initial hash value
+ */
+template<class T, const T init = 0>
+struct TwistedTabulationHash {
+   static std::string name() {
+      return "twisted_tabulation_" + std::to_string(sizeof(T) * 8);
+   }
+
+   /**
+    * Initializes the tables with random data, see _TabulationHashImplementation
+    *
+    * @param rand_seed seed for the table generator
+    */
+   explicit TwistedTabulationHash(std::uint64_t rand_seed = 0x238EF8E3LU) : rand_seed(rand_seed) {
+      std::mt19937_64 rng(rand_seed);
+      for (size_t i = 0; i < sizeof(T) * 0x100; i++)
+         table[i] = static_cast<T>(rng());
+      for (size_t i = 0; i < (sizeof(T) - 1) * 0x100; i++)
+         twister[i] = static_cast<std::uint8_t>(rng());
+   }
+
+   constexpr forceinline T operator()(const T& key) const {
+      constexpr size_t last = sizeof(T) - 1;
+
+      T out = init;
+      std::uint8_t twist = 0;
+      for (size_t i = 0; i < last; i++) {
+         const auto c = static_cast<std::uint8_t>(key >> (8 * i));
+         out ^= table[i * 0x100 + c];
+         twist ^= twister[i * 0x100 + c];
+      }
+      return out ^ table[last * 0x100 + static_cast<std::uint8_t>(static_cast<std::uint8_t>(key >> (8 * last)) ^ twist)];
+   }
+
+   std::uint64_t seed() const {
+      return rand_seed;
+   }
+
+   /**
+    * Hashes n keys at once, see _TabulationHashImplementation::hash_batch()
+    */
+   forceinline void hash_batch(const T* in, HASH_64* out, const size_t& n) const
+      requires(sizeof(T) == 8)
+   {
+      Batch::for_each_lane(
+         in, out, n,
+         [&](auto key) {
+            using namespace Batch;
+            using V = decltype(key);
+            constexpr size_t last = sizeof(T) - 1;
+            const auto byte_mask = set1<V>(0xFF);
+
+            auto h = set1<V>(init);
+            auto twist = set1<V>(0);
+            const auto lookup = [&]<size_t i>() {
+               const auto index = and64(srli64<8 * i>(key), byte_mask);
+               h = xor64(h, gather64(table.data() + i * 0x100, index));
+               twist = xor64(twist, gather_narrow(twister.data() + i * 0x100, index));
+            };
+            [&]<size_t... i>(std::index_sequence<i...>) {
+               (lookup.template operator()<i>(), ...);
+            }(std::make_index_sequence<last>());
+
+            return xor64(h, gather64(table.data() + last * 0x100, xor64(srli64<8 * last>(key), twist)));
+         },
+         *this);
+   }
+
+  private:
+   std::uint64_t rand_seed;
+   std::array<T, sizeof(T) * 0x100> table{};
+   /// padded such that gather_narrow() may read past the last entry
+   std::array<std::uint8_t, (sizeof(T) - 1) * 0x100 + sizeof(HASH_64) - 1> twister{};
+};
+
 /**
  * Small tabulation hash, i.e., single column
  */
@@ -87,3 +218,11 @@ using MediumTabulationHash = _TabulationHashImplementation<T, seed, 4, 0xFF>;
  */
 template<class T, const T seed = 0>
 using LargeTabulationHash = _TabulationHashImplementation<T, seed, 8, 0xFF>;
+
+/**
+ * Compact tabulation hash, i.e., one column of 256 16-bit entries per key byte
+ * (4KB for 64-bit keys). Stays L1 resident next to table data but only yields 16-bit hashes, e.g.,
+ * for fingerprints or directories of at most 2^16 buckets
+ */
+template<class T, const T seed = 0>
+using CompactTabulationHash = _TabulationHashImplementation<T, seed, sizeof(T), 0x100, std::uint16_t>;
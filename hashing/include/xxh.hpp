@@ -1,10 +1,14 @@
 #pragma once
 
+#include <cstring>
 #include <string>
+#include <type_traits>
 
 #include <convenience.hpp>
 #include <thirdparty/xxhash.h>
 
+#include "bytes.hpp"
+
 #ifndef __clang__
    #warning "xxHash is supposedly faster with clang"
 #endif
@@ -16,7 +20,7 @@ struct XXHash32 {
    }
 
    forceinline HASH_32 operator()(const T& data) const {
-      return _XXHash::XXH32(&data, sizeof(T), seed);
+      return _XXHash::XXH32(key_bytes(data), key_length(data), seed);
    }
 };
 
@@ -27,7 +31,7 @@ struct XXHash64 {
    }
 
    forceinline HASH_64 operator()(const T& data) const {
-      return _XXHash::XXH64(&data, sizeof(T), seed);
+      return _XXHash::XXH64(key_bytes(data), key_length(data), seed);
    }
 };
 
@@ -38,7 +42,37 @@ struct XXHash3 {
    }
 
    forceinline HASH_64 operator()(const T& data) const {
-      return _XXHash::XXH3_64bits(&data, sizeof(T));
+      return _XXHash::XXH3_64bits(key_bytes(data), key_length(data));
+   }
+
+   /**
+    * Hashes n 8 byte keys at once, see hash_batch(). Vectorizes XXH3's
+    * 4-8 byte input path (XXH3_len_4to8_64b + XXH3_rrmxmx) for seed = 0
+    */
+   forceinline void hash_batch(const T* in, HASH_64* out, const size_t& n) const
+      requires(std::is_integral_v<T> && sizeof(T) == 8)
+   {
+      std::uint64_t s8, s16;
+      std::memcpy(&s8, _XXHash::XXH3_kSecret + 8, sizeof(s8));
+      std::memcpy(&s16, _XXHash::XXH3_kSecret + 16, sizeof(s16));
+      const std::uint64_t bitflip = s8 ^ s16;
+
+      Batch::for_each_lane(
+         in, out, n,
+         [&](auto key) {
+            using namespace Batch;
+            using V = decltype(key);
+            const auto prime = set1<V>(0x9FB21C651E98DF25LLU);
+
+            // input64 = input2 + (input1 << 32) with input1, input2 being the lower, upper key half
+            auto h = xor64(rotl64<32>(key), set1<V>(bitflip));
+            h = xor64(h, xor64(rotl64<49>(h), rotl64<24>(h)));
+            h = mullo64(h, prime);
+            h = xor64(h, add64(srli64<35>(h), set1<V>(sizeof(T))));
+            h = mullo64(h, prime);
+            return xor64(h, srli64<28>(h));
+         },
+         *this);
    }
 };
 
@@ -53,7 +87,7 @@ struct XXHash3Seeded {
    }
 
    forceinline HASH_64 operator()(const T& data) const {
-      return _XXHash::XXH3_64bits_withSeed(&data, sizeof(T), seed);
+      return _XXHash::XXH3_64bits_withSeed(key_bytes(data), key_length(data), seed);
    }
 };
 
@@ -64,7 +98,7 @@ struct XXHash3_128 {
    }
 
    forceinline HASH_128 operator()(const T& data) const {
-      const auto val = _XXHash::XXH3_128bits(&data, sizeof(T));
+      const auto val = _XXHash::XXH3_128bits(key_bytes(data), key_length(data));
       return to_hash128(val.high64, val.low64);
    }
 };
@@ -76,7 +110,7 @@ struct XXHash3_128Seeded {
    }
 
    forceinline HASH_128 operator()(const T& data) const {
-      const auto val = _XXHash::XXH3_128bits_withSeed(&data, sizeof(T), seed);
+      const auto val = _XXHash::XXH3_128bits_withSeed(key_bytes(data), key_length(data), seed);
       return to_hash128(val.high64, val.low64);
    }
 };
\ No newline at end of file
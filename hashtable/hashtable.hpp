@@ -1,5 +1,7 @@
 #pragma once
 
+#include "include/capacity.hpp"
 #include "include/chained.hpp"
 #include "include/cuckoo.hpp"
 #include "include/probing.hpp"
+#include "include/strings.hpp"
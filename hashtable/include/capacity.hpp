@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+
+#include <convenience.hpp>
+#include <reduction.hpp>
+
+namespace Hashtable {
+   /**
+    * Rounds a capacity up such that the table's directory size is a divisor
+    * that is cheap to reduce by, see Reduction::cheap_divisor()
+    *
+    * @tparam Table hashtable type providing directory_address_count()
+    * @param capacity requested capacity
+    * @param max_slack how much larger than requested the directory may become, e.g., 0.01 for 1%
+    * @return capacity >= requested capacity
+    */
+   template<class Table>
+   size_t cheap_capacity(const size_t& capacity, const double& max_slack) {
+      const auto requested = Table::directory_address_count(capacity);
+      const auto directory_size = Reduction::cheap_divisor(requested, max_slack);
+
+      // directory_address_count() is monotonic, i.e., scale and step up to the first matching capacity
+      auto cheap = static_cast<size_t>(static_cast<HASH_128>(capacity) * directory_size / requested);
+      while (Table::directory_address_count(cheap) < directory_size)
+         cheap++;
+      return cheap;
+   }
+} // namespace Hashtable
@@ -9,9 +9,13 @@
 
 #include <convenience.hpp>
 
+#include "occupancy.hpp"
+#include "payload.hpp"
+
 namespace Hashtable {
    template<class Key, class Payload, size_t BucketSize, class HashFn, class ReductionFn,
-            Key Sentinel = std::numeric_limits<Key>::max()>
+            Key Sentinel = std::numeric_limits<Key>::max(),
+            SlotOccupancy Occupancy = SlotOccupancy::Sentinel>
    struct Chained {
      public:
       using KeyType = Key;
@@ -35,21 +39,24 @@ namespace Hashtable {
        * @param key
        * @param payload
        * @return whether or not the key, payload pair was inserted. Insertion will fail
-       *    iff the same key already exists or if key == Sentinel value
+       *    iff the same key already exists or if key == Sentinel value (SlotOccupancy::Sentinel only)
        */
-      bool insert(const Key& key, const Payload& payload) {
-         if (unlikely(key == Sentinel)) {
-            assert(false); // TODO: this must never happen in practice
-            return false;
+      bool insert(const Key& key, const StoredPayload<Payload>& payload) {
+         if constexpr (Occupancy == SlotOccupancy::Sentinel) {
+            if (unlikely(key == Sentinel)) {
+               assert(false); // TODO: this must never happen in practice
+               return false;
+            }
          }
 
          // Using template functor should successfully inline actual hash computation
          FirstLevelSlot& slot = slots[reductionfn(hashfn(key))];
 
          // Store directly in slot if possible
-         if (slot.key == Sentinel) {
+         if (is_empty(slot)) {
             slot.key = key;
             slot.payload = payload;
+            mark_occupied(slot, 0);
             return true;
          }
 
@@ -58,6 +65,7 @@ namespace Hashtable {
          if (bucket == nullptr) {
             auto b = new Bucket();
             b->slots[0] = {.key = key, .payload = payload};
+            mark_occupied(*b, 0);
             slot.buckets = b;
             return true;
          }
@@ -67,8 +75,9 @@ namespace Hashtable {
             // Find suitable empty entry place. Note that deletions with holes will require
             // searching entire bucket to deal with duplicate keys!
             for (size_t i = 0; i < BucketSize; i++) {
-               if (bucket->slots[i].key == Sentinel) {
+               if (is_empty_slot<Key, Sentinel>(*bucket, i)) {
                   bucket->slots[i] = {.key = key, .payload = payload};
+                  mark_occupied(*bucket, i);
                   return true;
                } else if (bucket->slots[i].key == key) {
                   // key already exists
@@ -84,44 +93,57 @@ namespace Hashtable {
          // Append a new bucket to the chain and add element there
          auto b = new Bucket();
          b->slots[0] = {.key = key, .payload = payload};
+         mark_occupied(*b, 0);
          bucket->next = b;
          return true;
       }
 
+      /**
+       * Inserts a key into the set (Payload = void)
+       *
+       * @param key
+       * @return whether or not the key was inserted
+       */
+      bool insert(const Key& key)
+         requires std::is_void_v<Payload>
+      {
+         return insert(key, NoPayload());
+      }
+
       /**
        * Retrieves the associated payload/value for a given key.
        *
        * @param key
-       * @return the payload or std::nullopt if key was not found in the Hashtable
+       * @return the payload or std::nullopt if key was not found in the Hashtable. Sets
+       *    (Payload = void) return whether key was found instead
        */
-      std::optional<Payload> lookup(const Key& key) const {
-         if (unlikely(key == Sentinel)) {
-            assert(false); // TODO: this must never happen in practice
-            return std::nullopt;
+      LookupResult<Payload> lookup(const Key& key) const {
+         if constexpr (Occupancy == SlotOccupancy::Sentinel) {
+            if (unlikely(key == Sentinel)) {
+               assert(false); // TODO: this must never happen in practice
+               return not_found<Payload>();
+            }
          }
 
          // Using template functor should successfully inline actual hash computation
          const FirstLevelSlot& slot = slots[reductionfn(hashfn(key))];
 
-         if (slot.key == key) {
-            return std::make_optional(slot.payload);
-         }
+         if ((Occupancy == SlotOccupancy::Sentinel || !is_empty(slot)) && slot.key == key)
+            return found<Payload>(slot.payload);
 
          Bucket* bucket = slot.buckets;
          while (bucket != nullptr) {
-            for (size_t i = 0; i < BucketSize; i++) {
-               if (bucket->slots[i].key == key) {
-                  Payload payload = bucket->slots[i].payload;
-                  return std::make_optional(payload);
-               }
+            const auto i = find_key<Key, Sentinel, BucketSize>(*bucket, key);
+            if (i < BucketSize)
+               return found<Payload>(bucket->slots[i].payload);
+
+            if (has_empty_slot<Key, Sentinel, BucketSize>(*bucket))
+               return not_found<Payload>();
 
-               if (bucket->slots[i].key == Sentinel)
-                  return std::nullopt;
-            }
             bucket = bucket->next;
          }
 
-         return std::nullopt;
+         return not_found<Payload>();
       }
 
       std::map<std::string, std::string> lookup_statistics(const std::vector<Key>& dataset) {
@@ -134,7 +156,7 @@ namespace Hashtable {
          size_t empty_additional_slots = 0;
 
          for (const auto& slot : slots) {
-            if (slot.key == Sentinel) {
+            if (is_empty(slot)) {
                empty_buckets++;
                continue;
             }
@@ -145,8 +167,8 @@ namespace Hashtable {
                chain_length++;
                additional_buckets++;
 
-               for (const auto& s : b->slots)
-                  empty_additional_slots += s.key == Sentinel ? 1 : 0;
+               for (size_t i = 0; i < BucketSize; i++)
+                  empty_additional_slots += is_empty_slot<Key, Sentinel>(*b, i) ? 1 : 0;
 
                b = b->next;
             }
@@ -171,7 +193,7 @@ namespace Hashtable {
       }
 
       static forceinline std::string name() {
-         return "chained";
+         return std::string("chained") + (Occupancy == SlotOccupancy::Bitmap ? "_bitmap" : "");
       }
 
       static forceinline std::string hash_name() {
@@ -196,7 +218,10 @@ namespace Hashtable {
        */
       void clear() {
          for (auto& slot : slots) {
-            slot.key = Sentinel;
+            if constexpr (Occupancy == SlotOccupancy::Bitmap)
+               slot.occupancy.clear();
+            else
+               slot.key = Sentinel;
 
             auto bucket = slot.buckets;
             slot.buckets = nullptr;
@@ -214,23 +239,32 @@ namespace Hashtable {
       }
 
      protected:
-      struct Bucket {
+      struct alignas(bucket_alignment<Key, Occupancy, alignof(void*)>) Bucket {
          struct Slot {
             Key key = Sentinel;
-            Payload payload;
+            [[no_unique_address]] StoredPayload<Payload> payload;
          } packed;
 
          std::array<Slot, BucketSize> slots /*__attribute((aligned(sizeof(Key) * 8)))*/;
          Bucket* next = nullptr;
+         [[no_unique_address]] OccupancyBits<BucketSize, Occupancy> occupancy;
       } packed;
 
-      struct FirstLevelSlot {
+      struct alignas(bucket_alignment<Key, Occupancy>) FirstLevelSlot {
          Key key = Sentinel;
-         Payload payload;
+         [[no_unique_address]] StoredPayload<Payload> payload;
          Bucket* buckets = nullptr;
+         [[no_unique_address]] OccupancyBits<1, Occupancy> occupancy;
       } packed;
 
       // First bucket is always inline in the slot
       std::vector<FirstLevelSlot> slots;
+
+      static forceinline bool is_empty(const FirstLevelSlot& slot) {
+         if constexpr (Occupancy == SlotOccupancy::Bitmap)
+            return !slot.occupancy.test(0);
+         else
+            return slot.key == Sentinel;
+      }
    };
 } // namespace Hashtable
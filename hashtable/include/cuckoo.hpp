@@ -15,15 +15,27 @@
 #include <map>
 #include <optional>
 #include <random>
+#include <sstream>
+#include <string>
 #include <vector>
 #include <immintrin.h>
 
 #include <convenience.hpp>
+#include <hashing.hpp>
+
+#include "occupancy.hpp"
+#include "payload.hpp"
+#include "storage.hpp"
 
 namespace Hashtable {
    /**
     * Place entry in bucket with more available space.
     * If both are full, kick from either bucket with 50% chance
+    *
+    * Kicking functors assume that buckets are filled front to back, i.e., that
+    * all occupied slots precede all empty slots. If kicked_from is
+    * provided, it receives the bucket the victim was evicted from (required
+    * by partial-key cuckoo schemes, e.g., cuckoo filters)
     */
    struct BalancedKicking {
      private:
@@ -36,20 +48,20 @@ namespace Hashtable {
 
       template<class Bucket, class Key, class Payload, size_t BucketSize, Key Sentinel>
       forceinline std::optional<std::pair<Key, Payload>> operator()(Bucket* b1, Bucket* b2, const Key& key,
-                                                                    const Payload& payload) {
-         size_t c1 = 0, c2 = 0;
-         for (size_t i = 0; i < BucketSize; i++) {
-            c1 += (b1->slots[i].key == Sentinel ? 0 : 1);
-            c2 += (b2->slots[i].key == Sentinel ? 0 : 1);
-         }
+                                                                    const Payload& payload,
+                                                                    Bucket** kicked_from = nullptr) {
+         const size_t c1 = occupied_slot_count<Key, Sentinel, BucketSize>(*b1);
+         const size_t c2 = occupied_slot_count<Key, Sentinel, BucketSize>(*b2);
 
          if (c1 <= c2 && c1 < BucketSize) {
             b1->slots[c1] = {.key = key, .payload = payload};
+            mark_occupied(*b1, c1);
             return std::nullopt;
          }
 
          if (c2 < BucketSize) {
             b2->slots[c2] = {.key = key, .payload = payload};
+            mark_occupied(*b2, c2);
             return std::nullopt;
          }
 
@@ -59,6 +71,8 @@ namespace Hashtable {
          Key victim_key = victim_bucket->slots[victim_index].key;
          Payload victim_payload = victim_bucket->slots[victim_index].payload;
          victim_bucket->slots[victim_index] = {.key = key, .payload = payload};
+         if (kicked_from != nullptr)
+            *kicked_from = victim_bucket;
          return std::make_optional(std::make_pair(victim_key, victim_payload));
       };
    };
@@ -84,20 +98,20 @@ namespace Hashtable {
 
       template<class Bucket, class Key, class Payload, size_t BucketSize, Key Sentinel>
       forceinline std::optional<std::pair<Key, Payload>> operator()(Bucket* b1, Bucket* b2, const Key& key,
-                                                                    const Payload& payload) {
-         size_t c1 = 0, c2 = 0;
-         for (size_t i = 0; i < BucketSize; i++) {
-            c1 += (b1->slots[i].key == Sentinel ? 0 : 1);
-            c2 += (b2->slots[i].key == Sentinel ? 0 : 1);
-         }
+                                                                    const Payload& payload,
+                                                                    Bucket** kicked_from = nullptr) {
+         const size_t c1 = occupied_slot_count<Key, Sentinel, BucketSize>(*b1);
+         const size_t c2 = occupied_slot_count<Key, Sentinel, BucketSize>(*b2);
 
          if (c1 < BucketSize) {
             b1->slots[c1] = {.key = key, .payload = payload};
+            mark_occupied(*b1, c1);
             return std::nullopt;
          }
 
          if (c2 < BucketSize) {
             b2->slots[c2] = {.key = key, .payload = payload};
+            mark_occupied(*b2, c2);
             return std::nullopt;
          }
 
@@ -107,6 +121,8 @@ namespace Hashtable {
          Key victim_key = victim_bucket->slots[victim_index].key;
          Payload victim_payload = victim_bucket->slots[victim_index].payload;
          victim_bucket->slots[victim_index] = {.key = key, .payload = payload};
+         if (kicked_from != nullptr)
+            *kicked_from = victim_bucket;
          return std::make_optional(std::make_pair(victim_key, victim_payload));
       };
    };
@@ -119,51 +135,79 @@ namespace Hashtable {
    using UnbiasedKicking = BiasedKicking<0>;
 
    template<class Key, class Payload, size_t BucketSize, class HashFn1, class HashFn2, class ReductionFn1,
-            class ReductionFn2, class KickingFn, Key Sentinel = std::numeric_limits<Key>::max()>
+            class ReductionFn2, class KickingFn, Key Sentinel = std::numeric_limits<Key>::max(),
+            SlotOccupancy Occupancy = SlotOccupancy::Sentinel, size_t StaticCapacity = 0>
    class Cuckoo {
      public:
       using KeyType = Key;
       using PayloadType = Payload;
 
+      /// Buckets of tables with a StaticCapacity > 0 are stored inline
+      static constexpr size_t StaticBucketCount = (StaticCapacity + BucketSize - 1) / BucketSize;
+
      private:
       const size_t MaxKickCycleLength;
-      const HashFn1 hashfn1;
-      const HashFn2 hashfn2;
+      const size_t MaxRehashCount;
+      HashFn1 hashfn1;
+      HashFn2 hashfn2;
       const ReductionFn1 reductionfn1;
       const ReductionFn2 reductionfn2;
       KickingFn kickingfn;
 
-      struct Bucket {
+      struct alignas(bucket_alignment<Key, Occupancy>) Bucket {
          struct Slot {
             Key key = Sentinel;
-            Payload payload;
+            [[no_unique_address]] StoredPayload<Payload> payload;
          } packed;
 
          std::array<Slot, BucketSize> slots;
+         [[no_unique_address]] OccupancyBits<BucketSize, Occupancy> occupancy;
       } packed;
 
-      std::vector<Bucket> buckets;
+      BucketArray<Bucket, StaticBucketCount> buckets;
 
-      std::mt19937 rand_; // RNG for moving items around
+      std::mt19937 rand_; // RNG for moving items around & reseeding
+      size_t rehash_count = 0;
 
-     public:
-      Cuckoo(const size_t& capacity, const HashFn1 hashfn1 = HashFn1(), const HashFn2 hashfn2 = HashFn2())
-         : MaxKickCycleLength(50000), hashfn1(hashfn1), hashfn2(hashfn2),
+      Cuckoo(const size_t& capacity, const HashFn1 hashfn1, const HashFn2 hashfn2,
+             BucketArray<Bucket, StaticBucketCount>&& buckets)
+         : MaxKickCycleLength(50000), MaxRehashCount(16), hashfn1(hashfn1), hashfn2(hashfn2),
            reductionfn1(ReductionFn1(directory_address_count(capacity))),
            reductionfn2(ReductionFn2(directory_address_count(capacity))), kickingfn(KickingFn()),
-           buckets(directory_address_count(capacity)) {}
+           buckets(std::move(buckets)) {}
 
-      std::optional<Payload> lookup(const Key& key) const {
+      static std::string snapshot_type_name() {
+         return name() + "<" + hash_name() + "," + reducer_name() + ">";
+      }
+
+     public:
+      Cuckoo(const size_t& capacity, const HashFn1 hashfn1 = HashFn1(), const HashFn2 hashfn2 = HashFn2())
+         : Cuckoo(capacity, hashfn1, hashfn2,
+                  BucketArray<Bucket, StaticBucketCount>(directory_address_count(capacity))) {}
+
+      /**
+       * Constructs a table with StaticCapacity. Pair with compile time
+       * reducers, e.g., Reduction::ConstModulo<HASH_64, StaticBucketCount>, to
+       * have the compiler fold the reduction into the hash computation
+       */
+      explicit Cuckoo(const HashFn1 hashfn1 = HashFn1(), const HashFn2 hashfn2 = HashFn2())
+         requires(StaticCapacity > 0)
+         : Cuckoo(StaticCapacity, hashfn1, hashfn2) {}
+
+      /**
+       * Retrieves the associated payload/value for a given key.
+       *
+       * @param key
+       * @return the payload or std::nullopt if key was not found in the Hashtable. Sets
+       *    (Payload = void) return whether key was found instead
+       */
+      LookupResult<Payload> lookup(const Key& key) const {
          const auto h1 = hashfn1(key);
          const auto i1 = reductionfn1(h1);
 
          const Bucket* b1 = &buckets[i1];
-         for (size_t i = 0; i < BucketSize; i++) {
-            if (b1->slots[i].key == key) {
-               Payload payload = b1->slots[i].payload;
-               return std::make_optional(payload);
-            }
-         }
+         if (const auto i = find_key<Key, Sentinel, BucketSize>(*b1, key); i < BucketSize)
+            return found<Payload>(b1->slots[i].payload);
 
          auto i2 = reductionfn2(hashfn2(key, h1));
          if (i2 == i1) {
@@ -171,14 +215,10 @@ namespace Hashtable {
          }
 
          const Bucket* b2 = &buckets[i2];
-         for (size_t i = 0; i < BucketSize; i++) {
-            if (b2->slots[i].key == key) {
-               Payload payload = b2->slots[i].payload;
-               return std::make_optional(payload);
-            }
-         }
+         if (const auto i = find_key<Key, Sentinel, BucketSize>(*b2, key); i < BucketSize)
+            return found<Payload>(b2->slots[i].payload);
 
-         return std::nullopt;
+         return not_found<Payload>();
       }
 
       std::map<std::string, std::string> lookup_statistics(const std::vector<Key>& dataset) const {
@@ -190,26 +230,44 @@ namespace Hashtable {
 
             const Bucket* b1 = &buckets[i1];
             for (size_t i = 0; i < BucketSize; i++)
-               if (b1->slots[i].key == key)
+               if (!is_empty_slot<Key, Sentinel>(*b1, i) && b1->slots[i].key == key)
                   primary_key_cnt++;
          }
 
          return {
             {"primary_key_ratio",
              std::to_string(static_cast<long double>(primary_key_cnt) / static_cast<long double>(dataset.size()))},
+            {"rehash_count", std::to_string(rehash_count)},
          };
       }
 
-      void insert(const Key& key, const Payload& value) {
+      /**
+       * Inserts or updates a key. If the key can not be placed within
+       * MaxKickCycleLength kicks, the table is rehashed with freshly seeded hash
+       * functions, provided at least one of them is a HashFamily. Otherwise, or
+       * if MaxRehashCount rehashes fail, throws std::runtime_error. The table
+       * then holds every entry but the one displaced last
+       */
+      void insert(const Key& key, const StoredPayload<Payload>& value) {
          insert(key, value, 0);
       }
 
+      /**
+       * Inserts a key into the set (Payload = void)
+       */
+      void insert(const Key& key)
+         requires std::is_void_v<Payload>
+      {
+         insert(key, NoPayload(), 0);
+      }
+
       static constexpr forceinline size_t bucket_byte_size() {
          return sizeof(Bucket);
       }
 
       static forceinline std::string name() {
-         return "cuckoo_" + std::to_string(BucketSize) + "_" + KickingFn::name();
+         return "cuckoo_" + std::to_string(BucketSize) + "_" + KickingFn::name() +
+            (Occupancy == SlotOccupancy::Bitmap ? "_bitmap" : "");
       }
 
       static forceinline std::string hash_name() {
@@ -229,17 +287,69 @@ namespace Hashtable {
       }
 
       void clear() {
-         for (auto& bucket : buckets)
-            for (auto& slot : bucket.slots)
-               slot.key = Sentinel;
+         for (auto& bucket : buckets) {
+            if constexpr (Occupancy == SlotOccupancy::Bitmap)
+               bucket.occupancy.clear();
+            else
+               for (auto& slot : bucket.slots)
+                  slot.key = Sentinel;
+         }
+      }
+
+      /**
+       * Writes a snapshot of this table, i.e., its bucket array and the state of
+       * both hash functions, from which open_mmap() can restore the table without
+       * rebuilding it
+       *
+       * @param path output file, will be overwritten
+       */
+      void save(const std::string& path) const {
+         std::ostringstream state;
+         save_state(state, hashfn1);
+         save_state(state, hashfn2);
+         write_snapshot(path, snapshot_type_name(), buckets.size() * BucketSize, state.str(), buckets);
+      }
+
+      /**
+       * Opens a snapshot written by save(). Buckets are mapped copy-on-write,
+       * i.e., they are neither copied nor read until lookups touch them
+       *
+       * @param path snapshot file
+       */
+      static Cuckoo open_mmap(const std::string& path)
+         requires(StaticCapacity == 0)
+      {
+         Snapshot snapshot(path, snapshot_type_name(), sizeof(Bucket));
+         auto state = snapshot.state();
+         const auto hashfn1 = load_state<HashFn1>(state);
+         const auto hashfn2 = load_state<HashFn2>(state);
+         const size_t capacity = snapshot.header.capacity;
+         return Cuckoo(capacity, hashfn1, hashfn2, snapshot.buckets<Bucket>(directory_address_count(capacity)));
       }
 
      private:
-      void insert(Key key, Payload payload, size_t kick_count) {
+      void insert(const Key& key, const StoredPayload<Payload>& payload, size_t kick_count) {
+         const auto homeless = place(key, payload, kick_count);
+         if (likely(!homeless.has_value()))
+            return;
+
+         if constexpr (HashFamily<HashFn1> || HashFamily<HashFn2>)
+            rehash(homeless.value());
+         else
+            throw std::runtime_error("maximum kick cycle length (" + std::to_string(MaxKickCycleLength) + ") reached");
+      }
+
+      /**
+       * Places an entry, kicking other entries around if necessary
+       *
+       * @return the entry left without a slot once MaxKickCycleLength is exceeded
+       */
+      std::optional<std::pair<Key, StoredPayload<Payload>>> place(Key key, StoredPayload<Payload> payload,
+                                                                   size_t kick_count) {
       start:
          // TODO: track max kick_count for result graphs
          if (kick_count > MaxKickCycleLength) {
-            throw std::runtime_error("maximum kick cycle length (" + std::to_string(MaxKickCycleLength) + ") reached");
+            return std::make_optional(std::make_pair(key, payload));
          }
 
          const auto h1 = hashfn1(key);
@@ -254,25 +364,68 @@ namespace Hashtable {
          Bucket* b2 = &buckets[i2];
 
          // Update old value if the key is already in the table
-         for (size_t i = 0; i < BucketSize; i++) {
-            if (b1->slots[i].key == key) {
-               b1->slots[i].payload = payload;
-               return;
-            }
-            if (b2->slots[i].key == key) {
-               b2->slots[i].payload = payload;
-               return;
-            }
+         if (const auto i = find_key<Key, Sentinel, BucketSize>(*b1, key); i < BucketSize) {
+            b1->slots[i].payload = payload;
+            return std::nullopt;
+         }
+         if (const auto i = find_key<Key, Sentinel, BucketSize>(*b2, key); i < BucketSize) {
+            b2->slots[i].payload = payload;
+            return std::nullopt;
          }
 
          // Way to go Mr. Stroustrup
-         if (const auto kicked =
-                kickingfn.template operator()<Bucket, Key, Payload, BucketSize, Sentinel>(b1, b2, key, payload)) {
+         if (const auto kicked = kickingfn.template operator()<Bucket, Key, StoredPayload<Payload>, BucketSize, Sentinel>(
+                b1, b2, key, payload)) {
             key = kicked.value().first;
             payload = kicked.value().second;
             kick_count++;
             goto start;
          }
+         return std::nullopt;
+      }
+
+      /**
+       * Rebuilds the table with reseeded hash functions until all entries fit.
+       * Only hash functions that are a HashFamily are reseeded. If all
+       * MaxRehashCount attempts fail, buckets and hash functions are restored
+       * to their state before the rehash, i.e., only homeless is not stored
+       *
+       * @param homeless entry that could not be placed with the current hash functions
+       */
+      void rehash(const std::pair<Key, StoredPayload<Payload>>& homeless) {
+         const std::vector<Bucket> old_buckets(buckets.begin(), buckets.end());
+         const auto old_hashfn1 = hashfn1;
+         const auto old_hashfn2 = hashfn2;
+
+         std::vector<std::pair<Key, StoredPayload<Payload>>> entries{homeless};
+         for (const auto& bucket : old_buckets)
+            for (size_t i = 0; i < BucketSize; i++)
+               if (!is_empty_slot<Key, Sentinel>(bucket, i))
+                  entries.emplace_back(bucket.slots[i].key, bucket.slots[i].payload);
+
+         for (size_t attempt = 0; attempt < MaxRehashCount; attempt++) {
+            if constexpr (HashFamily<HashFn1>)
+               hashfn1 = HashFn1(next_seed());
+            if constexpr (HashFamily<HashFn2>)
+               hashfn2 = HashFn2(next_seed());
+            rehash_count++;
+
+            clear();
+            const auto placed = std::all_of(entries.begin(), entries.end(), [&](const auto& entry) {
+               return !place(entry.first, entry.second, 0).has_value();
+            });
+            if (placed)
+               return;
+         }
+
+         hashfn1 = old_hashfn1;
+         hashfn2 = old_hashfn2;
+         std::copy(old_buckets.begin(), old_buckets.end(), buckets.begin());
+         throw std::runtime_error("maximum rehash count (" + std::to_string(MaxRehashCount) + ") reached");
+      }
+
+      std::uint64_t next_seed() {
+         return (static_cast<std::uint64_t>(rand_()) << 32) | rand_();
       }
    };
 
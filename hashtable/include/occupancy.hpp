@@ -0,0 +1,305 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <immintrin.h>
+
+#include <convenience.hpp>
+
+namespace Hashtable {
+   /**
+    * How tables distinguish empty from occupied slots
+    */
+   enum class SlotOccupancy {
+      /// Empty slots contain a reserved Sentinel key, which therefore can't be stored
+      Sentinel,
+      /// Each bucket carries a control mask with one bit per slot. Every key value may be stored
+      Bitmap,
+   };
+
+   /**
+    * Smallest unsigned integer type with at least Slots bits
+    */
+   template<size_t Slots>
+   using OccupancyMask = std::conditional_t<
+      Slots <= 8, std::uint8_t,
+      std::conditional_t<Slots <= 16, std::uint16_t, std::conditional_t<Slots <= 32, std::uint32_t, std::uint64_t>>>;
+
+   /**
+    * Per bucket occupancy control mask. Empty (and therefore free when declared
+    * [[no_unique_address]]) unless Occupancy == SlotOccupancy::Bitmap
+    */
+   template<size_t Slots, SlotOccupancy Occupancy>
+   struct OccupancyBits {};
+
+   template<size_t Slots>
+   struct OccupancyBits<Slots, SlotOccupancy::Bitmap> {
+      static_assert(Slots > 0 && Slots <= 64, "occupancy bitmap supports at most 64 slots per bucket");
+
+      using Mask = OccupancyMask<Slots>;
+      static constexpr Mask Full =
+         Slots == std::numeric_limits<Mask>::digits ? std::numeric_limits<Mask>::max() : (Mask(1) << Slots) - 1;
+
+      Mask bits = 0;
+
+      forceinline bool full() const {
+         return bits == Full;
+      }
+
+      forceinline bool test(const size_t& i) const {
+         return (bits >> i) & 0x1;
+      }
+
+      forceinline void set(const size_t& i) {
+         bits |= Mask(1) << i;
+      }
+
+      forceinline void clear() {
+         bits = 0;
+      }
+
+      forceinline size_t count() const {
+         return __builtin_popcountll(bits);
+      }
+
+      /**
+       * @return index of the first free slot. Only valid iff !full()
+       */
+      forceinline size_t first_free() const {
+         return __builtin_ctzll(static_cast<std::uint64_t>(static_cast<Mask>(~bits)));
+      }
+
+      /**
+       * Calls pred(i) for each occupied slot index i in ascending order, stopping as
+       * soon as pred returns true. Only visits occupied slots (tzcnt scan), i.e.,
+       * empty slots never have to be compared against.
+       *
+       * @return index for which pred returned true or Slots
+       */
+      template<class Pred>
+      forceinline size_t find(const Pred& pred) const {
+         for (std::uint64_t m = bits; m != 0; m &= m - 1) {
+            const size_t i = __builtin_ctzll(m);
+            if (pred(i))
+               return i;
+         }
+         return Slots;
+      }
+   } packed;
+
+   /**
+    * Alignment of buckets (and chained first level slots). Occupancy control
+    * masks are stored behind a bucket's slots, i.e., keys start at offset 0.
+    * Buckets carrying a mask are padded to the key's alignment, otherwise
+    * every other bucket of an array would start at a misaligned address
+    *
+    * @tparam MinAlignment natural alignment of the bucket type, e.g., alignof(void*) for pointer members
+    */
+   template<class Key, SlotOccupancy Occupancy, size_t MinAlignment = 1>
+   constexpr size_t bucket_alignment =
+      std::max(Occupancy == SlotOccupancy::Bitmap ? alignof(Key) : size_t(1), MinAlignment);
+
+   /**
+    * @return whether slot i of bucket is empty, either based on bucket's occupancy
+    *    control mask or (if not present) by comparing the slot's key against Sentinel
+    */
+   template<class Key, Key Sentinel, class Bucket>
+   forceinline bool is_empty_slot(const Bucket& bucket, const size_t& i) {
+      if constexpr (requires { bucket.occupancy.bits; })
+         return !bucket.occupancy.test(i);
+      else
+         return bucket.slots[i].key == Sentinel;
+   }
+
+   /**
+    * @return amount of occupied slots in bucket. Assumes that buckets are
+    *    filled front to back when no occupancy control mask is present
+    */
+   template<class Key, Key Sentinel, size_t BucketSize, class Bucket>
+   forceinline size_t occupied_slot_count(const Bucket& bucket) {
+      if constexpr (requires { bucket.occupancy.bits; }) {
+         return bucket.occupancy.count();
+      } else {
+         size_t cnt = 0;
+         for (size_t i = 0; i < BucketSize; i++)
+            cnt += (bucket.slots[i].key == Sentinel ? 0 : 1);
+         return cnt;
+      }
+   }
+
+   /**
+    * Marks slot i of bucket as occupied. Noop if bucket has no occupancy control mask
+    */
+   template<class Bucket>
+   forceinline void mark_occupied(Bucket& bucket, const size_t& i) {
+      if constexpr (requires { bucket.occupancy.bits; })
+         bucket.occupancy.set(i);
+   }
+
+   /**
+    * Whether Key is a 128-bit key, e.g., a (tenant_id, object_id) pair packed
+    * into a HASH_128. Note that std::is_integral_v<HASH_128> is false in
+    * strict ISO mode (-std=c++20), hence the explicit check
+    */
+   template<class Key>
+   constexpr bool is_wide_key = std::is_same_v<Key, HASH_128>;
+
+   /**
+    * @return key's 16 bytes as one SSE register
+    */
+   template<class Key>
+   forceinline __m128i load_wide_key(const Key& key) {
+      static_assert(is_wide_key<Key>);
+      return _mm_loadu_si128(reinterpret_cast<const __m128i*>(&key));
+   }
+
+   /**
+    * @return whether both 16 byte keys are equal, compared with a single
+    *    SIMD compare instead of two dependent 64-bit compares
+    */
+   forceinline bool wide_keys_equal(const __m128i& a, const __m128i& b) {
+      return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) == 0xFFFF;
+   }
+
+   /**
+    * @return mask with bit i set iff bits 2i and 2i + 1 of lanes are set,
+    *    i.e., compresses a 64-bit lane compare mask to one bit per 128-bit key
+    */
+   forceinline std::uint64_t wide_key_mask(std::uint64_t lanes) {
+      lanes &= lanes >> 1;
+      std::uint64_t mask = 0;
+      for (size_t i = 0; i < 4; i++)
+         mask |= ((lanes >> (2 * i)) & 0x1) << i;
+      return mask;
+   }
+
+   /**
+    * Whether all keys of a bucket can be compared with a single SIMD
+    * instruction. Requires slots to consist of nothing but their 32, 64 or
+    * 128-bit key (i.e., set variants) and the bucket to span exactly one register
+    */
+   template<class Key, class Slot, size_t BucketSize>
+   constexpr bool vectorized_key_match = sizeof(Slot) == sizeof(Key) &&
+      ((std::is_integral_v<Key> && (sizeof(Key) == 4 || sizeof(Key) == 8)) || is_wide_key<Key>) &&
+      (
+#ifdef __AVX512F__
+         BucketSize * sizeof(Key) == 64 ||
+#endif
+#ifdef __AVX2__
+         BucketSize * sizeof(Key) == 32 ||
+#endif
+#ifdef __SSE4_1__
+         BucketSize * sizeof(Key) == 16 ||
+#endif
+         false);
+
+   /**
+    * @return mask with bit i set iff slots[i].key == key. Only available
+    *    iff vectorized_key_match<Key, Slot, BucketSize>
+    */
+   template<class Key, class Slot, size_t BucketSize>
+   forceinline std::uint64_t match_keys(const std::array<Slot, BucketSize>& slots, const Key& key) {
+      static_assert(vectorized_key_match<Key, Slot, BucketSize>);
+      const auto* mem = reinterpret_cast<const void*>(slots.data());
+      constexpr auto Bytes = BucketSize * sizeof(Key);
+
+#ifdef __AVX512F__
+      if constexpr (Bytes == 64) {
+         const auto vbucket = _mm512_loadu_si512(mem);
+         if constexpr (is_wide_key<Key>)
+            return wide_key_mask(_mm512_cmpeq_epi64_mask(vbucket, _mm512_broadcast_i32x4(load_wide_key(key))));
+         else if constexpr (sizeof(Key) == 4)
+            return _mm512_cmpeq_epi32_mask(vbucket, _mm512_set1_epi32(static_cast<int>(key)));
+         else
+            return _mm512_cmpeq_epi64_mask(vbucket, _mm512_set1_epi64(static_cast<long long>(key)));
+      }
+#endif
+#ifdef __AVX2__
+      if constexpr (Bytes == 32) {
+         const auto vbucket = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mem));
+         if constexpr (is_wide_key<Key>)
+            return wide_key_mask(_mm256_movemask_pd(_mm256_castsi256_pd(
+               _mm256_cmpeq_epi64(vbucket, _mm256_broadcastsi128_si256(load_wide_key(key))))));
+         else if constexpr (sizeof(Key) == 4)
+            return _mm256_movemask_ps(
+               _mm256_castsi256_ps(_mm256_cmpeq_epi32(vbucket, _mm256_set1_epi32(static_cast<int>(key)))));
+         else
+            return _mm256_movemask_pd(
+               _mm256_castsi256_pd(_mm256_cmpeq_epi64(vbucket, _mm256_set1_epi64x(static_cast<long long>(key)))));
+      }
+#endif
+#ifdef __SSE4_1__
+      if constexpr (Bytes == 16) {
+         const auto vbucket = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mem));
+         if constexpr (is_wide_key<Key>)
+            return wide_keys_equal(vbucket, load_wide_key(key)) ? 0x1 : 0x0;
+         else if constexpr (sizeof(Key) == 4)
+            return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(vbucket, _mm_set1_epi32(static_cast<int>(key)))));
+         else
+            return _mm_movemask_pd(
+               _mm_castsi128_pd(_mm_cmpeq_epi64(vbucket, _mm_set1_epi64x(static_cast<long long>(key)))));
+      }
+#endif
+      return 0;
+   }
+
+   /**
+    * @return index of the occupied slot of bucket that holds key or BucketSize
+    *    if there is none. Assumes that buckets are filled front to back
+    */
+   template<class Key, Key Sentinel, size_t BucketSize, class Bucket>
+   forceinline size_t find_key(const Bucket& bucket, const Key& key) {
+      using Slot = typename decltype(bucket.slots)::value_type;
+
+      if constexpr (vectorized_key_match<Key, Slot, BucketSize>) {
+         auto matches = match_keys(bucket.slots, key);
+         if constexpr (requires { bucket.occupancy.bits; })
+            matches &= bucket.occupancy.bits;
+         return matches == 0 ? BucketSize : __builtin_ctzll(matches);
+      } else if constexpr (is_wide_key<Key>) {
+         // slots interleave keys and payloads. Compare each 16 byte key as a whole
+         const auto vkey = load_wide_key(key);
+         const auto matches = [&](const size_t& i) {
+            return wide_keys_equal(load_wide_key(bucket.slots[i].key), vkey);
+         };
+
+         if constexpr (requires { bucket.occupancy.bits; }) {
+            return bucket.occupancy.find(matches);
+         } else {
+            const auto vsentinel = load_wide_key(Sentinel);
+            for (size_t i = 0; i < BucketSize; i++) {
+               if (matches(i))
+                  return i;
+               if (wide_keys_equal(load_wide_key(bucket.slots[i].key), vsentinel))
+                  break;
+            }
+            return BucketSize;
+         }
+      } else if constexpr (requires { bucket.occupancy.bits; }) {
+         return bucket.occupancy.find([&](const size_t& i) { return bucket.slots[i].key == key; });
+      } else {
+         for (size_t i = 0; i < BucketSize; i++) {
+            if (bucket.slots[i].key == key)
+               return i;
+            if (bucket.slots[i].key == Sentinel)
+               break;
+         }
+         return BucketSize;
+      }
+   }
+
+   /**
+    * @return whether bucket has at least one empty slot. Assumes that
+    *    buckets are filled front to back
+    */
+   template<class Key, Key Sentinel, size_t BucketSize, class Bucket>
+   forceinline bool has_empty_slot(const Bucket& bucket) {
+      if constexpr (requires { bucket.occupancy.bits; })
+         return !bucket.occupancy.full();
+      else
+         return bucket.slots[BucketSize - 1].key == Sentinel;
+   }
+} // namespace Hashtable
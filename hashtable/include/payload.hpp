@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+
+#include <convenience.hpp>
+
+namespace Hashtable {
+   /**
+    * Stand in for the payload of set variants (Payload = void). Declared
+    * [[no_unique_address]] inside slots it occupies no space, i.e., slots
+    * only consist of their key.
+    */
+   struct NoPayload {
+      bool operator==(const NoPayload&) const {
+         return true;
+      }
+   };
+
+   /**
+    * Type that is actually stored in a slot for a given Payload
+    */
+   template<class Payload>
+   using StoredPayload = std::conditional_t<std::is_void_v<Payload>, NoPayload, Payload>;
+
+   /**
+    * Result of lookup(): the payload or std::nullopt for maps, a plain
+    * membership bool for sets (Payload = void)
+    */
+   template<class Payload>
+   using LookupResult = std::conditional_t<std::is_void_v<Payload>, bool, std::optional<Payload>>;
+
+   template<class Payload>
+   forceinline LookupResult<Payload> found(const StoredPayload<Payload>& payload) {
+      if constexpr (std::is_void_v<Payload>) {
+         UNUSED(payload);
+         return true;
+      } else {
+         return std::make_optional(payload);
+      }
+   }
+
+   template<class Payload>
+   forceinline LookupResult<Payload> not_found() {
+      if constexpr (std::is_void_v<Payload>)
+         return false;
+      else
+         return std::nullopt;
+   }
+
+   /**
+    * @return amount of bytes a payload occupies per slot, i.e., 0 for sets
+    */
+   template<class Payload>
+   constexpr size_t payload_byte_size() {
+      if constexpr (std::is_void_v<Payload>)
+         return 0;
+      else
+         return sizeof(Payload);
+   }
+} // namespace Hashtable
@@ -1,12 +1,18 @@
 #pragma once
 
 #include <map>
+#include <sstream>
+#include <string>
 #include <vector>
 
 #include <convenience.hpp>
 #include <reduction.hpp>
 #include <thirdparty/libdivide.h>
 
+#include "occupancy.hpp"
+#include "payload.hpp"
+#include "storage.hpp"
+
 namespace Hashtable {
    struct LinearProbingFunc {
      private:
@@ -50,12 +56,17 @@ namespace Hashtable {
             class ReductionFn,
             class ProbingFn,
             size_t BucketSize = 1,
-            Key Sentinel = std::numeric_limits<Key>::max()>
+            Key Sentinel = std::numeric_limits<Key>::max(),
+            SlotOccupancy Occupancy = SlotOccupancy::Sentinel,
+            size_t StaticCapacity = 0>
    struct Probing {
      public:
       using KeyType = Key;
       using PayloadType = Payload;
 
+      /// Buckets of tables with a StaticCapacity > 0 are stored inline
+      static constexpr size_t StaticBucketCount = (StaticCapacity + BucketSize - 1) / BucketSize;
+
      private:
       const HashFn hashfn;
       const ReductionFn reductionfn;
@@ -68,6 +79,15 @@ namespace Hashtable {
            probingfn(ProbingFn(directory_address_count(capacity))), capacity(capacity),
            buckets(directory_address_count(capacity)) {}
 
+      /**
+       * Constructs a table with StaticCapacity. Pair with a compile time
+       * reducer, e.g., Reduction::ConstModulo<HASH_64, StaticBucketCount>, to
+       * have the compiler fold the reduction into the hash computation
+       */
+      explicit Probing(const HashFn hashfn = HashFn())
+         requires(StaticCapacity > 0)
+         : Probing(StaticCapacity, hashfn) {}
+
       Probing(Probing&&) = default;
 
       /**
@@ -79,12 +99,14 @@ namespace Hashtable {
        * @param key
        * @param payload
        * @return whether or not the key, payload pair was inserted. Insertion will fail
-       *    iff the same key already exists or if key == Sentinel value
+       *    iff the same key already exists or if key == Sentinel value (SlotOccupancy::Sentinel only)
        */
-      bool insert(const Key& key, const Payload payload) {
-         if (unlikely(key == Sentinel)) {
-            assert(false); // TODO: this must never happen in practice
-            return false;
+      bool insert(const Key& key, const StoredPayload<Payload> payload) {
+         if constexpr (Occupancy == SlotOccupancy::Sentinel) {
+            if (unlikely(key == Sentinel)) {
+               assert(false); // TODO: this must never happen in practice
+               return false;
+            }
          }
 
          // Using template functor should successfully inline actual hash computation
@@ -94,14 +116,27 @@ namespace Hashtable {
 
          for (;;) {
             auto& bucket = buckets[slot_index];
-            for (size_t i = 0; i < BucketSize; i++) {
-               if (bucket.slots[i].key == Sentinel) {
-                  bucket.slots[i] = {.key = key, .payload = payload};
-                  return true;
-               } else if (bucket.slots[i].key == key) {
+            if constexpr (Occupancy == SlotOccupancy::Bitmap) {
+               if (bucket.occupancy.find([&](const size_t& i) { return bucket.slots[i].key == key; }) < BucketSize) {
                   // key already exists
                   return false;
                }
+               if (!bucket.occupancy.full()) {
+                  const auto i = bucket.occupancy.first_free();
+                  bucket.slots[i] = {.key = key, .payload = payload};
+                  bucket.occupancy.set(i);
+                  return true;
+               }
+            } else {
+               for (size_t i = 0; i < BucketSize; i++) {
+                  if (bucket.slots[i].key == Sentinel) {
+                     bucket.slots[i] = {.key = key, .payload = payload};
+                     return true;
+                  } else if (bucket.slots[i].key == key) {
+                     // key already exists
+                     return false;
+                  }
+               }
             }
 
             // Slot is full, choose a new slot index based on probing function
@@ -112,16 +147,31 @@ namespace Hashtable {
          }
       }
 
+      /**
+       * Inserts a key into the set (Payload = void)
+       *
+       * @param key
+       * @return whether or not the key was inserted
+       */
+      bool insert(const Key& key)
+         requires std::is_void_v<Payload>
+      {
+         return insert(key, NoPayload());
+      }
+
       /**
        * Retrieves the associated payload/value for a given key.
        *
        * @param key
-       * @return the payload or std::nullopt if key was not found in the Hashtable
+       * @return the payload or std::nullopt if key was not found in the Hashtable. Sets
+       *    (Payload = void) return whether key was found instead
        */
-      std::optional<Payload> lookup(const Key& key) const {
-         if (unlikely(key == Sentinel)) {
-            assert(false); // TODO: this must never happen in practice
-            return std::nullopt;
+      LookupResult<Payload> lookup(const Key& key) const {
+         if constexpr (Occupancy == SlotOccupancy::Sentinel) {
+            if (unlikely(key == Sentinel)) {
+               assert(false); // TODO: this must never happen in practice
+               return not_found<Payload>();
+            }
          }
 
          // Using template functor should successfully inline actual hash computation
@@ -131,18 +181,18 @@ namespace Hashtable {
 
          for (;;) {
             auto& bucket = buckets[slot_index];
-            for (size_t i = 0; i < BucketSize; i++) {
-               if (bucket.slots[i].key == key)
-                  return std::make_optional(bucket.slots[i].payload);
+            const auto i = find_key<Key, Sentinel, BucketSize>(bucket, key);
+            if (i < BucketSize)
+               return found<Payload>(bucket.slots[i].payload);
 
-               if (bucket.slots[i].key == Sentinel)
-                  return std::nullopt;
-            }
+            // Buckets are filled front to back, i.e., probing ends at the first non full bucket
+            if (has_empty_slot<Key, Sentinel, BucketSize>(bucket))
+               return not_found<Payload>();
 
             // Slot is full, choose a new slot index based on probing function
             slot_index = probingfn(orig_slot_index, ++probing_step);
             if (unlikely(slot_index == orig_slot_index))
-               return std::nullopt;
+               return not_found<Payload>();
          }
       }
 
@@ -158,15 +208,15 @@ namespace Hashtable {
             for (;;) {
                auto& bucket = buckets[slot_index];
                for (size_t i = 0; i < BucketSize; i++) {
+                  if (is_empty_slot<Key, Sentinel>(bucket, i))
+                     goto next;
+
                   if (bucket.slots[i].key == key) {
                      min_psl = std::min(min_psl, probing_step);
                      max_psl = std::max(max_psl, probing_step);
                      total_psl += probing_step;
                      goto next;
                   }
-
-                  if (bucket.slots[i].key == Sentinel)
-                     goto next;
                }
 
                // Slot is full, choose a new slot index based on probing function
@@ -189,7 +239,7 @@ namespace Hashtable {
       }
 
       static forceinline std::string name() {
-         return ProbingFn::name() + "_probing";
+         return ProbingFn::name() + "_probing" + (Occupancy == SlotOccupancy::Bitmap ? "_bitmap" : "");
       }
 
       static forceinline std::string hash_name() {
@@ -214,27 +264,68 @@ namespace Hashtable {
        */
       void clear() {
          for (auto& bucket : buckets) {
-            for (auto& slot : bucket.slots) {
-               slot.key = Sentinel;
-            }
+            if constexpr (Occupancy == SlotOccupancy::Bitmap)
+               bucket.occupancy.clear();
+            else
+               for (auto& slot : bucket.slots)
+                  slot.key = Sentinel;
          }
       }
 
+      /**
+       * Writes a snapshot of this table, i.e., its bucket array and hash function
+       * state, from which open_mmap() can restore the table without rebuilding it
+       *
+       * @param path output file, will be overwritten
+       */
+      void save(const std::string& path) const {
+         std::ostringstream state;
+         save_state(state, hashfn);
+         write_snapshot(path, snapshot_type_name(), capacity, state.str(), buckets);
+      }
+
+      /**
+       * Opens a snapshot written by save(). Buckets are mapped copy-on-write,
+       * i.e., they are neither copied nor read until lookups touch them
+       *
+       * @param path snapshot file
+       */
+      static Probing open_mmap(const std::string& path)
+         requires(StaticCapacity == 0)
+      {
+         Snapshot snapshot(path, snapshot_type_name(), sizeof(Bucket));
+         auto state = snapshot.state();
+         const auto hashfn = load_state<HashFn>(state);
+         const size_t capacity = snapshot.header.capacity;
+         return Probing(capacity, hashfn, snapshot.buckets<Bucket>(directory_address_count(capacity)));
+      }
+
       ~Probing() {
-         clear();
+         // Clearing a mapped snapshot would copy every page
+         if (!buckets.mapped())
+            clear();
       }
 
      protected:
-      struct Bucket {
+      struct alignas(bucket_alignment<Key, Occupancy>) Bucket {
          struct Slot {
             Key key = Sentinel;
-            Payload payload;
+            [[no_unique_address]] StoredPayload<Payload> payload;
          } packed;
 
          std::array<Slot, BucketSize> slots /*__attribute((aligned(sizeof(Key) * 8)))*/;
+         [[no_unique_address]] OccupancyBits<BucketSize, Occupancy> occupancy;
       } packed;
 
-      std::vector<Bucket> buckets;
+      BucketArray<Bucket, StaticBucketCount> buckets;
+
+      Probing(const size_t& capacity, const HashFn hashfn, BucketStorage<Bucket>&& buckets)
+         : hashfn(hashfn), reductionfn(ReductionFn(directory_address_count(capacity))),
+           probingfn(ProbingFn(directory_address_count(capacity))), capacity(capacity), buckets(std::move(buckets)) {}
+
+      static std::string snapshot_type_name() {
+         return name() + "<" + hash_name() + "," + reducer_name() + "," + std::to_string(BucketSize) + ">";
+      }
    };
 
    template<class Key,
@@ -243,7 +334,8 @@ namespace Hashtable {
             class ReductionFn,
             class ProbingFn,
             size_t BucketSize = 1,
-            Key Sentinel = std::numeric_limits<Key>::max()>
+            Key Sentinel = std::numeric_limits<Key>::max(),
+            SlotOccupancy Occupancy = SlotOccupancy::Sentinel>
    struct RobinhoodProbing {
      public:
       typedef Key KeyType;
@@ -272,18 +364,20 @@ namespace Hashtable {
        * @param key
        * @param payload
        * @return whether or not the key, payload pair was inserted. Insertion will fail
-       *    iff the same key already exists or if key == Sentinel value
+       *    iff the same key already exists or if key == Sentinel value (SlotOccupancy::Sentinel only)
        */
-      bool insert(const Key& k, const Payload& p) {
+      bool insert(const Key& k, const StoredPayload<Payload>& p) {
          // r+w variables (required to avoid insert recursion+issues)
          auto key = k;
          auto payload = p;
 
          const auto orig_key = key;
 
-         if (unlikely(key == Sentinel)) {
-            assert(false); // TODO: this must never happen in practice
-            return false;
+         if constexpr (Occupancy == SlotOccupancy::Sentinel) {
+            if (unlikely(key == Sentinel)) {
+               assert(false); // TODO: this must never happen in practice
+               return false;
+            }
          }
 
          // Using template functor should successfully inline actual hash computation
@@ -294,8 +388,9 @@ namespace Hashtable {
          for (;;) {
             auto& bucket = buckets[slot_index];
             for (size_t i = 0; i < BucketSize; i++) {
-               if (bucket.slots[i].key == Sentinel) {
+               if (is_empty_slot<Key, Sentinel>(bucket, i)) {
                   bucket.slots[i] = {.key = key, .psl = probing_step, .payload = payload};
+                  mark_occupied(bucket, i);
                   return true;
                } else if (bucket.slots[i].key == key) {
                   // key already exists
@@ -326,16 +421,31 @@ namespace Hashtable {
          }
       }
 
+      /**
+       * Inserts a key into the set (Payload = void)
+       *
+       * @param key
+       * @return whether or not the key was inserted
+       */
+      bool insert(const Key& key)
+         requires std::is_void_v<Payload>
+      {
+         return insert(key, NoPayload());
+      }
+
       /**
        * Retrieves the associated payload/value for a given key.
        *
        * @param key
-       * @return the payload or std::nullopt if key was not found in the Hashtable
+       * @return the payload or std::nullopt if key was not found in the Hashtable. Sets
+       *    (Payload = void) return whether key was found instead
        */
-      std::optional<Payload> lookup(const Key& key) const {
-         if (unlikely(key == Sentinel)) {
-            assert(false); // TODO: this must never happen in practice
-            return std::nullopt;
+      LookupResult<Payload> lookup(const Key& key) const {
+         if constexpr (Occupancy == SlotOccupancy::Sentinel) {
+            if (unlikely(key == Sentinel)) {
+               assert(false); // TODO: this must never happen in practice
+               return not_found<Payload>();
+            }
          }
 
          // Using template functor should successfully inline actual hash computation
@@ -345,18 +455,18 @@ namespace Hashtable {
 
          for (;;) {
             auto& bucket = buckets[slot_index];
-            for (size_t i = 0; i < BucketSize; i++) {
-               if (bucket.slots[i].key == key)
-                  return std::make_optional(bucket.slots[i].payload);
+            const auto i = find_key<Key, Sentinel, BucketSize>(bucket, key);
+            if (i < BucketSize)
+               return found<Payload>(bucket.slots[i].payload);
 
-               if (bucket.slots[i].key == Sentinel)
-                  return std::nullopt;
-            }
+            // Buckets are filled front to back, i.e., probing ends at the first non full bucket
+            if (has_empty_slot<Key, Sentinel, BucketSize>(bucket))
+               return not_found<Payload>();
 
             // Slot is full, choose a new slot index based on probing function
             slot_index = probingfn(orig_slot_index, ++probing_step);
             if (unlikely(slot_index == orig_slot_index))
-               return std::nullopt;
+               return not_found<Payload>();
          }
       }
 
@@ -372,15 +482,15 @@ namespace Hashtable {
             for (;;) {
                auto& bucket = buckets[slot_index];
                for (size_t i = 0; i < BucketSize; i++) {
+                  if (is_empty_slot<Key, Sentinel>(bucket, i))
+                     goto next;
+
                   if (bucket.slots[i].key == key) {
                      min_psl = std::min(min_psl, probing_step);
                      max_psl = std::max(max_psl, probing_step);
                      total_psl += probing_step;
                      goto next;
                   }
-
-                  if (bucket.slots[i].key == Sentinel)
-                     goto next;
                }
 
                // Slot is full, choose a new slot index based on probing function
@@ -403,7 +513,7 @@ namespace Hashtable {
       }
 
       static forceinline std::string name() {
-         return ProbingFn::name() + "_robinhood_probing";
+         return ProbingFn::name() + "_robinhood_probing" + (Occupancy == SlotOccupancy::Bitmap ? "_bitmap" : "");
       }
 
       static forceinline std::string hash_name() {
@@ -428,27 +538,66 @@ namespace Hashtable {
        */
       void clear() {
          for (auto& bucket : buckets) {
-            for (auto& slot : bucket.slots) {
-               slot.key = Sentinel;
-            }
+            if constexpr (Occupancy == SlotOccupancy::Bitmap)
+               bucket.occupancy.clear();
+            else
+               for (auto& slot : bucket.slots)
+                  slot.key = Sentinel;
          }
       }
 
+      /**
+       * Writes a snapshot of this table, i.e., its bucket array and hash function
+       * state, from which open_mmap() can restore the table without rebuilding it
+       *
+       * @param path output file, will be overwritten
+       */
+      void save(const std::string& path) const {
+         std::ostringstream state;
+         save_state(state, hashfn);
+         write_snapshot(path, snapshot_type_name(), capacity, state.str(), buckets);
+      }
+
+      /**
+       * Opens a snapshot written by save(). Buckets are mapped copy-on-write,
+       * i.e., they are neither copied nor read until lookups touch them
+       *
+       * @param path snapshot file
+       */
+      static RobinhoodProbing open_mmap(const std::string& path) {
+         Snapshot snapshot(path, snapshot_type_name(), sizeof(Bucket));
+         auto state = snapshot.state();
+         const auto hashfn = load_state<HashFn>(state);
+         const size_t capacity = snapshot.header.capacity;
+         return RobinhoodProbing(capacity, hashfn, snapshot.buckets<Bucket>(directory_address_count(capacity)));
+      }
+
       ~RobinhoodProbing() {
-         clear();
+         // Clearing a mapped snapshot would copy every page
+         if (!buckets.mapped())
+            clear();
       }
 
      protected:
-      struct Bucket {
+      struct alignas(bucket_alignment<Key, Occupancy>) Bucket {
          struct Slot {
             Key key = Sentinel;
             size_t psl;
-            Payload payload;
+            [[no_unique_address]] StoredPayload<Payload> payload;
          } packed;
 
          std::array<Slot, BucketSize> slots /*__attribute((aligned(sizeof(Key) * 8)))*/;
+         [[no_unique_address]] OccupancyBits<BucketSize, Occupancy> occupancy;
       } packed;
 
-      std::vector<Bucket> buckets;
+      BucketStorage<Bucket> buckets;
+
+      RobinhoodProbing(const size_t& capacity, const HashFn hashfn, BucketStorage<Bucket>&& buckets)
+         : hashfn(hashfn), reductionfn(ReductionFn(directory_address_count(capacity))),
+           probingfn(ProbingFn(directory_address_count(capacity))), capacity(capacity), buckets(std::move(buckets)) {}
+
+      static std::string snapshot_type_name() {
+         return name() + "<" + hash_name() + "," + reducer_name() + "," + std::to_string(BucketSize) + ">";
+      }
    };
 } // namespace Hashtable
\ No newline at end of file
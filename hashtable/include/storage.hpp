@@ -0,0 +1,380 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <convenience.hpp>
+#include <hashing.hpp>
+
+namespace Hashtable {
+   /**
+    * View of a whole file, mapped into memory. Pages are readable and writable
+    * but mapped copy-on-write (MAP_PRIVATE), i.e., tables opened from a
+    * snapshot accept inserts, yet modifications never reach the file
+    */
+   struct MappedFile {
+      explicit MappedFile(const std::string& path) {
+         const int fd = ::open(path.c_str(), O_RDONLY);
+         if (fd < 0)
+            throw std::runtime_error("could not open '" + path + "' for mapping");
+
+         struct stat st {};
+         if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("could not stat '" + path + "'");
+         }
+         length = static_cast<size_t>(st.st_size);
+
+         if (length > 0)
+            addr = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+         ::close(fd);
+
+         if (addr == MAP_FAILED) {
+            addr = nullptr;
+            throw std::runtime_error("could not mmap '" + path + "'");
+         }
+      }
+
+      MappedFile() = default;
+      MappedFile(const MappedFile&) = delete;
+      MappedFile& operator=(const MappedFile&) = delete;
+
+      MappedFile(MappedFile&& other) noexcept
+         : addr(std::exchange(other.addr, nullptr)), length(std::exchange(other.length, 0)) {}
+
+      ~MappedFile() {
+         if (addr != nullptr)
+            ::munmap(addr, length);
+      }
+
+      forceinline std::byte* data() const {
+         return static_cast<std::byte*>(addr);
+      }
+
+      forceinline size_t size() const {
+         return length;
+      }
+
+     private:
+      void* addr = nullptr;
+      size_t length = 0;
+   };
+
+   /**
+    * Bucket array of a hashtable. Buckets are either owned (heap allocated,
+    * default initialized) or live inside a snapshot file mapped into memory,
+    * in which case opening a table does not copy (or even touch) its buckets.
+    *
+    * @tparam Bucket trivially copyable bucket type
+    */
+   template<class Bucket>
+   struct BucketStorage {
+      explicit BucketStorage(const size_t& bucket_count)
+         : owned(bucket_count), first(owned.data()), count(bucket_count) {}
+
+      BucketStorage(MappedFile&& file, const size_t& offset, const size_t& bucket_count)
+         : mapping(std::move(file)), first(reinterpret_cast<Bucket*>(mapping.data() + offset)), count(bucket_count) {
+         if (offset + bucket_count * sizeof(Bucket) > mapping.size())
+            throw std::runtime_error("mapped bucket array exceeds file size");
+      }
+
+      BucketStorage(BucketStorage&& other) noexcept
+         : owned(std::move(other.owned)), mapping(std::move(other.mapping)), first(std::exchange(other.first, nullptr)),
+           count(std::exchange(other.count, 0)) {}
+
+      forceinline Bucket& operator[](const size_t& i) {
+         return first[i];
+      }
+
+      forceinline const Bucket& operator[](const size_t& i) const {
+         return first[i];
+      }
+
+      forceinline size_t size() const {
+         return count;
+      }
+
+      forceinline const Bucket* data() const {
+         return first;
+      }
+
+      forceinline Bucket* begin() {
+         return first;
+      }
+
+      forceinline Bucket* end() {
+         return first + count;
+      }
+
+      forceinline const Bucket* begin() const {
+         return first;
+      }
+
+      forceinline const Bucket* end() const {
+         return first + count;
+      }
+
+      /**
+       * @return whether buckets live in a mapped snapshot file
+       */
+      forceinline bool mapped() const {
+         return mapping.data() != nullptr;
+      }
+
+     private:
+      std::vector<Bucket> owned;
+      MappedFile mapping;
+      Bucket* first;
+      size_t count;
+   };
+
+   /**
+    * Bucket array whose size is known at compile time. Buckets are stored
+    * inline (i.e., no indirection through a heap pointer) and the bucket count
+    * is a constant. Interface mirrors BucketStorage
+    *
+    * @tparam Bucket bucket type
+    * @tparam Count amount of buckets
+    */
+   template<class Bucket, size_t Count>
+   struct StaticBucketStorage {
+      explicit StaticBucketStorage(const size_t& bucket_count) {
+         if (bucket_count != Count)
+            throw std::runtime_error("static bucket storage holds " + std::to_string(Count) + " buckets, " +
+                                     std::to_string(bucket_count) + " were requested");
+      }
+
+      forceinline Bucket& operator[](const size_t& i) {
+         return buckets[i];
+      }
+
+      forceinline const Bucket& operator[](const size_t& i) const {
+         return buckets[i];
+      }
+
+      static constexpr forceinline size_t size() {
+         return Count;
+      }
+
+      forceinline const Bucket* data() const {
+         return buckets.data();
+      }
+
+      forceinline Bucket* begin() {
+         return buckets.data();
+      }
+
+      forceinline Bucket* end() {
+         return buckets.data() + Count;
+      }
+
+      forceinline const Bucket* begin() const {
+         return buckets.data();
+      }
+
+      forceinline const Bucket* end() const {
+         return buckets.data() + Count;
+      }
+
+      static constexpr forceinline bool mapped() {
+         return false;
+      }
+
+     private:
+      std::array<Bucket, Count> buckets;
+   };
+
+   /**
+    * Bucket array of a table, i.e., StaticBucketStorage if StaticCount > 0
+    * and BucketStorage otherwise
+    */
+   template<class Bucket, size_t StaticCount>
+   using BucketArray =
+      std::conditional_t<StaticCount == 0, BucketStorage<Bucket>, StaticBucketStorage<Bucket, StaticCount>>;
+
+   /**
+    * Serializes (hash) functor state. Only functors whose state is known to
+    * survive a round trip through a file are accepted, i.e., functors that
+    *  1. provide serialize(std::ostream&) and static deserialize(std::istream&) hooks
+    *  2. are a HashFamily, i.e., are fully determined by their seed
+    *  3. are stateless (empty)
+    * Anything else is rejected at compile time: raw bytes of an arbitrary
+    * functor may hold pointers, which dangle once the snapshot is reopened
+    */
+   template<class Fn>
+   void save_state(std::ostream& out, const Fn& fn) {
+      if constexpr (requires { fn.serialize(out); }) {
+         fn.serialize(out);
+      } else if constexpr (HashFamily<Fn>) {
+         const std::uint64_t seed = fn.seed();
+         out.write(reinterpret_cast<const char*>(&seed), sizeof(seed));
+      } else {
+         static_assert(std::is_empty_v<Fn>,
+                       "functor state can not be snapshotted, provide serialize()/deserialize() hooks");
+      }
+   }
+
+   /**
+    * Inverse of save_state()
+    */
+   template<class Fn>
+   Fn load_state(std::istream& in) {
+      if constexpr (requires { Fn::deserialize(in); }) {
+         return Fn::deserialize(in);
+      } else if constexpr (HashFamily<Fn>) {
+         std::uint64_t seed;
+         if (!in.read(reinterpret_cast<char*>(&seed), sizeof(seed)))
+            throw std::runtime_error("snapshot hash state is truncated");
+         return Fn(seed);
+      } else {
+         static_assert(std::is_empty_v<Fn>,
+                       "functor state can not be snapshotted, provide serialize()/deserialize() hooks");
+         return Fn{};
+      }
+   }
+
+   /**
+    * Flat, versioned on disk image of a hashtable:
+    *
+    *    [SnapshotHeader][hash state bytes][padding][bucket array]
+    *
+    * The bucket array starts at a page boundary, i.e., mapping the file yields
+    * a bucket array that is usable as is (same host architecture assumed).
+    */
+   struct SnapshotHeader {
+      static constexpr std::uint64_t Magic = 0x50414E5348534148LLU; // "HASHSNAP"
+      static constexpr std::uint32_t Version = 2;
+      static constexpr size_t BucketAlignment = 4096;
+
+      std::uint64_t magic = Magic;
+      std::uint32_t version = Version;
+      std::uint32_t bucket_byte_size = 0;
+      /// fingerprint of table, hash and reducer names, guards against opening with a different type
+      std::uint64_t type_fingerprint = 0;
+      std::uint64_t capacity = 0;
+      std::uint64_t bucket_count = 0;
+      std::uint64_t state_byte_size = 0;
+      std::uint64_t bucket_offset = 0;
+
+      /**
+       * 64-bit FNV-1a of a (type) name. Unlike std::hash this is stable across
+       * compilers and standard libraries
+       */
+      static std::uint64_t fingerprint(const std::string& name) {
+         std::uint64_t h = 0xCBF29CE484222325LLU;
+         for (const auto& c : name) {
+            h ^= static_cast<std::uint8_t>(c);
+            h *= 0x100000001B3LLU;
+         }
+         return h;
+      }
+   } packed;
+
+   /**
+    * Writes a snapshot image
+    *
+    * @param path output file, will be overwritten
+    * @param type_name name uniquely identifying the table type, see SnapshotHeader::type_fingerprint
+    * @param capacity capacity the table was constructed with
+    * @param state serialized hash function state, see save_state()
+    * @param buckets bucket array, e.g., BucketStorage
+    */
+   template<class Buckets>
+   void write_snapshot(const std::string& path, const std::string& type_name, const size_t& capacity,
+                       const std::string& state, const Buckets& buckets) {
+      using Bucket = std::remove_cvref_t<decltype(*buckets.data())>;
+      static_assert(std::is_trivially_copyable_v<Bucket>, "buckets must be trivially copyable to be snapshotted");
+
+      SnapshotHeader header;
+      header.bucket_byte_size = sizeof(Bucket);
+      header.type_fingerprint = SnapshotHeader::fingerprint(type_name);
+      header.capacity = capacity;
+      header.bucket_count = buckets.size();
+      header.state_byte_size = state.size();
+      header.bucket_offset = (sizeof(SnapshotHeader) + state.size() + SnapshotHeader::BucketAlignment - 1) /
+         SnapshotHeader::BucketAlignment * SnapshotHeader::BucketAlignment;
+
+      std::ofstream out(path, std::ios::binary | std::ios::trunc);
+      if (!out.is_open())
+         throw std::runtime_error("could not open '" + path + "' for writing");
+
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      out.write(state.data(), state.size());
+      const std::vector<char> padding(header.bucket_offset - sizeof(header) - state.size(), 0);
+      out.write(padding.data(), padding.size());
+      out.write(reinterpret_cast<const char*>(buckets.data()), buckets.size() * sizeof(Bucket));
+
+      if (!out.good())
+         throw std::runtime_error("could not write snapshot '" + path + "'");
+   }
+
+   /**
+    * Snapshot image mapped into memory, see write_snapshot()
+    */
+   struct Snapshot {
+      MappedFile file;
+      SnapshotHeader header;
+
+      /**
+       * Maps and validates a snapshot
+       *
+       * @param path snapshot file
+       * @param type_name must match the type_name the snapshot was written with
+       * @param bucket_byte_size must match the snapshot's bucket size
+       */
+      Snapshot(const std::string& path, const std::string& type_name, const size_t& bucket_byte_size)
+         : file(path) {
+         if (file.size() < sizeof(SnapshotHeader))
+            throw std::runtime_error("'" + path + "' is not a hashtable snapshot");
+         std::memcpy(&header, file.data(), sizeof(header));
+
+         if (header.magic != SnapshotHeader::Magic)
+            throw std::runtime_error("'" + path + "' is not a hashtable snapshot");
+         if (header.version != SnapshotHeader::Version)
+            throw std::runtime_error("snapshot '" + path + "' has unsupported version " +
+                                     std::to_string(header.version));
+         if (header.type_fingerprint != SnapshotHeader::fingerprint(type_name) ||
+             header.bucket_byte_size != bucket_byte_size)
+            throw std::runtime_error("snapshot '" + path + "' was not written by " + type_name);
+         if (sizeof(SnapshotHeader) + header.state_byte_size > header.bucket_offset ||
+             header.bucket_offset + header.bucket_count * header.bucket_byte_size > file.size())
+            throw std::runtime_error("snapshot '" + path + "' is truncated");
+      }
+
+      /**
+       * @return stream over the serialized hash state
+       */
+      std::istringstream state() const {
+         return std::istringstream(
+            std::string(reinterpret_cast<const char*>(file.data() + sizeof(SnapshotHeader)), header.state_byte_size));
+      }
+
+      /**
+       * Moves the mapping into a bucket storage. Snapshot is unusable afterwards
+       *
+       * @param bucket_count amount of buckets the table expects for header.capacity
+       */
+      template<class Bucket>
+      BucketStorage<Bucket> buckets(const size_t& bucket_count) {
+         if (header.bucket_count != bucket_count)
+            throw std::runtime_error("snapshot bucket count " + std::to_string(header.bucket_count) +
+                                     " does not match capacity " + std::to_string(header.capacity));
+         return BucketStorage<Bucket>(std::move(file), header.bucket_offset, header.bucket_count);
+      }
+   };
+} // namespace Hashtable
@@ -0,0 +1,255 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <convenience.hpp>
+
+#include "payload.hpp"
+#include "probing.hpp"
+
+namespace Hashtable {
+   /**
+    * Linear probing hashtable for variable length byte string keys (URLs, emails, ...).
+    *
+    * Keys of at most InlineBytes bytes are stored directly in their slot. Longer
+    * keys are appended to a key arena and slots only store their arena offset.
+    * Every slot additionally carries a 16-bit hash tag, i.e., probing only
+    * compares (and for long keys dereferences) keys whose tag and length match.
+    *
+    * @tparam Payload payload type or void for sets
+    * @tparam HashFn byte stream hash function, e.g., XXHash3<std::string_view>
+    * @tparam ReductionFn reducer mapping hash values to slot indices
+    * @tparam InlineBytes amount of key bytes stored inline. Must be at least 8
+    *    to fit an arena offset
+    */
+   template<class Payload, class HashFn, class ReductionFn, size_t InlineBytes = 26>
+   struct StringProbing {
+      static_assert(InlineBytes >= sizeof(std::uint64_t), "inline key storage must be able to hold an arena offset");
+
+     public:
+      using KeyType = std::string_view;
+      using PayloadType = Payload;
+
+     private:
+      using Tag = std::uint16_t;
+      static constexpr Tag Empty = 0;
+
+      const HashFn hashfn;
+      const ReductionFn reductionfn;
+      const LinearProbingFunc probingfn;
+      const size_t capacity;
+
+     public:
+      explicit StringProbing(const size_t& capacity, const HashFn hashfn = HashFn())
+         : hashfn(hashfn), reductionfn(ReductionFn(directory_address_count(capacity))),
+           probingfn(LinearProbingFunc(directory_address_count(capacity))), capacity(capacity),
+           slots(directory_address_count(capacity)) {}
+
+      StringProbing(StringProbing&&) = default;
+
+      /**
+       * Inserts a key, value/payload pair into the hashtable. Key bytes are copied
+       *
+       * Note: Will throw a runtime error iff all slots are full.
+       *
+       * @param key
+       * @param payload
+       * @return whether or not the key, payload pair was inserted. Insertion will
+       *    fail iff the same key already exists
+       */
+      bool insert(const std::string_view& key, const StoredPayload<Payload>& payload) {
+         const auto h = hashfn(key);
+         const auto t = tag(h);
+         const auto orig_slot_index = reductionfn(h);
+         auto slot_index = orig_slot_index;
+         size_t probing_step = 0;
+
+         for (;;) {
+            auto& slot = slots[slot_index];
+            if (slot.tag == Empty) {
+               slot.tag = t;
+               slot.length = static_cast<std::uint32_t>(key.size());
+               if (key.size() <= InlineBytes) {
+                  std::memcpy(slot.bytes, key.data(), key.size());
+               } else {
+                  const std::uint64_t offset = arena.size();
+                  arena.insert(arena.end(), key.begin(), key.end());
+                  std::memcpy(slot.bytes, &offset, sizeof(offset));
+               }
+               slot.payload = payload;
+               return true;
+            }
+
+            if (matches(slot, t, key)) {
+               // key already exists
+               return false;
+            }
+
+            // Slot is full, choose a new slot index based on probing function
+            slot_index = probingfn(orig_slot_index, ++probing_step);
+            if (unlikely(slot_index == orig_slot_index))
+               throw std::runtime_error("Building " + this->name() + " failed: all slots are full");
+         }
+      }
+
+      /**
+       * Inserts a key into the set (Payload = void)
+       *
+       * @param key
+       * @return whether or not the key was inserted
+       */
+      bool insert(const std::string_view& key)
+         requires std::is_void_v<Payload>
+      {
+         return insert(key, NoPayload());
+      }
+
+      /**
+       * Retrieves the associated payload/value for a given key.
+       *
+       * @param key
+       * @return the payload or std::nullopt if key was not found in the Hashtable. Sets
+       *    (Payload = void) return whether key was found instead
+       */
+      LookupResult<Payload> lookup(const std::string_view& key) const {
+         const auto h = hashfn(key);
+         const auto t = tag(h);
+         const auto orig_slot_index = reductionfn(h);
+         auto slot_index = orig_slot_index;
+         size_t probing_step = 0;
+
+         for (;;) {
+            const auto& slot = slots[slot_index];
+            if (slot.tag == Empty)
+               return not_found<Payload>();
+
+            if (matches(slot, t, key))
+               return found<Payload>(slot.payload);
+
+            // Slot is full, choose a new slot index based on probing function
+            slot_index = probingfn(orig_slot_index, ++probing_step);
+            if (unlikely(slot_index == orig_slot_index))
+               return not_found<Payload>();
+         }
+      }
+
+      template<class Key>
+      std::map<std::string, std::string> lookup_statistics(const std::vector<Key>& dataset) const {
+         size_t max_psl = 0, total_psl = 0, tag_collisions = 0;
+
+         for (const auto& k : dataset) {
+            const std::string_view key(k);
+            const auto h = hashfn(key);
+            const auto t = tag(h);
+            const auto orig_slot_index = reductionfn(h);
+            auto slot_index = orig_slot_index;
+            size_t probing_step = 0;
+
+            for (;;) {
+               const auto& slot = slots[slot_index];
+               if (slot.tag == Empty || matches(slot, t, key))
+                  break;
+
+               // count comparisons that the tag did not prevent
+               tag_collisions += slot.tag == t && slot.length == key.size() ? 1 : 0;
+
+               slot_index = probingfn(orig_slot_index, ++probing_step);
+               if (unlikely(slot_index == orig_slot_index))
+                  break;
+            }
+
+            max_psl = std::max(max_psl, probing_step);
+            total_psl += probing_step;
+         }
+
+         size_t inline_keys = 0, occupied_slots = 0;
+         for (const auto& slot : slots) {
+            occupied_slots += slot.tag != Empty ? 1 : 0;
+            inline_keys += slot.tag != Empty && slot.length <= InlineBytes ? 1 : 0;
+         }
+
+         return {{"max_psl", std::to_string(max_psl)},
+                 {"total_psl", std::to_string(total_psl)},
+                 {"tag_collisions", std::to_string(tag_collisions)},
+                 {"inline_keys", std::to_string(inline_keys)},
+                 {"arena_keys", std::to_string(occupied_slots - inline_keys)},
+                 {"arena_bytes", std::to_string(arena.size())}};
+      }
+
+      /**
+       * @return bytes occupied by slots and the key arena
+       */
+      size_t byte_size() const {
+         return slots.size() * sizeof(Slot) + arena.size();
+      }
+
+      static constexpr forceinline size_t slot_byte_size() {
+         return sizeof(Slot);
+      }
+
+      static forceinline std::string name() {
+         return "string_linear_probing_inline" + std::to_string(InlineBytes);
+      }
+
+      static forceinline std::string hash_name() {
+         return HashFn::name();
+      }
+
+      static forceinline std::string reducer_name() {
+         return ReductionFn::name();
+      }
+
+      static constexpr forceinline size_t bucket_size() {
+         return 1;
+      }
+
+      static constexpr forceinline size_t directory_address_count(const size_t& capacity) {
+         return capacity;
+      }
+
+      void clear() {
+         for (auto& slot : slots)
+            slot.tag = Empty;
+         arena.clear();
+      }
+
+     protected:
+      struct Slot {
+         /// Empty marks empty slots, otherwise 16 hash bits (never Empty)
+         Tag tag = Empty;
+         std::uint32_t length = 0;
+         /// key bytes iff length <= InlineBytes, arena offset otherwise
+         char bytes[InlineBytes];
+         [[no_unique_address]] StoredPayload<Payload> payload;
+      } packed;
+
+      std::vector<Slot> slots;
+      std::vector<char> arena;
+
+      static forceinline Tag tag(const HASH_64& hash) {
+         // Reducers consume either the lower (modulo) or the upper (fastrange) bits
+         // of the hash. Rehash via fibonacci hashing to not correlate tag & slot index
+         const auto t = static_cast<Tag>((hash * 0x9E3779B97F4A7C15LLU) >> 48);
+         return t == Empty ? 1 : t;
+      }
+
+      forceinline bool matches(const Slot& slot, const Tag& t, const std::string_view& key) const {
+         if (slot.tag != t || slot.length != key.size())
+            return false;
+
+         if (key.size() <= InlineBytes)
+            return std::memcmp(slot.bytes, key.data(), key.size()) == 0;
+
+         std::uint64_t offset;
+         std::memcpy(&offset, slot.bytes, sizeof(offset));
+         return std::memcmp(arena.data() + offset, key.data(), key.size()) == 0;
+      }
+   };
+} // namespace Hashtable
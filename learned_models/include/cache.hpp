@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <convenience.hpp>
+
+namespace learned {
+   /**
+    * Flat, versioned on disk image of a trained learned hash function:
+    *
+    *    [ModelFileHeader][serialized model]
+    *
+    * The model part is written by the hash function's serialize() hook and
+    * read back by its static deserialize() counterpart (same host
+    * architecture assumed)
+    */
+   struct ModelFileHeader {
+      static constexpr std::uint64_t Magic = 0x4C444F4D444E524CLLU; // "LRNDMODL"
+      static constexpr std::uint32_t Version = 1;
+
+      std::uint64_t magic = Magic;
+      std::uint32_t version = Version;
+      std::uint32_t key_byte_size = 0;
+      /// fingerprint of the hash function's name, which encodes its template parameters
+      std::uint64_t type_fingerprint = 0;
+      /// see ModelCache::fingerprint()
+      std::uint64_t dataset_fingerprint = 0;
+      std::uint64_t full_size = 0;
+      double sample_rate = 0;
+      std::uint64_t model_byte_size = 0;
+
+      /**
+       * 64-bit FNV-1a of a (type) name. Unlike std::hash this is stable across
+       * compilers and standard libraries
+       */
+      static std::uint64_t fingerprint(const std::string& name) {
+         std::uint64_t h = 0xCBF29CE484222325LLU;
+         for (const auto& c : name) {
+            h ^= static_cast<std::uint8_t>(c);
+            h *= 0x100000001B3LLU;
+         }
+         return h;
+      }
+
+      bool matches(const ModelFileHeader& other) const {
+         return magic == other.magic && version == other.version && key_byte_size == other.key_byte_size &&
+            type_fingerprint == other.type_fingerprint && dataset_fingerprint == other.dataset_fingerprint &&
+            full_size == other.full_size && sample_rate == other.sample_rate;
+      }
+   } packed;
+
+   /**
+    * Directory of trained learned hash functions (RMIHash, RMI,
+    * RadixSplineHash, PGMHash), keyed by dataset fingerprint, sample rate,
+    * output range and hash function type. Loading a cached model skips
+    * sampling, sorting and training entirely.
+    *
+    * Models are read into their own storage, i.e., loading copies the model
+    * once. This is not free for large models, e.g., an RMIHash with 10^7
+    * second level models takes 160 MB, but still far cheaper than training.
+    * Models are only valid for the host architecture they were saved on
+    */
+   struct ModelCache {
+      explicit ModelCache(const std::filesystem::path& directory) : directory(directory) {
+         std::filesystem::create_directories(directory);
+      }
+
+      /**
+       * Fingerprints a dataset by its size and a strided subset of (at most
+       * 2^16) keys, i.e., in O(1) independent of dataset size. A collision
+       * only costs model quality, never correctness: any model is a valid hash
+       * function for any dataset
+       */
+      template<class Data>
+      static std::uint64_t fingerprint(const std::vector<Data>& dataset) {
+         constexpr size_t MaxKeys = 1 << 16;
+         const size_t stride = std::max(dataset.size() / MaxKeys, static_cast<size_t>(1));
+
+         std::uint64_t h = dataset.size();
+         for (size_t i = 0; i < dataset.size(); i += stride) {
+            h = (h ^ static_cast<std::uint64_t>(dataset[i])) * 0x9E3779B97F4A7C15LLU;
+            h ^= h >> 32;
+         }
+         return h;
+      }
+
+      /**
+       * Loads a model trained on dataset with the given sample rate and output range
+       *
+       * @return cached model or std::nullopt if there is none (or its file is truncated)
+       */
+      template<class Hashfn, class Data>
+      std::optional<Hashfn> load(const std::vector<Data>& dataset, const double sample_rate,
+                                 const size_t full_size) const {
+         const auto expected = header<Hashfn, Data>(dataset, sample_rate, full_size);
+         std::ifstream in(path<Hashfn>(expected), std::ios::binary);
+         if (!in.is_open())
+            return std::nullopt;
+
+         ModelFileHeader actual;
+         if (!in.read(reinterpret_cast<char*>(&actual), sizeof(actual)) || !actual.matches(expected))
+            return std::nullopt;
+
+         // Reject truncated (or otherwise corrupted) files before deserializing
+         std::error_code ec;
+         const auto file_size = std::filesystem::file_size(path<Hashfn>(expected), ec);
+         if (ec || file_size != sizeof(actual) + actual.model_byte_size)
+            return std::nullopt;
+
+         return std::optional<Hashfn>(Hashfn::deserialize(in));
+      }
+
+      /**
+       * Saves a model trained on dataset with the given sample rate and output
+       * range. The file is written to a temporary and renamed, i.e., concurrent
+       * readers never observe a partially written model
+       */
+      template<class Hashfn, class Data>
+      void save(const Hashfn& hashfn, const std::vector<Data>& dataset, const double sample_rate,
+                const size_t full_size) const {
+         auto header = this->header<Hashfn, Data>(dataset, sample_rate, full_size);
+         std::ostringstream model;
+         hashfn.serialize(model);
+         const auto bytes = model.str();
+         header.model_byte_size = bytes.size();
+
+         const auto target = path<Hashfn>(header);
+         const auto tmp =
+            target.string() + ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+         {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if (!out.is_open())
+               throw std::runtime_error("could not open '" + tmp + "' for writing");
+
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(bytes.data(), bytes.size());
+            if (!out.good())
+               throw std::runtime_error("could not write model '" + tmp + "'");
+         }
+         std::filesystem::rename(tmp, target);
+      }
+
+     private:
+      std::filesystem::path directory;
+
+      template<class Hashfn, class Data>
+      static ModelFileHeader header(const std::vector<Data>& dataset, const double sample_rate,
+                                    const size_t full_size) {
+         ModelFileHeader header;
+         header.key_byte_size = sizeof(Data);
+         header.type_fingerprint = ModelFileHeader::fingerprint(Hashfn::name());
+         header.dataset_fingerprint = fingerprint(dataset);
+         header.full_size = full_size;
+         header.sample_rate = sample_rate;
+         return header;
+      }
+
+      template<class Hashfn>
+      std::filesystem::path path(const ModelFileHeader& header) const {
+         // One file per (type, dataset, sample rate, output range)
+         const auto key = ModelFileHeader::fingerprint(std::to_string(header.key_byte_size) + "_" +
+                                                       std::to_string(header.dataset_fingerprint) + "_" +
+                                                       std::to_string(header.sample_rate) + "_" +
+                                                       std::to_string(header.full_size));
+         char hex[17];
+         std::snprintf(hex, sizeof(hex), "%016lx", static_cast<unsigned long>(key));
+         return directory / (Hashfn::name() + "_" + hex + ".model");
+      }
+   };
+} // namespace learned
@@ -0,0 +1,547 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <convenience.hpp>
+
+namespace learned {
+   /**
+    * Learned hash function (e.g., RMIHash or PGMHash) that is retrained
+    * incrementally while keys are inserted, instead of fully retraining it
+    * once inserted keys drift away from the sample it was trained on.
+    *
+    * The output range [0, full_size] is split into SegmentCount segments. The
+    * table feeds back each insert's slot and chain length (probe sequence
+    * length, bucket chain length, ...), see feedback(). A background thread
+    * tracks inserts and overflows (chain length > 1) per segment and retrains
+    * segments that overflow considerably more often than the table on
+    * average: it fits a patch model, an equal-depth linear spline over a
+    * Bernoulli sample of the inserted keys, to a window of segments around the
+    * overflowing one. Windows are widened until their share of the output
+    * range matches their share of inserted keys, i.e., keys that drifted into
+    * a region are spread over (just) enough neighbouring slots.
+    *
+    * Keys are routed by their base model output: keys of unpatched segments
+    * keep their base output, keys of patched segments are hashed by their
+    * window's patch model, whose output stays within the window's slots. The
+    * base model and all other segments are never touched. Patches are
+    * published by swapping each segment's patch pointer atomically, i.e.,
+    * lookups never block and observe either the old or the new model of
+    * their key's segment. Retrained windows change the slots of their keys,
+    * which the table has to rehash, see take_retrained()
+    *
+    * Replaced patches are only freed by reclaim() since concurrent lookups
+    * might still use them. Destruction discards feedback that was not handed
+    * off by sync(), i.e., its retrains could not be observed anyway
+    *
+    * @tparam Key key type
+    * @tparam Hashfn learned hash function, constructed as Hashfn(sample_begin, sample_end, full_size)
+    * @tparam SegmentCount granularity of overflow tracking and retraining
+    */
+   template<class Key, class Hashfn, size_t SegmentCount = 1 << 12>
+   struct IncrementalHash {
+      static_assert(SegmentCount > 0, "at least one segment is required");
+
+      /// Slot range [begin, end) whose keys have to be rehashed after a retrain
+      struct SlotRange {
+         size_t begin, end;
+      };
+
+      struct Statistics {
+         size_t feedback_count = 0;
+         size_t overflow_count = 0;
+         size_t retrain_count = 0;
+         size_t retrain_nanoseconds = 0;
+         size_t patched_segments = 0;
+      };
+
+     private:
+      /// feedback is handed to the background thread in batches of this many inserts, which stay cached
+      static constexpr size_t FeedbackBatchSize = 1 << 10;
+      /// segments are retrained at most once per this many inserts, see should_retrain()
+      static constexpr size_t MinRetrainInserts = 1 << 10;
+      /// segments are retrained if they fill this share of the whole table's non overflowing inserts with overflows
+      static constexpr double MaxOverflowExcess = 0.25;
+      /// windows are widened until they receive at most this much more keys per slot than the whole table
+      static constexpr double MaxDensitySkew = 1.5;
+      /// spline knots per segment of a patch model's window
+      static constexpr size_t KnotsPerSegment = 32;
+      /// each knot's rank is estimated from at least this many sampled keys, i.e., knots are not too noisy
+      static constexpr size_t MinSamplesPerKnot = 16;
+      /// windows are only patched once their sample spans at least two knots, see retrain()
+      static constexpr size_t MinPatchSamples = 2 * MinSamplesPerKnot;
+      /// patch models' radix tables have at most 2^MaxRadixBits entries
+      static constexpr size_t MaxRadixBits = 20;
+
+      /**
+       * Patch model of a window of segments: equal-depth linear spline, mapping
+       * keys to the window's slots. Like RadixSpline, a radix table on the
+       * knots' key prefixes narrows the knot search to a few knots. Keys
+       * outside the knots' key range are extrapolated along the first (last)
+       * spline segment up to the window's first (last) slot
+       */
+      struct Patch {
+         struct Knot {
+            Key key;
+            /// slot of the knot and slope of the spline segment it starts
+            double position, slope;
+         };
+
+         size_t segment_begin, segment_end;
+         /// the window's first and last slot
+         double slot_min, slot_max;
+         /// at least two knots, the last one's slope extends the last spline segment
+         std::vector<Knot> knots;
+         /// radix_table[p] is the index of the first knot whose prefix is at least p
+         std::vector<std::uint32_t> radix_table;
+         size_t shift;
+
+         forceinline size_t operator()(const Key& key) const {
+            if (unlikely(key < knots.front().key)) {
+               const auto& front = knots.front();
+               return static_cast<size_t>(
+                  std::max(front.position - static_cast<double>(front.key - key) * front.slope, slot_min));
+            }
+            if (unlikely(key >= knots.back().key)) {
+               const auto& back = knots.back();
+               return static_cast<size_t>(
+                  std::min(back.position + static_cast<double>(key - back.key) * back.slope, slot_max));
+            }
+
+            // knots[radix_table[prefix] - 1] is the last knot with a smaller prefix, i.e., less than key. Usually
+            // at most one knot shares key's prefix, hence the branchless first step. The scan always terminates
+            // since key is less than the last knot
+            const auto prefix = static_cast<size_t>((key - knots.front().key) >> shift);
+            size_t i = radix_table[prefix];
+            i += knots[i].key <= key;
+            while (unlikely(knots[i].key <= key))
+               i++;
+
+            const auto& knot = knots[i - 1];
+            const auto key_diff = static_cast<double>(key - knot.key);
+            return static_cast<size_t>(std::min(knot.position + key_diff * knot.slope, slot_max));
+         }
+
+         size_t byte_size() const {
+            return sizeof(*this) + knots.size() * sizeof(Knot) + radix_table.size() * sizeof(std::uint32_t);
+         }
+      };
+
+      struct Feedback {
+         Key key;
+         size_t slot, chain_length;
+      };
+
+      /// Per segment feedback, only accessed by the background thread
+      struct SegmentStatistics {
+         size_t inserts = 0;
+         /// inserts and overflows since the segment was last retrained
+         size_t pending = 0, overflows = 0;
+         /// inserts when the segment was last retrained
+         size_t trained = 0;
+         /// Bernoulli sample of the inserted keys
+         std::vector<Key> sample;
+      };
+
+      Hashfn base;
+      const size_t full_size;
+      const double segment_scale;
+
+      std::vector<std::atomic<const Patch*>> patches;
+
+      /// Feedback not yet handed to the background thread. Only accessed by the feeding thread
+      std::vector<Feedback> pending;
+
+      /// Feedback batches and retrained slot ranges, shared with the background thread
+      std::mutex mutex;
+      std::condition_variable batch_available, batch_processed;
+      std::deque<std::vector<Feedback>> batches;
+      std::vector<SlotRange> retrained;
+      /// patches that are (not) referenced by a segment
+      std::vector<std::unique_ptr<const Patch>> live_patches, retired_patches;
+      Statistics stats;
+      bool processing = false, stopped = false;
+
+      /// Background thread state
+      std::vector<SegmentStatistics> segments;
+      size_t total_inserts = 0, total_overflows = 0;
+      /// Bernoulli sample of inserted keys, drawn like Sampling::bernoulli(): skip() keys are skipped
+      std::mt19937_64 rng{0x9E3779B97F4A7C15LLU};
+      const double sample_rate;
+      std::geometric_distribution<size_t> sample_gap;
+      size_t next_sample;
+
+      std::thread retrainer;
+
+     public:
+      /**
+       * Trains the base model on an already sorted (!) sample and starts the background thread
+       *
+       * @param full_size operator() will extrapolate to [0, full_size]
+       * @param sample_rate chance of each inserted key to be sampled for retraining
+       */
+      template<class RandomIt>
+      IncrementalHash(const RandomIt& sample_begin, const RandomIt& sample_end, const size_t full_size,
+                      const double sample_rate = 0.01)
+         : base(sample_begin, sample_end, full_size), full_size(full_size),
+           segment_scale(static_cast<double>(SegmentCount) / (static_cast<double>(full_size) + 1)),
+           patches(SegmentCount), segments(SegmentCount), sample_rate(sample_rate),
+           // geometric distributions require p \in (0, 1), other rates are handled by skip()
+           sample_gap(sample_rate > 0.0 && sample_rate < 1.0 ? sample_rate : 0.5), next_sample(skip()),
+           retrainer([this] { run(); }) {
+         pending.reserve(FeedbackBatchSize);
+      }
+
+      IncrementalHash(const IncrementalHash&) = delete;
+      IncrementalHash& operator=(const IncrementalHash&) = delete;
+
+      ~IncrementalHash() {
+         {
+            std::unique_lock<std::mutex> lock(mutex);
+            stopped = true;
+         }
+         batch_available.notify_all();
+         retrainer.join();
+      }
+
+      static std::string name() {
+         return "incremental_" + Hashfn::name();
+      }
+
+      size_t model_count() {
+         size_t count = base.model_count();
+         for_each_patch([&](const Patch& patch) { count += patch.knots.size(); });
+         return count;
+      }
+
+      size_t byte_size() {
+         size_t bytes = sizeof(*this) - sizeof(base) + base.byte_size();
+         for_each_patch([&](const Patch& patch) { bytes += patch.byte_size(); });
+         return bytes;
+      }
+
+      /**
+       * Compute hash value for key
+       *
+       * @tparam Result result data type. Defaults to size_t
+       * @param key
+       */
+      template<class Result = size_t>
+      forceinline Result operator()(const Key& key) const {
+         return static_cast<Result>(route(key, std::min(static_cast<size_t>(base(key)), full_size)));
+      }
+
+      /**
+       * Computes hash values for n keys at once using the base model's batched
+       * operator(), only keys of patched segments are rehashed one by one
+       */
+      forceinline void operator()(const Key* keys, size_t* out, const size_t& n) const
+         requires requires(const Hashfn& h) { h(keys, out, n); }
+      {
+         base(keys, out, n);
+         for (size_t i = 0; i < n; i++)
+            out[i] = route(keys[i], std::min(out[i], full_size));
+      }
+
+      /**
+       * Reports an insert, i.e., must be called by the (single) inserting
+       * thread for every inserted key
+       *
+       * @param slot operator()'s result for key
+       * @param chain_length amount of keys that hash to key's slot (or bucket)
+       *    including key, i.e., 1 if key did not collide
+       */
+      void feedback(const Key& key, const size_t slot, const size_t chain_length) {
+         pending.push_back({key, slot, chain_length});
+         if (unlikely(pending.size() >= FeedbackBatchSize))
+            hand_off();
+      }
+
+      /**
+       * Hands all feedback to the background thread and waits until it
+       * retrained every segment that required it
+       */
+      void sync() {
+         hand_off();
+         std::unique_lock<std::mutex> lock(mutex);
+         batch_processed.wait(lock, [&] { return batches.empty() && !processing; });
+      }
+
+      /**
+       * Slot ranges retrained since the last call. Keys hashed into these
+       * ranges before have to be rehashed by the table
+       */
+      std::vector<SlotRange> take_retrained() {
+         std::unique_lock<std::mutex> lock(mutex);
+         return std::exchange(retrained, {});
+      }
+
+      Statistics statistics() {
+         std::unique_lock<std::mutex> lock(mutex);
+         return stats;
+      }
+
+      /**
+       * Frees patches replaced by retrains so far. Must not run concurrently
+       * with operator(), e.g., call it while the table rehashes the ranges of
+       * take_retrained()
+       */
+      void reclaim() {
+         std::unique_lock<std::mutex> lock(mutex);
+         retired_patches.clear();
+      }
+
+     private:
+      forceinline size_t segment(const size_t slot) const {
+         return std::min(static_cast<size_t>(static_cast<double>(slot) * segment_scale), SegmentCount - 1);
+      }
+
+      /// first slot whose segment is at least s, i.e., segment s spans [first_slot(s), first_slot(s + 1))
+      size_t first_slot(const size_t s) const {
+         if (s >= SegmentCount)
+            return full_size + 1;
+
+         auto slot = static_cast<size_t>(static_cast<double>(s) / segment_scale);
+         while (slot > 0 && segment(slot - 1) >= s)
+            slot--;
+         while (segment(slot) < s)
+            slot++;
+         return slot;
+      }
+
+      forceinline size_t route(const Key& key, const size_t slot) const {
+         const auto patch = patches[segment(slot)].load(std::memory_order_acquire);
+         return likely(patch == nullptr) ? slot : (*patch)(key);
+      }
+
+      template<class Fn>
+      void for_each_patch(const Fn& fn) const {
+         const Patch* previous = nullptr;
+         for (const auto& p : patches) {
+            const auto patch = p.load(std::memory_order_acquire);
+            if (patch != nullptr && patch != previous)
+               fn(*patch);
+            previous = patch;
+         }
+      }
+
+      void hand_off() {
+         if (pending.empty())
+            return;
+
+         {
+            std::unique_lock<std::mutex> lock(mutex);
+            batches.emplace_back(std::exchange(pending, {}));
+         }
+         batch_available.notify_one();
+         pending.reserve(FeedbackBatchSize);
+      }
+
+      /// Background thread: processes feedback batches until destruction
+      void run() {
+         std::unique_lock<std::mutex> lock(mutex);
+         for (;;) {
+            batch_available.wait(lock, [&] { return stopped || !batches.empty(); });
+            if (stopped)
+               return;
+
+            auto batch = std::move(batches.front());
+            batches.pop_front();
+            processing = true;
+
+            lock.unlock();
+            process(batch);
+            lock.lock();
+
+            processing = false;
+            batch_processed.notify_all();
+         }
+      }
+
+      void process(const std::vector<Feedback>& batch) {
+         for (const auto& [key, slot, chain_length] : batch) {
+            // Patches never map keys out of their window, i.e., the slot's segment belongs to key's window
+            const auto s = segment(std::min(slot, full_size));
+            auto& stat = segments[s];
+
+            if (unlikely(next_sample-- == 0)) {
+               stat.sample.push_back(key);
+               next_sample = skip();
+            }
+
+            const bool overflow = chain_length > 1;
+            stat.inserts++;
+            stat.pending++;
+            stat.overflows += overflow;
+            total_inserts++;
+            total_overflows += overflow;
+
+            if (unlikely(should_retrain(s)))
+               retrain(s);
+         }
+
+         std::unique_lock<std::mutex> lock(mutex);
+         stats.feedback_count = total_inserts;
+         stats.overflow_count = total_overflows;
+      }
+
+      /// amount of inserted keys to skip before sampling the next one
+      size_t skip() {
+         // Like Sampling::bernoulli(), rates of 1 (0) or more (less) sample every (no) key
+         if (sample_rate >= 1.0)
+            return 0;
+         if (sample_rate <= 0.0)
+            return std::numeric_limits<size_t>::max();
+         return sample_gap(rng);
+      }
+
+      bool should_retrain(const size_t s) const {
+         const auto& stat = segments[s];
+         if (stat.pending < std::max(MinRetrainInserts, stat.trained))
+            return false;
+
+         // Overflow rates approach 1 as the table fills up, i.e., compare the share of non overflowing inserts
+         const auto overflow_rate = static_cast<double>(stat.overflows) / static_cast<double>(stat.pending);
+         const auto total_overflow_rate = static_cast<double>(total_overflows) / static_cast<double>(total_inserts);
+         return overflow_rate > total_overflow_rate + MaxOverflowExcess * (1.0 - total_overflow_rate);
+      }
+
+      /// Retrains a window of segments around s and publishes its patch model
+      void retrain(const size_t s) {
+         const auto start_time = std::chrono::steady_clock::now();
+
+         // Widen the window until it is not denser than the whole table. Windows
+         // always contain whole windows of previous patches, i.e., windows never overlap
+         size_t begin = s, end = s + 1;
+         const auto inserts = [&]() {
+            size_t count = 0;
+            for (size_t i = begin; i < end; i++)
+               count += segments[i].inserts;
+            return count;
+         };
+         const auto cover_patches = [&]() {
+            if (const auto patch = patches[begin].load(std::memory_order_relaxed))
+               begin = patch->segment_begin;
+            if (const auto patch = patches[end - 1].load(std::memory_order_relaxed))
+               end = patch->segment_end;
+         };
+         const auto max_inserts_per_segment =
+            MaxDensitySkew * static_cast<double>(total_inserts) / static_cast<double>(SegmentCount);
+
+         cover_patches();
+         while (end - begin < SegmentCount &&
+                static_cast<double>(inserts()) > max_inserts_per_segment * static_cast<double>(end - begin)) {
+            const auto width = end - begin;
+            begin -= std::min(begin, (width + 1) / 2);
+            end = std::min(end + (width + 1) / 2, SegmentCount);
+            cover_patches();
+         }
+
+         std::vector<Key> sample;
+         for (size_t i = begin; i < end; i++)
+            sample.insert(sample.end(), segments[i].sample.begin(), segments[i].sample.end());
+         std::sort(sample.begin(), sample.end());
+         sample.erase(std::unique(sample.begin(), sample.end()), sample.end());
+
+         // Too few samples for a meaningful spline, e.g., at low sample rates. Retry once more keys were inserted
+         if (sample.size() < MinPatchSamples) {
+            for (size_t i = begin; i < end; i++) {
+               segments[i].pending = 0;
+               segments[i].overflows = 0;
+            }
+            return;
+         }
+
+         // Equal-depth spline: each knot is placed at its key's rank within the window's slots
+         auto patch = std::make_unique<Patch>();
+         patch->segment_begin = begin;
+         patch->segment_end = end;
+         const auto slot_begin = static_cast<double>(first_slot(begin));
+         const auto slot_count = static_cast<double>(first_slot(end) - first_slot(begin));
+         patch->slot_min = slot_begin;
+         patch->slot_max = slot_begin + slot_count - 1;
+         const auto rank_scale = slot_count / static_cast<double>(sample.size());
+         const auto knot_count = std::min(sample.size(), KnotsPerSegment * (end - begin));
+         const auto stride = std::max(sample.size() / knot_count, MinSamplesPerKnot);
+         const auto knot = [&](const size_t i) {
+            return typename Patch::Knot{sample[i], slot_begin + (static_cast<double>(i) + 0.5) * rank_scale, 0};
+         };
+
+         // The first and last sampled key are knots, i.e., at least two since the sample spans at least two strides
+         auto& knots = patch->knots;
+         for (size_t i = 0; i < sample.size(); i += stride)
+            knots.push_back(knot(i));
+         if (knots.back().key != sample.back())
+            knots.push_back(knot(sample.size() - 1));
+
+         for (size_t i = 0; i + 1 < knots.size(); i++)
+            knots[i].slope =
+               (knots[i + 1].position - knots[i].position) / static_cast<double>(knots[i + 1].key - knots[i].key);
+         knots.back().slope = knots[knots.size() - 2].slope;
+
+         // Radix table with roughly two entries per knot
+         const Key range = knots.back().key - knots.front().key;
+         size_t range_bits = 0;
+         while (range_bits < sizeof(Key) * 8 && (range >> range_bits) > 0)
+            range_bits++;
+         size_t radix_bits = 1;
+         while (radix_bits < MaxRadixBits && (static_cast<size_t>(1) << radix_bits) < 2 * knots.size())
+            radix_bits++;
+         patch->shift = range_bits > radix_bits ? range_bits - radix_bits : 0;
+
+         patch->radix_table.assign((static_cast<size_t>(1) << radix_bits) + 2, 0);
+         for (size_t p = 0, k = 0; p < patch->radix_table.size(); p++) {
+            while (k < knots.size() && static_cast<size_t>((knots[k].key - knots.front().key) >> patch->shift) < p)
+               k++;
+            patch->radix_table[p] = static_cast<std::uint32_t>(k);
+         }
+
+         for (size_t i = begin; i < end; i++) {
+            auto& stat = segments[i];
+            stat.trained = stat.inserts;
+            stat.pending = 0;
+            stat.overflows = 0;
+         }
+
+         // Publish. The window covers whole windows of previous patches, i.e., these are no longer referenced
+         std::vector<const Patch*> replaced;
+         const auto published = patch.get();
+         for (size_t i = begin; i < end; i++)
+            if (const auto previous = patches[i].exchange(published, std::memory_order_acq_rel))
+               if (replaced.empty() || replaced.back() != previous)
+                  replaced.push_back(previous);
+
+         const auto retrain_ns = static_cast<size_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time)
+               .count());
+
+         std::unique_lock<std::mutex> lock(mutex);
+         for (const auto previous : replaced) {
+            const auto it = std::find_if(live_patches.begin(), live_patches.end(),
+                                         [&](const auto& live) { return live.get() == previous; });
+            retired_patches.push_back(std::move(*it));
+            live_patches.erase(it);
+         }
+         live_patches.push_back(std::move(patch));
+         retrained.push_back({first_slot(begin), first_slot(end)});
+         stats.retrain_count++;
+         stats.retrain_nanoseconds += retrain_ns;
+         stats.patched_segments = 0;
+         for (const auto& p : patches)
+            stats.patched_segments += p.load(std::memory_order_relaxed) != nullptr;
+      }
+   };
+} // namespace learned
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <istream>
+#include <ostream>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include <convenience.hpp>
 
@@ -15,6 +20,15 @@ struct PGMHash : public pgm::PGMIndex<T, Epsilon, EpsilonRecursive, Floating> {
   private:
    using Parent = pgm::PGMIndex<T, Epsilon, EpsilonRecursive, Floating>;
 
+   /// PGMIndex members persisted by serialize(), which has to access them directly since PGMIndex offers
+   /// no (de)serialization API. Mirrors PGMIndex's layout, see the static_assert in serialize()
+   struct PersistedParent {
+      size_t n;
+      T first_key;
+      std::vector<typename Parent::Segment> segments;
+      std::vector<size_t> levels_offsets;
+   };
+
    const T first_key;
    const size_t sample_size;
    const size_t N;
@@ -41,6 +55,63 @@ struct PGMHash : public pgm::PGMIndex<T, Epsilon, EpsilonRecursive, Floating> {
       return this->segments.size();
    }
 
+   size_t byte_size() const {
+      return sizeof(*this) - sizeof(Parent) + Parent::size_in_bytes();
+   }
+
+   /**
+    * Writes the trained index, e.g., to cache it on disk
+    */
+   void serialize(std::ostream& out) const {
+      static_assert(sizeof(Parent) == sizeof(PersistedParent) &&
+                       std::is_same_v<decltype(this->segments), decltype(PersistedParent::segments)> &&
+                       std::is_same_v<decltype(this->levels_offsets), decltype(PersistedParent::levels_offsets)>,
+                    "PGMIndex layout changed, serialize() and deserialize() would miss members");
+      static_assert(std::is_trivially_copyable_v<typename Parent::Segment>, "PGMIndex segments must be flat");
+
+      const auto write = [&](const auto& value) { out.write(reinterpret_cast<const char*>(&value), sizeof(value)); };
+      const auto write_vector = [&](const auto& vec) {
+         write(vec.size());
+         out.write(reinterpret_cast<const char*>(vec.data()), vec.size() * sizeof(vec[0]));
+      };
+
+      write(first_key);
+      write(sample_size);
+      write(N);
+      write(this->n);
+      write(Parent::first_key);
+      write_vector(this->segments);
+      write_vector(this->levels_offsets);
+   }
+
+   static PGMHash deserialize(std::istream& in) {
+      const auto read = [&](auto& value) { in.read(reinterpret_cast<char*>(&value), sizeof(value)); };
+      const auto read_vector = [&](auto& vec) {
+         size_t size = 0;
+         read(size);
+         if (!in)
+            return;
+         vec.resize(size);
+         in.read(reinterpret_cast<char*>(vec.data()), vec.size() * sizeof(vec[0]));
+      };
+
+      T first_key;
+      size_t sample_size, N;
+      read(first_key);
+      read(sample_size);
+      read(N);
+
+      PGMHash hashfn(first_key, sample_size, N);
+      read(hashfn.n);
+      read(hashfn.Parent::first_key);
+      read_vector(hashfn.segments);
+      read_vector(hashfn.levels_offsets);
+      if (!in)
+         throw std::runtime_error("serialized " + name() + " is truncated");
+
+      return hashfn;
+   }
+
    /**
     * Human readable name useful, e.g., to log measured results
     * @return
@@ -69,12 +140,9 @@ struct PGMHash : public pgm::PGMIndex<T, Epsilon, EpsilonRecursive, Floating> {
     */
    template<typename Result = size_t, typename Precision = double>
    forceinline Result operator()(const T& key) const {
-      // Otherwise pgm will EXC_BAD_ACCESS
-      if (unlikely(key == std::numeric_limits<HASH_64>::max())) {
-         return N;
-      }
-
-      auto k = std::max(first_key, key);
+      // Clamp instead of branching: pgm will EXC_BAD_ACCESS on the max key (its internal sentinel),
+      // which however is a valid key for tables using SlotOccupancy::Bitmap
+      auto k = std::min(std::max(first_key, key), std::numeric_limits<T>::max() - 1);
       auto it = this->segment_for_key(k);
 
       // compute estimated pos (contrary to standard PGM, don't just throw slope precision away)
@@ -89,4 +157,8 @@ struct PGMHash : public pgm::PGMIndex<T, Epsilon, EpsilonRecursive, Floating> {
 
       return global_pos;
    }
+
+  private:
+   PGMHash(const T first_key, const size_t sample_size, const size_t N)
+      : Parent(), first_key(first_key), sample_size(sample_size), N(N) {}
 };
@@ -2,11 +2,20 @@
 
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <istream>
 #include <iterator>
 #include <limits>
+#include <ostream>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include <convenience.hpp>
@@ -14,16 +23,17 @@
 namespace rmi {
    template<class X, class Y>
    struct DatapointImpl {
-      X x;
-      Y y;
+      X x = 0;
+      Y y = 0;
 
+      DatapointImpl() = default;
       DatapointImpl(const X x, const Y y) : x(x), y(y) {}
    };
 
    template<class Key, class Precision>
    struct LinearImpl {
      protected:
-      Precision slope = 0, intercept = 0;
+      Precision slope_ = 0, intercept_ = 0;
 
      private:
       using Datapoint = DatapointImpl<Key, Precision>;
@@ -42,7 +52,7 @@ namespace rmi {
       }
 
      public:
-      explicit LinearImpl(Precision slope = 0, Precision intercept = 0) : slope(slope), intercept(intercept) {}
+      explicit LinearImpl(Precision slope = 0, Precision intercept = 0) : slope_(slope), intercept_(intercept) {}
 
       /**
        * Performs trivial linear regression on the datapoints (i.e., computing max->min spline)
@@ -51,10 +61,47 @@ namespace rmi {
        * @param output_range outputs will be in range [0, output_range] 
        */
       explicit LinearImpl(const std::vector<Datapoint>& datapoints)
-         : slope(compute_slope(datapoints.front(), datapoints.back())),
-           intercept(compute_intercept(datapoints.front(), datapoints.back())) {
-         assert(slope != NAN);
-         assert(intercept != NAN);
+         : slope_(compute_slope(datapoints.front(), datapoints.back())),
+           intercept_(compute_intercept(datapoints.front(), datapoints.back())) {
+         assert(slope_ != NAN);
+         assert(intercept_ != NAN);
+      }
+
+      /**
+       * Streaming trainer, i.e., fits the same model as LinearImpl(datapoints) on
+       * *sorted* datapoints that are added one at a time
+       */
+      struct Trainer {
+         void add(const Datapoint& p) {
+            if (count++ == 0)
+               first = p;
+            last = p;
+         }
+
+         size_t size() const {
+            return count;
+         }
+
+         LinearImpl model() const {
+            assert(count > 0);
+            return LinearImpl(compute_slope(first, last), compute_intercept(first, last));
+         }
+
+        private:
+         Datapoint first, last;
+         size_t count = 0;
+      };
+
+      static std::string name() {
+         return "linear_spline";
+      }
+
+      forceinline Precision slope() const {
+         return slope_;
+      }
+
+      forceinline Precision intercept() const {
+         return intercept_;
       }
 
       /**
@@ -65,18 +112,310 @@ namespace rmi {
        */
       forceinline size_t operator()(const Key& k,
                                     const Precision& max_value = std::numeric_limits<Precision>::max()) const {
-         // (slope * k + intercept) \in [0, 1] by construction
-         const auto pred = (max_value + 1) * (slope * k + intercept);
+         // (slope * k + intercept) \in [0, 1] by construction. Fused iff the build targets FMA, i.e., rounds
+         // exactly like Batch::fmadd_f64() in RMIHash's batched inference
+#ifdef __FMA__
+         const auto pred = (max_value + 1) * std::fma(slope_, static_cast<Precision>(k), intercept_);
+#else
+         const auto pred = (max_value + 1) * (slope_ * k + intercept_);
+#endif
 
-         // clamp value (very few entries should be smaller/larger than acceptable. Therefore this optimization)
-         if (unlikely(pred < 0))
-            return 0;
-         if (unlikely(pred > max_value))
-            return max_value;
-         return static_cast<size_t>(pred);
+         // branch-free clamp to [0, max_value] (maxsd, minsd)
+         return static_cast<size_t>(std::min(std::max(pred, Precision(0)), max_value));
+      }
+   };
+
+   /**
+    * Linear model fit with (closed form) least squares regression on all
+    * datapoints, as opposed to LinearImpl, which only considers the first and
+    * last one. Inference is identical to LinearImpl
+    */
+   template<class Key, class Precision>
+   struct LeastSquaresImpl : public LinearImpl<Key, Precision> {
+     private:
+      using Datapoint = DatapointImpl<Key, Precision>;
+
+     public:
+      explicit LeastSquaresImpl(Precision slope = 0, Precision intercept = 0)
+         : LinearImpl<Key, Precision>(slope, intercept) {}
+
+      /**
+       * Streaming trainer, accumulates running means and (co)variance
+       * (Welford) in O(1) space. x is taken relative to the first datapoint to
+       * avoid cancellation on large keys
+       */
+      struct Trainer {
+         void add(const Datapoint& p) {
+            if (count == 0)
+               first = p;
+            last = p;
+            count++;
+
+            const auto x = static_cast<Precision>(p.x - first.x);
+            const auto dx = x - mean_x;
+            mean_x += dx / static_cast<Precision>(count);
+            mean_y += (p.y - mean_y) / static_cast<Precision>(count);
+            m_xx += dx * (x - mean_x);
+            c_xy += dx * (p.y - mean_y);
+         }
+
+         size_t size() const {
+            return count;
+         }
+
+         LeastSquaresImpl model() const {
+            assert(count > 0);
+            const auto slope = fit_slope();
+            return from_relative(slope, mean_y - slope * mean_x);
+         }
+
+        protected:
+         Datapoint first, last;
+         size_t count = 0;
+         Precision mean_x = 0, mean_y = 0, m_xx = 0, c_xy = 0;
+
+         /// least squares slope, 0 if all datapoints share the same x
+         Precision fit_slope() const {
+            return m_xx > 0 ? c_xy / m_xx : 0;
+         }
+
+         /// converts a line (slope, intercept) in relative coordinates x - first.x to absolute ones
+         LeastSquaresImpl from_relative(const Precision slope, const Precision intercept) const {
+            return LeastSquaresImpl(slope, intercept - slope * static_cast<Precision>(first.x));
+         }
+      };
+
+      /**
+       * @param datapoints *sorted* datapoints to train on
+       */
+      explicit LeastSquaresImpl(const std::vector<Datapoint>& datapoints) {
+         Trainer trainer;
+         for (const auto& p : datapoints)
+            trainer.add(p);
+         *this = trainer.model();
+      }
+
+      static std::string name() {
+         return "least_squares";
       }
    };
 
+   /**
+    * Least squares fit whose predictions at the first and last datapoint are
+    * clamped to [first.y, last.y], i.e., the line passes through the clamped
+    * predictions. Adjacent models of an RMI share their boundary datapoint,
+    * hence the RMI stays monotone on the sample's key range (no overlapping
+    * output ranges) while interior points still shape the fit
+    */
+   template<class Key, class Precision>
+   struct MonotoneLeastSquaresImpl : public LinearImpl<Key, Precision> {
+     private:
+      using Datapoint = DatapointImpl<Key, Precision>;
+
+     public:
+      explicit MonotoneLeastSquaresImpl(Precision slope = 0, Precision intercept = 0)
+         : LinearImpl<Key, Precision>(slope, intercept) {}
+
+      struct Trainer : public LeastSquaresImpl<Key, Precision>::Trainer {
+         MonotoneLeastSquaresImpl model() const {
+            assert(this->count > 0);
+            const auto slope = this->fit_slope();
+            const auto intercept = this->mean_y - slope * this->mean_x;
+            const auto width = static_cast<Precision>(this->last.x - this->first.x);
+
+            const auto clamp = [&](const Precision y) {
+               return std::min(std::max(y, this->first.y), this->last.y);
+            };
+            const auto y0 = clamp(intercept);
+            const auto y1 = clamp(slope * width + intercept);
+
+            const auto monotone_slope = width > 0 ? (y1 - y0) / width : 0;
+            const auto monotone_intercept = y0 - monotone_slope * static_cast<Precision>(this->first.x);
+            return MonotoneLeastSquaresImpl(monotone_slope, monotone_intercept);
+         }
+      };
+
+      /**
+       * @param datapoints *sorted* datapoints to train on
+       */
+      explicit MonotoneLeastSquaresImpl(const std::vector<Datapoint>& datapoints) {
+         Trainer trainer;
+         for (const auto& p : datapoints)
+            trainer.add(p);
+         *this = trainer.model();
+      }
+
+      static std::string name() {
+         return "monotone_least_squares";
+      }
+   };
+
+   /**
+    * Cubic polynomial on keys normalized to [0, 1] w.r.t. the trained key
+    * range, fit with least squares. Falls back to a linear fit if there are
+    * less than 4 distinct datapoints. Cubic models are mainly useful as root
+    * (or upper layer) models of an RMI, which do not need to be monotone
+    */
+   template<class Key, class Precision>
+   struct CubicImpl {
+     private:
+      using Datapoint = DatapointImpl<Key, Precision>;
+
+      /// x is normalized as (k - offset) * scale
+      Precision offset_ = 0, scale_ = 0;
+      /// f(x) = ((a * x + b) * x + c) * x + d
+      Precision a_ = 0, b_ = 0, c_ = 0, d_ = 0;
+
+     public:
+      CubicImpl() = default;
+      CubicImpl(Precision offset, Precision scale, Precision a, Precision b, Precision c, Precision d)
+         : offset_(offset), scale_(scale), a_(a), b_(b), c_(c), d_(d) {}
+
+      /**
+       * Streaming trainer, accumulates power sums of x - first.x, which are
+       * all non-negative (no cancellation) and only normalized in model()
+       */
+      struct Trainer {
+         void add(const Datapoint& p) {
+            if (count++ == 0)
+               first = p;
+            last = p;
+
+            const auto x = static_cast<Precision>(p.x - first.x);
+            Precision pow = 1;
+            for (size_t k = 0; k < sx.size(); k++, pow *= x) {
+               sx[k] += pow;
+               if (k < sxy.size())
+                  sxy[k] += pow * p.y;
+            }
+         }
+
+         size_t size() const {
+            return count;
+         }
+
+         CubicImpl model() const {
+            assert(count > 0);
+            const auto range = static_cast<Precision>(last.x - first.x);
+            if (range == 0)
+               return CubicImpl(static_cast<Precision>(first.x), 0, 0, 0, 0, sxy[0] / sx[0]);
+
+            // Normal equations A * [d, c, b, a] = t on normalized x. A_ij = sum x^(i + j), t_i = sum x^i * y
+            std::array<std::array<Precision, 5>, 4> system;
+            const auto solve_degree = count < 4 ? 1 : 3;
+            for (int i = 0; i <= solve_degree; i++) {
+               for (int j = 0; j <= solve_degree; j++)
+                  system[i][j] = sx[i + j] / std::pow(range, i + j);
+               system[i][4] = sxy[i] / std::pow(range, i);
+            }
+
+            // Gaussian elimination with partial pivoting
+            for (int col = 0; col <= solve_degree; col++) {
+               int pivot = col;
+               for (int row = col + 1; row <= solve_degree; row++)
+                  if (std::abs(system[row][col]) > std::abs(system[pivot][col]))
+                     pivot = row;
+               std::swap(system[col], system[pivot]);
+               if (system[col][col] == 0)
+                  continue;
+
+               for (int row = col + 1; row <= solve_degree; row++) {
+                  const auto factor = system[row][col] / system[col][col];
+                  for (int k = col; k < 5; k++)
+                     system[row][k] -= factor * system[col][k];
+               }
+            }
+            std::array<Precision, 4> coeff{};
+            for (int row = solve_degree; row >= 0; row--) {
+               auto v = system[row][4];
+               for (int k = row + 1; k <= solve_degree; k++)
+                  v -= system[row][k] * coeff[k];
+               coeff[row] = system[row][row] != 0 ? v / system[row][row] : 0;
+            }
+
+            return CubicImpl(static_cast<Precision>(first.x), 1 / range, coeff[3], coeff[2], coeff[1], coeff[0]);
+         }
+
+        private:
+         Datapoint first, last;
+         size_t count = 0;
+         std::array<Precision, 7> sx{};
+         std::array<Precision, 4> sxy{};
+      };
+
+      static std::string name() {
+         return "cubic";
+      }
+
+      /**
+       * Extrapolates an index for the given key to the range [0, max_value]
+       */
+      forceinline size_t operator()(const Key& k,
+                                    const Precision& max_value = std::numeric_limits<Precision>::max()) const {
+         const auto x = (static_cast<Precision>(k) - offset_) * scale_;
+         const auto pred = (max_value + 1) * (((a_ * x + b_) * x + c_) * x + d_);
+         return static_cast<size_t>(std::min(std::max(pred, Precision(0)), max_value));
+      }
+   };
+
+   /**
+    * Radix model, i.e., predicts the most significant bits of the key's
+    * offset within the trained key range (like SOSD's radix RMI layer). Only
+    * considers the first and last datapoint's key, hence only sensible as
+    * root model. Outputs are exact for power of two output ranges
+    */
+   template<class Key, class Precision>
+   struct RadixImpl {
+     private:
+      using Datapoint = DatapointImpl<Key, Precision>;
+
+      Key min_ = 0;
+      int range_bits_ = 0;
+
+     public:
+      RadixImpl() = default;
+      RadixImpl(Key min, Key max) : min_(min), range_bits_(std::bit_width(max - min)) {}
+
+      struct Trainer {
+         void add(const Datapoint& p) {
+            if (count++ == 0)
+               first = p;
+            last = p;
+         }
+
+         size_t size() const {
+            return count;
+         }
+
+         RadixImpl model() const {
+            assert(count > 0);
+            return RadixImpl(first.x, last.x);
+         }
+
+        private:
+         Datapoint first, last;
+         size_t count = 0;
+      };
+
+      static std::string name() {
+         return "radix";
+      }
+
+      /**
+       * Extrapolates an index for the given key to the range [0, max_value]
+       */
+      forceinline size_t operator()(const Key& k,
+                                    const Precision& max_value = std::numeric_limits<Precision>::max()) const {
+         const auto max_index = static_cast<size_t>(max_value);
+         const auto shift = std::max(range_bits_ - static_cast<int>(std::bit_width(max_index)), 0);
+         const auto offset = static_cast<size_t>(k > min_ ? k - min_ : 0);
+         return std::min(shift < 64 ? offset >> shift : 0, max_index);
+      }
+   };
+
+   template<class Key, size_t SecondLevelModelCount, size_t DeltaBits, class SecondLevelModel>
+   struct QuantizedRMIHash;
+
    template<class Key,
             size_t SecondLevelModelCount,
             class RootModel = LinearImpl<Key, double>,
@@ -89,8 +428,10 @@ namespace rmi {
       /// Root model
       const RootModel root_model;
 
-      /// Second level models
-      std::vector<SecondLevelModel> second_level_models;
+      /// Second level model parameters, stored as struct of arrays such that
+      /// batched inference gathers each parameter with a single instruction.
+      /// SecondLevelModel is only instantiated for training and (scalar) inference
+      AlignedVector<Precision> slopes, intercepts;
 
       /// output range is scaled from [0, 1] to [0, full_size]
       const size_t full_size;
@@ -101,64 +442,65 @@ namespace rmi {
        * @tparam RandomIt
        * @param sample_begin
        * @param sample_end
-       * @param full_size operator() will extrapolate to [0, full_size]
-       * @param models_per_layer
-       * @param sample_size
+       * @param full_size operator() will extrapolate to [0, full_size]. Batched inference requires full_size < 2^52
+       * @param thread_count amount of threads that train the second level. Defaults to 1, i.e., the calling thread
        */
       template<class RandomIt>
-      RMIHash(const RandomIt& sample_begin, const RandomIt& sample_end, const size_t full_size)
-         : root_model(RootModel({Datapoint(*sample_begin, 0), Datapoint(*(sample_end - 1), 1)})), full_size(full_size),
-           second_level_models(SecondLevelModelCount) {
-         // Assign each sample point into a training bucket according to root model
-         std::vector<std::vector<Datapoint>> training_buckets(SecondLevelModelCount);
-         const auto sample_size = std::distance(sample_begin, sample_end);
-
-         for (auto [it, i] = std::tuple{sample_begin, 0}; it < sample_end; it++, i++) {
-            // Predict second level model using root model and put
-            // sample datapoint into corresponding training bucket
-            const auto key = *it;
-            const auto second_level_index = root_model(key, SecondLevelModelCount - 1);
-            auto& bucket = training_buckets[second_level_index];
-
-            // The following works because the previous training bucket has to be completed,
-            // because the sample is sorted:
-            // Each training bucket's min is the previous training bucket's max (except for first bucket)
-            if (bucket.empty() && second_level_index > 0 && !training_buckets[second_level_index - 1].empty())
-               bucket.push_back(training_buckets[second_level_index - 1].back());
-
-            // Add datapoint at the end of the bucket
-            bucket.push_back(Datapoint(key, static_cast<Precision>(i) / static_cast<Precision>(sample_size)));
-         }
-
-         // Edge case: First model does not have enough training data -> add artificial datapoints
-         while (training_buckets[0].size() < 2)
-            training_buckets[0].insert(training_buckets[0].begin(), Datapoint(0, 0));
-
-         // Train each second level model on its respective bucket
-         for (size_t model_idx = 0; model_idx < SecondLevelModelCount; model_idx++) {
-            auto& training_bucket = training_buckets[model_idx];
-
-            // Propagate datapoints from previous training bucket if necessary
-            while (training_bucket.size() < 2) {
-               assert(model_idx - 1 >= 0);
-               assert(!training_buckets[model_idx - 1].empty());
-               training_bucket.insert(training_bucket.begin(), training_buckets[model_idx - 1].back());
-            }
-            assert(training_bucket.size() >= 2);
+      RMIHash(const RandomIt& sample_begin, const RandomIt& sample_end, const size_t full_size,
+              const size_t thread_count = 1)
+         : root_model(RootModel({Datapoint(*sample_begin, 0), Datapoint(*(sample_end - 1), 1)})),
+           slopes(SecondLevelModelCount), intercepts(SecondLevelModelCount), full_size(full_size) {
+         // Since the root model is monotone, each second level model's training bucket is a contiguous range of
+         // the sorted sample. Split the sample into one chunk per thread, each starting at a training bucket's
+         // first datapoint, such that threads train disjoint ranges of models
+         const auto sample_size = static_cast<size_t>(std::distance(sample_begin, sample_end));
+         const auto chunk_count = std::clamp(std::max(sample_size, SecondLevelModelCount) / MinChunkSize,
+                                             static_cast<size_t>(1), std::max(thread_count, static_cast<size_t>(1)));
 
-            // Train model on training bucket & add it
-            second_level_models[model_idx] = SecondLevelModel(training_bucket);
+         std::vector<size_t> chunk_bounds(chunk_count + 1, sample_size);
+         chunk_bounds[0] = 0;
+         for (size_t c = 1; c < chunk_count; c++) {
+            const auto pos = sample_begin + static_cast<std::ptrdiff_t>(c * sample_size / chunk_count);
+            const auto model_idx = root_model(*pos, SecondLevelModelCount - 1);
+            const auto bound = std::partition_point(sample_begin + chunk_bounds[c - 1], pos, [&](const Key& key) {
+               return root_model(key, SecondLevelModelCount - 1) < model_idx;
+            });
+            chunk_bounds[c] = static_cast<size_t>(std::distance(sample_begin, bound));
          }
+         const auto chunk_models_end = [&](const size_t c) {
+            return c + 1 < chunk_count && chunk_bounds[c + 1] < sample_size
+               ? root_model(sample_begin[chunk_bounds[c + 1]], SecondLevelModelCount - 1)
+               : SecondLevelModelCount;
+         };
+
+         std::vector<std::thread> threads;
+         for (size_t c = 1; c < chunk_count; c++)
+            if (chunk_bounds[c] < chunk_bounds[c + 1])
+               threads.emplace_back([&, c] {
+                  train(sample_begin, chunk_bounds[c], chunk_bounds[c + 1], chunk_models_end(c), sample_size);
+               });
+         if (chunk_bounds[0] < chunk_bounds[1])
+            train(sample_begin, chunk_bounds[0], chunk_bounds[1], chunk_models_end(0), sample_size);
+
+         for (auto& t : threads)
+            t.join();
       }
 
       static std::string name() {
-         return "rmi_hash_" + std::to_string(SecondLevelModelCount);
+         if constexpr (std::is_same_v<SecondLevelModel, LinearImpl<Key, Precision>>)
+            return "rmi_hash_" + std::to_string(SecondLevelModelCount);
+         else
+            return "rmi_hash_" + SecondLevelModel::name() + "_" + std::to_string(SecondLevelModelCount);
       }
 
       size_t model_count() {
          return 1 + SecondLevelModelCount;
       }
 
+      size_t byte_size() const {
+         return sizeof(*this) + (slopes.size() + intercepts.size()) * sizeof(Precision);
+      }
+
       /**
        * Compute hash value for key
        *
@@ -168,7 +510,663 @@ namespace rmi {
       template<class Result = size_t>
       forceinline Result operator()(const Key& key) const {
          const auto second_level_index = root_model(key, SecondLevelModelCount - 1);
-         return second_level_models[second_level_index](key, full_size);
+         return SecondLevelModel(slopes[second_level_index], intercepts[second_level_index])(key, full_size);
+      }
+
+      /**
+       * Computes hash values for n keys at once, i.e., out[i] = (*this)(keys[i]).
+       * Both layers are evaluated for a whole vector of keys, second level
+       * parameters are gathered from their arrays. Results are identical to
+       * operator(), see LinearImpl::operator(). The vectorized evaluation
+       * mirrors LinearImpl's inference, i.e., models not derived from
+       * LinearImpl are evaluated one key at a time
+       */
+      forceinline void operator()(const Key* keys, size_t* out, const size_t& n) const
+         requires(sizeof(Key) == 4 || sizeof(Key) == 8)
+      {
+         if constexpr (std::is_base_of_v<LinearImpl<Key, Precision>, RootModel> &&
+                       std::is_base_of_v<LinearImpl<Key, Precision>, SecondLevelModel>) {
+            const auto max_index = static_cast<Precision>(SecondLevelModelCount - 1);
+            const auto max_value = static_cast<Precision>(full_size);
+
+            Batch::for_each_lane(
+               keys, out, n,
+               [&](auto key) {
+                  using namespace Batch;
+                  using V = decltype(key);
+                  const auto x = cvt_f64(key);
+                  const auto zero = set1_f64<V>(0);
+
+                  // root model
+                  auto pred = mul_f64(set1_f64<V>(max_index + 1), fmadd_f64(set1_f64<V>(root_model.slope()), x,
+                                                                             set1_f64<V>(root_model.intercept())));
+                  const auto index = cvt_index(min_f64(max_f64(pred, zero), set1_f64<V>(max_index)));
+
+                  // second level model
+                  pred = mul_f64(set1_f64<V>(max_value + 1),
+                                 fmadd_f64(gather_f64(slopes.data(), index), x, gather_f64(intercepts.data(), index)));
+                  return cvt_index(min_f64(max_f64(pred, zero), set1_f64<V>(max_value)));
+               },
+               [&](const Key& key) { return static_cast<HASH_64>((*this)(key)); });
+         } else {
+            for (size_t i = 0; i < n; i++)
+               out[i] = (*this)(keys[i]);
+         }
+      }
+
+      /**
+       * Hashes n keys at once, see hash_batch() and the batched operator()
+       */
+      forceinline void hash_batch(const Key* keys, HASH_64* out, const size_t& n) const
+         requires(sizeof(Key) == 4 || sizeof(Key) == 8)
+      {
+         (*this)(keys, out, n);
+      }
+
+      /**
+       * Writes all model parameters, e.g., to persist them as part of a hashtable snapshot
+       */
+      void serialize(std::ostream& out) const {
+         static_assert(std::is_trivially_copyable_v<RootModel>,
+                       "root model must be trivially copyable to be serialized");
+
+         out.write(reinterpret_cast<const char*>(&full_size), sizeof(full_size));
+         out.write(reinterpret_cast<const char*>(&root_model), sizeof(RootModel));
+         out.write(reinterpret_cast<const char*>(slopes.data()), slopes.size() * sizeof(Precision));
+         out.write(reinterpret_cast<const char*>(intercepts.data()), intercepts.size() * sizeof(Precision));
+      }
+
+      static RMIHash deserialize(std::istream& in) {
+         size_t full_size;
+         std::array<char, sizeof(RootModel)> root_model;
+         AlignedVector<Precision> slopes(SecondLevelModelCount), intercepts(SecondLevelModelCount);
+
+         in.read(reinterpret_cast<char*>(&full_size), sizeof(full_size));
+         in.read(root_model.data(), root_model.size());
+         in.read(reinterpret_cast<char*>(slopes.data()), slopes.size() * sizeof(Precision));
+         in.read(reinterpret_cast<char*>(intercepts.data()), intercepts.size() * sizeof(Precision));
+         if (!in)
+            throw std::runtime_error("serialized " + name() + " is truncated");
+
+         return RMIHash(std::bit_cast<RootModel>(root_model), std::move(slopes), std::move(intercepts), full_size);
+      }
+
+     private:
+      /// threads are only spawned for at least this many sample datapoints or models each
+      static constexpr size_t MinChunkSize = 1 << 16;
+
+      /**
+       * Trains the second level models [root_model(sample[begin]), models_end) on their training buckets,
+       * which are exactly sample[begin, end). Models are trained one after another in a single pass over
+       * the sample, i.e., their buckets are never materialized
+       */
+      template<class RandomIt>
+      void train(const RandomIt& sample_begin, const size_t begin, const size_t end, const size_t models_end,
+                 const size_t sample_size) {
+         using Trainer = typename SecondLevelModel::Trainer;
+
+         const auto datapoint = [&](const size_t i) {
+            return Datapoint(sample_begin[i], static_cast<Precision>(i) / static_cast<Precision>(sample_size));
+         };
+         const auto store = [&](const size_t model_idx, const SecondLevelModel& model) {
+            slopes[model_idx] = model.slope();
+            intercepts[model_idx] = model.intercept();
+         };
+         const auto fit = [](const Datapoint& a, const Datapoint& b) {
+            Trainer trainer;
+            trainer.add(a);
+            trainer.add(b);
+            return trainer.model();
+         };
+
+         Trainer trainer;
+         Datapoint before, last;
+         size_t model_idx = 0;
+
+         // Each training bucket's min is the previous training bucket's max, unless the previous bucket is
+         // empty. Models without datapoints continue the last datapoint
+         const auto start_bucket = [&](const size_t previous_idx) {
+            trainer = Trainer();
+            before = last;
+            if (model_idx == previous_idx + 1)
+               trainer.add(last);
+         };
+         const auto finish_bucket = [&]() {
+            // Edge case: Model does not have enough training data -> add artificial/previous datapoint
+            if (trainer.size() < 2)
+               store(model_idx, fit(model_idx == 0 ? Datapoint(0, 0) : before, last));
+            else
+               store(model_idx, trainer.model());
+         };
+
+         if (begin > 0) {
+            last = datapoint(begin - 1);
+            model_idx = root_model(sample_begin[begin], SecondLevelModelCount - 1);
+            start_bucket(root_model(last.x, SecondLevelModelCount - 1));
+         }
+
+         for (size_t i = begin; i < end; i++) {
+            const auto p = datapoint(i);
+            const auto second_level_index = root_model(p.x, SecondLevelModelCount - 1);
+            assert(second_level_index >= model_idx);
+
+            if (second_level_index != model_idx) {
+               finish_bucket();
+
+               const auto previous_idx = model_idx;
+               for (model_idx++; model_idx < second_level_index; model_idx++)
+                  store(model_idx, fit(last, last));
+               start_bucket(previous_idx);
+            }
+
+            trainer.add(p);
+            last = p;
+         }
+
+         finish_bucket();
+         for (model_idx++; model_idx < models_end; model_idx++)
+            store(model_idx, fit(last, last));
+      }
+
+      RMIHash(const RootModel& root_model, AlignedVector<Precision>&& slopes, AlignedVector<Precision>&& intercepts,
+              const size_t full_size)
+         : root_model(root_model), slopes(std::move(slopes)), intercepts(std::move(intercepts)),
+           full_size(full_size) {}
+
+      template<class, size_t, size_t, class>
+      friend struct QuantizedRMIHash;
+   };
+
+   /**
+    * RMIHash whose second level models are quantized to 32 + DeltaBits bits
+    * each instead of two doubles, i.e., a 10M model RMI shrinks from 160MB to
+    * roughly 60MB (DeltaBits = 16) or 80MB (DeltaBits = 32).
+    *
+    * Each model is stored relative to its segment, the key range that the
+    * root model assigns to it: for root prediction p \in [i, i + 1), model i
+    * predicts base_i + delta_i * (p - i), where base_i is its output at the
+    * segment's start (32-bit fixed point) and delta_i its output's change
+    * across the segment (DeltaBits-bit fixed point, biased and scaled such
+    * that QuantilePermille of all changes fit). Both are unsigned integer
+    * arrays, i.e., batched inference decodes them with a narrow gather and
+    * conversion each.
+    *
+    * Models that do not fit, e.g., steep models of dense clusters whose
+    * output leaves [0, 1] within their segment, are patched: delta_i = 0
+    * marks them and base_i indexes their exact parameters in a (small)
+    * exception table, i.e., they predict exactly like RMIHash.
+    *
+    * Training is identical to RMIHash's, quantization only costs precision
+    *
+    * @tparam DeltaBits 16 or 32
+    */
+   template<class Key,
+            size_t SecondLevelModelCount,
+            size_t DeltaBits = 16,
+            class SecondLevelModel = LinearImpl<Key, double>>
+   struct QuantizedRMIHash {
+      static_assert(DeltaBits == 16 || DeltaBits == 32, "deltas are quantized to 16 or 32 bits");
+
+     private:
+      using Precision = double;
+      using RootModel = LinearImpl<Key, Precision>;
+      using Unquantized = RMIHash<Key, SecondLevelModelCount, RootModel, SecondLevelModel>;
+      using Base = std::uint32_t;
+      using Delta = std::conditional_t<DeltaBits == 16, std::uint16_t, std::uint32_t>;
+
+      static constexpr Precision BaseUnit = 0x1p-32;
+      /// deltas are stored as delta + DeltaBias \in [1, 2^DeltaBits), 0 marks exceptions
+      static constexpr Precision DeltaBias = static_cast<Precision>(1ULL << (DeltaBits - 1));
+      static constexpr Delta Exception = 0;
+      /// the delta scale is chosen such that this quantile of all models fits, the rest are exceptions
+      static constexpr size_t QuantilePermille = 999;
+      /// Batch::gather_narrow() reads 8 bytes per entry, i.e., past the last model
+      static constexpr size_t Padding = 8 / sizeof(Delta);
+
+      /// Root model
+      const RootModel root_model;
+
+      /// Quantized second level models, see above
+      AlignedVector<Base> bases;
+      AlignedVector<Delta> deltas;
+
+      /// Exact parameters of exception models. Padded to a power of two, such that
+      /// batched inference computes a valid index for every model (base_i & exception_mask)
+      AlignedVector<Precision> exception_slopes, exception_intercepts;
+      std::uint64_t exception_mask;
+
+      /// dequantization factors, which include scaling the output from [0, 1] to [0, full_size]
+      Precision base_scale, delta_scale;
+
+      const size_t full_size;
+
+      static forceinline Precision fmadd(const Precision& a, const Precision& b, const Precision& c) {
+         // Fused iff the build targets FMA, i.e., rounds exactly like Batch::fmadd_f64()
+#ifdef __FMA__
+         return std::fma(a, b, c);
+#else
+         return a * b + c;
+#endif
+      }
+
+     public:
+      /**
+       * Trains an RMIHash on an already sorted (!) sample and quantizes it
+       *
+       * @param full_size operator() will extrapolate to [0, full_size]. Requires full_size < 2^52
+       * @param thread_count amount of threads that train the second level, see RMIHash
+       */
+      template<class RandomIt>
+      QuantizedRMIHash(const RandomIt& sample_begin, const RandomIt& sample_end, const size_t full_size,
+                       const size_t thread_count = 1)
+         : QuantizedRMIHash(Unquantized(sample_begin, sample_end, full_size, thread_count)) {}
+
+      static std::string name() {
+         const auto quantization = "q" + std::to_string(DeltaBits) + "_";
+         if constexpr (std::is_same_v<SecondLevelModel, LinearImpl<Key, Precision>>)
+            return "rmi_hash_" + quantization + std::to_string(SecondLevelModelCount);
+         else
+            return "rmi_hash_" + quantization + SecondLevelModel::name() + "_" + std::to_string(SecondLevelModelCount);
+      }
+
+      size_t model_count() {
+         return 1 + SecondLevelModelCount;
+      }
+
+      size_t byte_size() const {
+         return sizeof(*this) + bases.size() * sizeof(Base) + deltas.size() * sizeof(Delta) +
+            (exception_slopes.size() + exception_intercepts.size()) * sizeof(Precision);
+      }
+
+      /**
+       * Compute hash value for key
+       *
+       * @tparam Result result data type. Defaults to size_t
+       * @param key
+       */
+      template<class Result = size_t>
+      forceinline Result operator()(const Key& key) const {
+         const auto max_index = static_cast<Precision>(SecondLevelModelCount - 1);
+         const auto max_value = static_cast<Precision>(full_size);
+         const auto x = static_cast<Precision>(key);
+
+         const auto root_pred = (max_index + 1) * fmadd(root_model.slope(), x, root_model.intercept());
+         const auto index = static_cast<size_t>(std::min(std::max(root_pred, Precision(0)), max_index));
+
+         Precision pred;
+         if (deltas[index] == Exception) {
+            const auto e = bases[index];
+            pred = (max_value + 1) * fmadd(exception_slopes[e], x, exception_intercepts[e]);
+         } else {
+            const auto offset = root_pred - static_cast<Precision>(index);
+            pred = fmadd(static_cast<Precision>(deltas[index]) - DeltaBias, offset * delta_scale,
+                         static_cast<Precision>(bases[index]) * base_scale);
+         }
+         return static_cast<Result>(std::min(std::max(pred, Precision(0)), max_value));
+      }
+
+      /**
+       * Computes hash values for n keys at once, i.e., out[i] = (*this)(keys[i]),
+       * see RMIHash's batched operator(). Both the quantized and the exact
+       * (exception) prediction are computed for every key, the latter is
+       * blended in for exception models
+       */
+      forceinline void operator()(const Key* keys, size_t* out, const size_t& n) const
+         requires(sizeof(Key) == 4 || sizeof(Key) == 8)
+      {
+         const auto max_index = static_cast<Precision>(SecondLevelModelCount - 1);
+         const auto max_value = static_cast<Precision>(full_size);
+
+         Batch::for_each_lane(
+            keys, out, n,
+            [&](auto key) {
+               using namespace Batch;
+               using V = decltype(key);
+               const auto x = cvt_f64(key);
+               const auto zero = set1_f64<V>(0);
+
+               // root model
+               const auto root = fmadd_f64(set1_f64<V>(root_model.slope()), x, set1_f64<V>(root_model.intercept()));
+               const auto root_pred = mul_f64(set1_f64<V>(max_index + 1), root);
+               const auto index = cvt_index(min_f64(max_f64(root_pred, zero), set1_f64<V>(max_index)));
+               const auto offset = sub_f64(root_pred, cvt_f64(index));
+
+               // quantized second level model
+               const auto delta = gather_narrow(deltas.data(), index);
+               const auto base = gather_narrow(bases.data(), index);
+               const auto delta_value = sub_f64(cvt_f64(delta), set1_f64<V>(DeltaBias));
+               const auto quantized = fmadd_f64(delta_value, mul_f64(offset, set1_f64<V>(delta_scale)),
+                                                mul_f64(cvt_f64(base), set1_f64<V>(base_scale)));
+
+               // exception model
+               const auto e = and64(base, set1<V>(exception_mask));
+               const auto exact_model = fmadd_f64(gather_f64(exception_slopes.data(), e), x,
+                                                  gather_f64(exception_intercepts.data(), e));
+               const auto exact = mul_f64(set1_f64<V>(max_value + 1), exact_model);
+
+               const auto pred = blend_zero_f64(delta, exact, quantized);
+               return cvt_index(min_f64(max_f64(pred, zero), set1_f64<V>(max_value)));
+            },
+            [&](const Key& key) { return static_cast<HASH_64>((*this)(key)); });
+      }
+
+      /**
+       * Hashes n keys at once, see hash_batch() and the batched operator()
+       */
+      forceinline void hash_batch(const Key* keys, HASH_64* out, const size_t& n) const
+         requires(sizeof(Key) == 4 || sizeof(Key) == 8)
+      {
+         (*this)(keys, out, n);
+      }
+
+      /**
+       * Writes the quantized model, e.g., to persist it as part of a hashtable snapshot
+       */
+      void serialize(std::ostream& out) const {
+         const size_t exception_count = exception_slopes.size();
+
+         out.write(reinterpret_cast<const char*>(&full_size), sizeof(full_size));
+         out.write(reinterpret_cast<const char*>(&root_model), sizeof(RootModel));
+         out.write(reinterpret_cast<const char*>(&base_scale), sizeof(base_scale));
+         out.write(reinterpret_cast<const char*>(&delta_scale), sizeof(delta_scale));
+         out.write(reinterpret_cast<const char*>(bases.data()), bases.size() * sizeof(Base));
+         out.write(reinterpret_cast<const char*>(deltas.data()), deltas.size() * sizeof(Delta));
+         out.write(reinterpret_cast<const char*>(&exception_count), sizeof(exception_count));
+         out.write(reinterpret_cast<const char*>(exception_slopes.data()), exception_count * sizeof(Precision));
+         out.write(reinterpret_cast<const char*>(exception_intercepts.data()), exception_count * sizeof(Precision));
+      }
+
+      static QuantizedRMIHash deserialize(std::istream& in) {
+         size_t full_size, exception_count = 0;
+         std::array<char, sizeof(RootModel)> root_model;
+         Precision base_scale, delta_scale;
+         AlignedVector<Base> bases(SecondLevelModelCount + Padding);
+         AlignedVector<Delta> deltas(SecondLevelModelCount + Padding);
+
+         in.read(reinterpret_cast<char*>(&full_size), sizeof(full_size));
+         in.read(root_model.data(), root_model.size());
+         in.read(reinterpret_cast<char*>(&base_scale), sizeof(base_scale));
+         in.read(reinterpret_cast<char*>(&delta_scale), sizeof(delta_scale));
+         in.read(reinterpret_cast<char*>(bases.data()), bases.size() * sizeof(Base));
+         in.read(reinterpret_cast<char*>(deltas.data()), deltas.size() * sizeof(Delta));
+         in.read(reinterpret_cast<char*>(&exception_count), sizeof(exception_count));
+         // serialize() writes the padded exception table, see pad_exceptions()
+         if (!in || exception_count > std::bit_ceil(SecondLevelModelCount))
+            throw std::runtime_error("serialized " + name() + " is truncated");
+
+         AlignedVector<Precision> exception_slopes(exception_count), exception_intercepts(exception_count);
+         in.read(reinterpret_cast<char*>(exception_slopes.data()), exception_count * sizeof(Precision));
+         in.read(reinterpret_cast<char*>(exception_intercepts.data()), exception_count * sizeof(Precision));
+         if (!in)
+            throw std::runtime_error("serialized " + name() + " is truncated");
+
+         return QuantizedRMIHash(std::bit_cast<RootModel>(root_model), std::move(bases), std::move(deltas),
+                                 std::move(exception_slopes), std::move(exception_intercepts), base_scale,
+                                 delta_scale, full_size);
+      }
+
+     private:
+      explicit QuantizedRMIHash(const Unquantized& rmi)
+         : root_model(rmi.root_model), bases(SecondLevelModelCount + Padding),
+           deltas(SecondLevelModelCount + Padding), full_size(rmi.full_size) {
+         // Root model predicts exactly i at segment_start(i)
+         const auto segment_start = [&](const size_t i) {
+            if (root_model.slope() == 0)
+               return Precision(0);
+            return (static_cast<Precision>(i) / static_cast<Precision>(SecondLevelModelCount) -
+                    root_model.intercept()) /
+               root_model.slope();
+         };
+         const auto model = [&](const size_t i, const Precision x) { return rmi.slopes[i] * x + rmi.intercepts[i]; };
+         const auto in_range = [](const Precision y) { return y >= 0 && y <= 1; };
+
+         // Bases are rounded first such that deltas compensate their rounding error
+         std::vector<Precision> changes(SecondLevelModelCount, std::numeric_limits<Precision>::infinity());
+         for (size_t i = 0; i < SecondLevelModelCount; i++) {
+            const auto start = model(i, segment_start(i)), end = model(i, segment_start(i + 1));
+            if (!in_range(start) || !in_range(end))
+               continue;
+
+            bases[i] = static_cast<Base>(std::min(std::round(start / BaseUnit), static_cast<Precision>(~Base(0))));
+            changes[i] = end - static_cast<Precision>(bases[i]) * BaseUnit;
+         }
+
+         // Scale deltas such that all but the largest changes fit
+         std::vector<Precision> magnitudes(SecondLevelModelCount);
+         std::transform(changes.begin(), changes.end(), magnitudes.begin(), [](const auto c) { return std::abs(c); });
+         const auto quantile = magnitudes.begin() + (SecondLevelModelCount - 1) * QuantilePermille / 1000;
+         std::nth_element(magnitudes.begin(), quantile, magnitudes.end());
+         const auto max_change = std::isfinite(*quantile) ? *quantile : Precision(1);
+         const auto delta_unit = max_change > 0 ? max_change / (DeltaBias - 1) : Precision(1);
+
+         for (size_t i = 0; i < SecondLevelModelCount; i++) {
+            if (std::abs(changes[i]) <= max_change) {
+               deltas[i] = static_cast<Delta>(std::round(changes[i] / delta_unit) + DeltaBias);
+               continue;
+            }
+
+            deltas[i] = Exception;
+            bases[i] = static_cast<Base>(exception_slopes.size());
+            exception_slopes.push_back(rmi.slopes[i]);
+            exception_intercepts.push_back(rmi.intercepts[i]);
+         }
+         pad_exceptions();
+
+         base_scale = (static_cast<Precision>(full_size) + 1) * BaseUnit;
+         delta_scale = (static_cast<Precision>(full_size) + 1) * delta_unit;
+      }
+
+      QuantizedRMIHash(const RootModel& root_model, AlignedVector<Base>&& bases, AlignedVector<Delta>&& deltas,
+                       AlignedVector<Precision>&& exception_slopes, AlignedVector<Precision>&& exception_intercepts,
+                       const Precision base_scale, const Precision delta_scale, const size_t full_size)
+         : root_model(root_model), bases(std::move(bases)), deltas(std::move(deltas)),
+           exception_slopes(std::move(exception_slopes)), exception_intercepts(std::move(exception_intercepts)),
+           base_scale(base_scale), delta_scale(delta_scale), full_size(full_size) {
+         pad_exceptions();
+      }
+
+      /// pads the exception table to a power of two (at least one) entries, see exception_mask
+      void pad_exceptions() {
+         const auto padded_size = std::bit_ceil(std::max(exception_slopes.size(), static_cast<size_t>(1)));
+         exception_slopes.resize(padded_size, 0);
+         exception_intercepts.resize(padded_size, 0);
+         exception_mask = padded_size - 1;
+      }
+   };
+
+   /// Model types of an RMI's layers, from root to last layer, e.g., Layers<CubicImpl, LinearImpl>
+   template<template<class, class> class... Models>
+   struct Layers {};
+
+   /// Model counts of an RMI's layers, from root to last layer. The root layer always consists of a single model
+   template<size_t... Counts>
+   struct Sizes {};
+
+   template<class Key, class Layers, class Sizes>
+   struct RMI;
+
+   /**
+    * Recursive model index with a compile time topology, e.g.,
+    * RMI<Key, Layers<LinearImpl, CubicImpl, LinearImpl>, Sizes<1, 1024, 1 << 20>>.
+    * Each model predicts the key's position in the sample, i.e., its
+    * (empirical) CDF, which selects a model of the next layer or, for the
+    * last layer, the output in [0, full_size].
+    *
+    * Each layer's models are stored in one flat, cache line aligned array,
+    * hence inference performs exactly one (dependent) load per layer
+    */
+   template<class Key, template<class, class> class... Models, size_t... Counts>
+   struct RMI<Key, Layers<Models...>, Sizes<Counts...>> {
+     private:
+      using Precision = double;
+      using Datapoint = DatapointImpl<Key, Precision>;
+
+      static constexpr size_t LayerCount = sizeof...(Models);
+      static constexpr std::array<size_t, LayerCount> layer_sizes{Counts...};
+
+      static_assert(LayerCount > 0 && LayerCount == sizeof...(Counts), "each layer requires a size");
+      static_assert(layer_sizes[0] == 1, "root layer must consist of a single model");
+      static_assert(std::ranges::all_of(layer_sizes, [](const size_t s) { return s > 0; }), "empty layer");
+
+      /// models of each layer, flattened
+      using LayerArrays = std::tuple<AlignedVector<Models<Key, Precision>>...>;
+      LayerArrays layers;
+
+      /// output range is scaled from [0, 1] to [0, full_size]
+      const size_t full_size;
+
+     public:
+      /**
+       * Builds rmi on an already sorted (!) sample, one layer at a time
+       *
+       * @param full_size operator() will extrapolate to [0, full_size]
+       */
+      template<class RandomIt>
+      RMI(const RandomIt& sample_begin, const RandomIt& sample_end, const size_t full_size)
+         : layers(AlignedVector<Models<Key, Precision>>(Counts)...), full_size(full_size) {
+         const auto sample_size = static_cast<size_t>(std::distance(sample_begin, sample_end));
+         const auto datapoint = [&](const size_t i) {
+            return Datapoint(sample_begin[i], static_cast<Precision>(i) / static_cast<Precision>(sample_size));
+         };
+
+         // model of the current layer each sample datapoint is assigned to
+         std::vector<size_t> assignment(sample_size, 0);
+         // sample datapoints ordered by their assigned model (stable, i.e., sorted by key per model)
+         std::vector<size_t> order(sample_size);
+         std::vector<size_t> offsets;
+
+         for_each_layer([&]<size_t L>() {
+            auto& models = std::get<L>(layers);
+            using Model = typename std::remove_cvref_t<decltype(models)>::value_type;
+
+            if constexpr (L > 0) {
+               const auto& previous = std::get<L - 1>(layers);
+               for (size_t i = 0; i < sample_size; i++)
+                  assignment[i] = previous[assignment[i]](sample_begin[i], layer_sizes[L] - 1);
+            }
+
+            // counting sort by assignment
+            offsets.assign(layer_sizes[L] + 1, 0);
+            for (const auto& model_idx : assignment)
+               offsets[model_idx + 1]++;
+            for (size_t j = 0; j < layer_sizes[L]; j++)
+               offsets[j + 1] += offsets[j];
+            for (size_t i = 0; i < sample_size; i++)
+               order[offsets[assignment[i]]++] = i;
+            for (size_t j = layer_sizes[L]; j > 0; j--)
+               offsets[j] = offsets[j - 1];
+            offsets[0] = 0;
+
+            const auto fit = [](const Datapoint& a, const Datapoint& b) {
+               typename Model::Trainer trainer;
+               trainer.add(a);
+               trainer.add(b);
+               return trainer.model();
+            };
+
+            Datapoint last;
+            for (size_t j = 0; j < layer_sizes[L]; j++) {
+               const auto begin = offsets[j], end = offsets[j + 1];
+
+               // Models without datapoints continue the last datapoint
+               if (begin == end) {
+                  models[j] = fit(last, last);
+                  continue;
+               }
+
+               // Each training bucket's min is the previous bucket's max if they are adjacent in the sample
+               const auto first = order[begin];
+               typename Model::Trainer trainer;
+               if (j > 0 && first > 0 && assignment[first - 1] == j - 1)
+                  trainer.add(datapoint(first - 1));
+               for (size_t k = begin; k < end; k++)
+                  trainer.add(datapoint(order[k]));
+
+               // Edge case: Model does not have enough training data -> add artificial/previous datapoint
+               if (trainer.size() < 2)
+                  models[j] = fit(first > 0 ? datapoint(first - 1) : Datapoint(0, 0), datapoint(first));
+               else
+                  models[j] = trainer.model();
+
+               last = datapoint(order[end - 1]);
+            }
+         });
+      }
+
+      static std::string name() {
+         std::string name = "rmi";
+         size_t layer = 0;
+         ((name += "_" + Models<Key, Precision>::name() + "_" + std::to_string(layer_sizes[layer++])), ...);
+         return name;
+      }
+
+      size_t model_count() {
+         return (Counts + ...);
+      }
+
+      size_t byte_size() const {
+         size_t bytes = sizeof(*this);
+         for_each_layer([&]<size_t L>() { bytes += std::get<L>(layers).size() * sizeof(std::get<L>(layers)[0]); });
+         return bytes;
+      }
+
+      /**
+       * Compute hash value for key
+       *
+       * @tparam Result result data type. Defaults to size_t
+       * @param key
+       */
+      template<class Result = size_t>
+      forceinline Result operator()(const Key& key) const {
+         return static_cast<Result>(predict<0>(key, 0));
+      }
+
+      /**
+       * Writes all model parameters, layer by layer
+       */
+      void serialize(std::ostream& out) const {
+         out.write(reinterpret_cast<const char*>(&full_size), sizeof(full_size));
+         for_each_layer([&]<size_t L>() {
+            const auto& models = std::get<L>(layers);
+            using Model = typename std::remove_cvref_t<decltype(models)>::value_type;
+            static_assert(std::is_trivially_copyable_v<Model>, "models must be trivially copyable to be serialized");
+            out.write(reinterpret_cast<const char*>(models.data()), models.size() * sizeof(Model));
+         });
+      }
+
+      static RMI deserialize(std::istream& in) {
+         size_t full_size;
+         in.read(reinterpret_cast<char*>(&full_size), sizeof(full_size));
+
+         LayerArrays layers{AlignedVector<Models<Key, Precision>>(Counts)...};
+         for_each_layer([&]<size_t L>() {
+            auto& models = std::get<L>(layers);
+            in.read(reinterpret_cast<char*>(models.data()), models.size() * sizeof(models[0]));
+         });
+         if (!in)
+            throw std::runtime_error("serialized " + name() + " is truncated");
+
+         return RMI(std::move(layers), full_size);
+      }
+
+     private:
+      template<size_t L>
+      forceinline size_t predict(const Key& key, const size_t model_idx) const {
+         const auto& model = std::get<L>(layers)[model_idx];
+         if constexpr (L + 1 == LayerCount)
+            return model(key, static_cast<Precision>(full_size));
+         else
+            return predict<L + 1>(key, model(key, static_cast<Precision>(layer_sizes[L + 1] - 1)));
+      }
+
+      RMI(LayerArrays&& layers, const size_t full_size)
+         : layers(std::move(layers)), full_size(full_size) {}
+
+      template<class F>
+      static void for_each_layer(F&& f) {
+         [&]<size_t... L>(std::index_sequence<L...>) {
+            (f.template operator()<L>(), ...);
+         }(std::make_index_sequence<LayerCount>{});
       }
    };
 } // namespace rmi
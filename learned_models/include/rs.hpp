@@ -2,8 +2,13 @@
 
 #include "rs/builder.h"
 #include "rs/radix_spline.h"
+#include "rs/serializer.h"
 
+#include <algorithm>
+#include <array>
 #include <iostream>
+#include <istream>
+#include <ostream>
 #include <string>
 #include <vector>
 
@@ -13,27 +18,33 @@ namespace rs {
             const size_t MaxError = 32,
             const size_t MaxModels = std::numeric_limits<size_t>::max()>
    struct RadixSplineHash {
+      /**
+       * Builds the spline on an already sorted (!) sample
+       *
+       * @param full_size operator() will extrapolate to [0, full_size]
+       * @param thread_count amount of threads that build the spline, see rs::Builder::Build(). Defaults to 1,
+       *    i.e., the calling thread
+       */
       template<class RandomIt>
-      RadixSplineHash(const RandomIt& sample_begin, const RandomIt& sample_end, const size_t full_size)
+      RadixSplineHash(const RandomIt& sample_begin, const RandomIt& sample_end, const size_t full_size,
+                      const size_t thread_count = 1)
          // output \in [0, sample_size] -> multiply with (full_size / sample_size)
          : out_scale_fac(static_cast<double>(full_size) /
                          static_cast<double>(std::distance(sample_begin, sample_end))) {
-         const Data min = *sample_begin;
-         const Data max = *(sample_end - 1);
-         rs::Builder<Data> rsb(min, max, NumRadixBits, MaxError);
-         for (auto it = sample_begin; it < sample_end; it++)
-            rsb.AddKey(*it);
+         spline = rs::Builder<Data>::Build(sample_begin, sample_end, NumRadixBits, MaxError, thread_count);
 
-         spline = rsb.Finalize();
-
-         if (spline.spline_points_.size() > MaxModels) {
+         if (spline.GetNumSplinePoints() > MaxModels) {
             throw std::runtime_error("RS " + name() + " had more models than allowed: " +
-                                     std::to_string(spline.spline_points_.size()) + " > " + std::to_string(MaxModels));
+                                     std::to_string(spline.GetNumSplinePoints()) + " > " + std::to_string(MaxModels));
          }
       }
 
       size_t model_count() {
-         return spline.spline_points_.size();
+         return spline.GetNumSplinePoints();
+      }
+
+      size_t byte_size() const {
+         return sizeof(*this) - sizeof(spline) + spline.GetSize();
       }
 
       static std::string name() {
@@ -45,8 +56,60 @@ namespace rs {
          return static_cast<Result>(spline.GetEstimatedPosition(key) * out_scale_fac);
       }
 
+      /**
+       * Computes hash values for n keys at once, i.e., out[i] = (*this)(keys[i]).
+       * Radix table and spline lookups of consecutive keys overlap, see
+       * rs::RadixSpline::GetEstimatedPositions()
+       */
+      forceinline void operator()(const Data* keys, size_t* out, const size_t& n) const {
+         constexpr size_t BatchSize = 256;
+         std::array<double, BatchSize> positions;
+         for (size_t i = 0; i < n; i += BatchSize) {
+            const auto batch_size = std::min(BatchSize, n - i);
+            spline.GetEstimatedPositions(keys + i, positions.data(), batch_size);
+            for (size_t j = 0; j < batch_size; j++)
+               out[i + j] = static_cast<size_t>(positions[j] * out_scale_fac);
+         }
+      }
+
+      /**
+       * Hashes n keys at once, see hash_batch() and the batched operator()
+       */
+      forceinline void hash_batch(const Data* keys, HASH_64* out, const size_t& n) const {
+         (*this)(keys, out, n);
+      }
+
+      /**
+       * Writes the trained spline, e.g., to persist it as part of a hashtable snapshot
+       */
+      void serialize(std::ostream& out) const {
+         std::string bytes;
+         rs::Serializer<Data>::ToBytes(spline, &bytes);
+         const size_t byte_count = bytes.size();
+
+         out.write(reinterpret_cast<const char*>(&out_scale_fac), sizeof(out_scale_fac));
+         out.write(reinterpret_cast<const char*>(&byte_count), sizeof(byte_count));
+         out.write(bytes.data(), bytes.size());
+      }
+
+      static RadixSplineHash deserialize(std::istream& in) {
+         double out_scale_fac;
+         size_t byte_count;
+         in.read(reinterpret_cast<char*>(&out_scale_fac), sizeof(out_scale_fac));
+         in.read(reinterpret_cast<char*>(&byte_count), sizeof(byte_count));
+
+         std::string bytes(byte_count, 0);
+         if (!in.read(bytes.data(), bytes.size()))
+            throw std::runtime_error("serialized " + name() + " is truncated");
+
+         return RadixSplineHash(out_scale_fac, rs::Serializer<Data>::FromBytes(bytes));
+      }
+
      private:
       const double out_scale_fac;
       rs::RadixSpline<Data> spline;
+
+      RadixSplineHash(const double out_scale_fac, rs::RadixSpline<Data>&& spline)
+         : out_scale_fac(out_scale_fac), spline(std::move(spline)) {}
    };
 } // namespace rs
\ No newline at end of file
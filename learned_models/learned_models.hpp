@@ -1,5 +1,7 @@
 #pragma once
 
+#include "include/cache.hpp"
+#include "include/incremental.hpp"
 #include "include/pgm.hpp"
 #include "include/rmi.hpp"
 #include "include/rs.hpp"
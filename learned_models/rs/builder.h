@@ -1,8 +1,12 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <iterator>
 #include <limits>
+#include <thread>
+#include <vector>
 
 #include "common.h"
 #include "radix_spline.h"
@@ -15,20 +19,108 @@ class Builder {
  public:
   Builder(KeyType min_key, KeyType max_key, size_t num_radix_bits = 18,
           size_t max_error = 32)
-      : min_key_(min_key),
-        max_key_(max_key),
-        num_radix_bits_(num_radix_bits),
-        num_shift_bits_(GetNumShiftBits(max_key - min_key, num_radix_bits)),
-        max_error_(max_error),
-        curr_num_keys_(0),
-        curr_num_distinct_keys_(0),
-        prev_key_(min_key),
-        prev_position_(0),
-        prev_prefix_(0) {
-    // Initialize radix table, needs to contain all prefixes up to the largest
-    // key + 1.
-    const uint32_t max_prefix = (max_key - min_key) >> num_shift_bits_;
-    radix_table_.resize(max_prefix + 2, 0);
+      : Builder(min_key, max_key, num_radix_bits, max_error,
+                /*with_radix_table=*/true) {}
+
+  // Builds a `RadixSpline` over the sorted keys [begin, end) using
+  // `thread_count` threads. The keys are split into contiguous chunks, one per
+  // thread, and each chunk gets its own spline. Chunk boundaries never split
+  // runs of equal keys. Each chunk spline starts and ends at an exact CDF
+  // point, and no key lies between a chunk's last point and the next chunk's
+  // first point. The connecting segment therefore has no error, so the
+  // concatenated spline keeps the `max_error` bound. Each boundary adds at
+  // most two spline points compared to the serial build. The radix table is
+  // filled in parallel too, as disjoint prefix ranges.
+  template <class RandomIt>
+  static RadixSpline<KeyType> Build(RandomIt begin, RandomIt end,
+                                    size_t num_radix_bits = 18,
+                                    size_t max_error = 32,
+                                    size_t thread_count = 1) {
+    const size_t num_keys = std::distance(begin, end);
+    const size_t chunk_count =
+        std::clamp(num_keys / kMinChunkSize, static_cast<size_t>(1),
+                   std::max(thread_count, static_cast<size_t>(1)));
+    const KeyType min_key = *begin;
+    const KeyType max_key = *(end - 1);
+
+    if (chunk_count == 1) {
+      Builder builder(min_key, max_key, num_radix_bits, max_error);
+      for (auto it = begin; it < end; ++it) builder.AddKey(*it);
+      return builder.Finalize();
+    }
+
+    // Chunk boundaries, moved back to the start of their run of equal keys.
+    std::vector<size_t> bounds(chunk_count + 1, num_keys);
+    bounds[0] = 0;
+    for (size_t c = 1; c < chunk_count; ++c) {
+      const auto pos = begin + c * num_keys / chunk_count;
+      bounds[c] = std::distance(
+          begin, std::lower_bound(begin + bounds[c - 1], pos, *pos));
+    }
+
+    // Spline of each chunk, with positions relative to the whole key range.
+    std::vector<std::vector<Coord<KeyType>>> chunk_points(chunk_count);
+    {
+      std::vector<std::thread> threads;
+      for (size_t c = 0; c < chunk_count; ++c) {
+        if (bounds[c] == bounds[c + 1]) continue;
+        threads.emplace_back([&, c] {
+          Builder builder(min_key, max_key, num_radix_bits, max_error,
+                          /*with_radix_table=*/false);
+          for (size_t i = bounds[c]; i < bounds[c + 1]; ++i)
+            builder.AddKey(begin[i], i);
+          chunk_points[c] = builder.FinalizeSplinePoints();
+        });
+      }
+      for (auto& t : threads) t.join();
+    }
+
+    std::vector<Coord<KeyType>> spline_points;
+    {
+      size_t num_points = 0;
+      for (const auto& points : chunk_points) num_points += points.size();
+      spline_points.reserve(num_points);
+      for (const auto& points : chunk_points)
+        spline_points.insert(spline_points.end(), points.begin(),
+                             points.end());
+    }
+
+    // radix_table[prefix] is the amount of spline points with a smaller
+    // prefix, i.e., the index of the first spline point with prefix >= prefix.
+    const size_t num_shift_bits =
+        GetNumShiftBits(max_key - min_key, num_radix_bits);
+    const auto get_prefix = [&](const Coord<KeyType>& point) -> KeyType {
+      return (point.x - min_key) >> num_shift_bits;
+    };
+    const uint32_t max_prefix = (max_key - min_key) >> num_shift_bits;
+    std::vector<uint32_t> radix_table(max_prefix + 2);
+    {
+      std::vector<std::thread> threads;
+      for (size_t c = 0; c < chunk_count; ++c) {
+        threads.emplace_back([&, c] {
+          const size_t prefix_begin = c * radix_table.size() / chunk_count;
+          const size_t prefix_end = (c + 1) * radix_table.size() / chunk_count;
+          size_t index = std::distance(
+              spline_points.begin(),
+              std::partition_point(spline_points.begin(), spline_points.end(),
+                                   [&](const Coord<KeyType>& point) {
+                                     return get_prefix(point) < prefix_begin;
+                                   }));
+          for (size_t prefix = prefix_begin; prefix < prefix_end; ++prefix) {
+            while (index < spline_points.size() &&
+                   get_prefix(spline_points[index]) < prefix)
+              ++index;
+            radix_table[prefix] = index;
+          }
+        });
+      }
+      for (auto& t : threads) t.join();
+    }
+
+    return RadixSpline<KeyType>(min_key, max_key, num_keys, num_radix_bits,
+                                num_shift_bits, max_error,
+                                std::move(radix_table),
+                                std::move(spline_points));
   }
 
   // Adds a key. Assumes that keys are stored in a dense array.
@@ -58,6 +150,39 @@ class Builder {
   }
 
  private:
+  // Chunks smaller than this are not worth a thread of their own.
+  static constexpr size_t kMinChunkSize = 1 << 16;
+
+  // Without radix table, the builder only computes spline points, see Build().
+  Builder(KeyType min_key, KeyType max_key, size_t num_radix_bits,
+          size_t max_error, bool with_radix_table)
+      : min_key_(min_key),
+        max_key_(max_key),
+        num_radix_bits_(num_radix_bits),
+        num_shift_bits_(GetNumShiftBits(max_key - min_key, num_radix_bits)),
+        max_error_(max_error),
+        with_radix_table_(with_radix_table),
+        curr_num_keys_(0),
+        curr_num_distinct_keys_(0),
+        prev_key_(min_key),
+        prev_position_(0),
+        prev_prefix_(0) {
+    // Initialize radix table, needs to contain all prefixes up to the largest
+    // key + 1.
+    if (with_radix_table_) {
+      const uint32_t max_prefix = (max_key - min_key) >> num_shift_bits_;
+      radix_table_.resize(max_prefix + 2, 0);
+    }
+  }
+
+  // Finalizes a chunk's spline, which (unlike Finalize()) ends at the chunk's
+  // last key rather than at `max_key_`.
+  std::vector<Coord<KeyType>> FinalizeSplinePoints() {
+    if (curr_num_keys_ > 0 && spline_points_.back().x != prev_key_)
+      AddKeyToSpline(prev_key_, prev_position_);
+    return std::move(spline_points_);
+  }
+
   // Returns the number of shift bits based on the `diff` between the largest
   // and the smallest key. KeyType == uint32_t.
   static size_t GetNumShiftBits(uint32_t diff, size_t num_radix_bits) {
@@ -88,7 +213,7 @@ class Builder {
 
   void AddKeyToSpline(KeyType key, double position) {
     spline_points_.push_back({key, position});
-    PossiblyAddKeyToRadixTable(key);
+    if (with_radix_table_) PossiblyAddKeyToRadixTable(key);
   }
 
   enum Orientation { Collinear, CW, CCW };
@@ -220,6 +345,7 @@ class Builder {
   const size_t num_radix_bits_;
   const size_t num_shift_bits_;
   const size_t max_error_;
+  const bool with_radix_table_;
 
   std::vector<uint32_t> radix_table_;
   std::vector<Coord<KeyType>> spline_points_;
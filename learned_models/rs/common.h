@@ -12,6 +12,13 @@ struct Coord {
   double y;
 };
 
+// Spline point spline[index] without its key, i.e., its position and the
+// precomputed slope of the segment (spline[index], spline[index + 1]].
+struct Segment {
+  double y;
+  double slope;
+};
+
 struct SearchBound {
   size_t begin;
   size_t end;  // Exclusive.
@@ -1,9 +1,14 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cassert>
 #include <cmath>
+#include <cstdint>
+#include <limits>
 #include <vector>
+#include <immintrin.h>
 
 #include "common.h"
 
@@ -19,8 +24,9 @@ namespace rs {
       RadixSpline(KeyType min_key, KeyType max_key, size_t num_keys, size_t num_radix_bits, size_t num_shift_bits,
                   size_t max_error, std::vector<uint32_t> radix_table, std::vector<rs::Coord<KeyType>> spline_points)
          : min_key_(min_key), max_key_(max_key), num_keys_(num_keys), num_radix_bits_(num_radix_bits),
-           num_shift_bits_(num_shift_bits), max_error_(max_error), radix_table_(std::move(radix_table)),
-           spline_points_(std::move(spline_points)) {}
+           num_shift_bits_(num_shift_bits), max_error_(max_error), radix_table_(std::move(radix_table)) {
+         Precompute(spline_points);
+      }
 
       // Returns the estimated position of `key`.
       double GetEstimatedPosition(const KeyType key) const {
@@ -32,17 +38,41 @@ namespace rs {
 
          // Find spline segment with `key` ∈ (spline[index - 1], spline[index]].
          const size_t index = GetSplineSegment(key);
-         const Coord<KeyType> down = spline_points_[index - 1];
-         const Coord<KeyType> up = spline_points_[index];
-
-         // Compute slope.
-         const double x_diff = up.x - down.x;
-         const double y_diff = up.y - down.y;
-         const double slope = y_diff / x_diff;
+         return Interpolate(index - 1, key);
+      }
 
-         // Interpolate.
-         const double key_diff = key - down.x;
-         return std::fma(key_diff, slope, down.y);
+      // Estimates the positions of `n` keys, i.e., out[i] = GetEstimatedPosition(keys[i]).
+      // Radix table entries and spline keys of a whole batch of keys are
+      // prefetched before the first key is searched, i.e., their cache misses
+      // overlap instead of being serialized.
+      void GetEstimatedPositions(const KeyType* keys, double* out, const size_t n) const {
+         constexpr size_t BatchSize = 32;
+         std::array<KeyType, BatchSize> prefixes;
+         std::array<uint32_t, BatchSize> begins, ends;
+
+         for (size_t i = 0; i < n; i += BatchSize) {
+            const size_t batch_size = std::min(BatchSize, n - i);
+
+            for (size_t j = 0; j < batch_size; j++) {
+               prefixes[j] = GetPrefix(std::clamp(keys[i + j], min_key_, max_key_));
+               __builtin_prefetch(radix_table_.data() + prefixes[j]);
+            }
+            for (size_t j = 0; j < batch_size; j++) {
+               begins[j] = radix_table_[prefixes[j]];
+               ends[j] = radix_table_[prefixes[j] + 1];
+               __builtin_prefetch(spline_keys_.data() + begins[j]);
+               __builtin_prefetch(segments_.data() + begins[j]);
+            }
+            for (size_t j = 0; j < batch_size; j++) {
+               const KeyType key = keys[i + j];
+               if (key <= min_key_)
+                  out[i + j] = 0;
+               else if (key >= max_key_)
+                  out[i + j] = num_keys_ - 1;
+               else
+                  out[i + j] = Interpolate(SearchSplineSegment(key, begins[j], ends[j]) - 1, key);
+            }
+         }
       }
 
       // Returns a search bound [begin, end) around the estimated position.
@@ -56,31 +86,136 @@ namespace rs {
 
       // Returns the size in bytes.
       size_t GetSize() const {
-         return sizeof(*this) + radix_table_.size() * sizeof(uint32_t) + spline_points_.size() * sizeof(Coord<KeyType>);
+         return sizeof(*this) + radix_table_.size() * sizeof(uint32_t) + spline_keys_.size() * sizeof(KeyType) +
+            segments_.size() * sizeof(Segment);
+      }
+
+      // Returns the number of spline points.
+      size_t GetNumSplinePoints() const {
+         return segments_.size();
       }
 
      protected:
+      // Amount of spline keys compared at once by CountLess(), i.e., one SIMD register
+#if defined(__AVX512F__)
+      static constexpr size_t ScanWidth = 64 / sizeof(KeyType);
+#elif defined(__AVX2__)
+      static constexpr size_t ScanWidth = 32 / sizeof(KeyType);
+#elif defined(__SSE4_2__)
+      static constexpr size_t ScanWidth = 16 / sizeof(KeyType);
+#else
+      static constexpr size_t ScanWidth = 4;
+#endif
+
+      KeyType GetPrefix(const KeyType key) const {
+         return (key - min_key_) >> num_shift_bits_;
+      }
+
       // Returns the index of the spline point that marks the end of the spline
       // segment that contains the `key`: `key` ∈ (spline[index - 1], spline[index]]
       size_t GetSplineSegment(const KeyType key) const {
          // Narrow search range using radix table.
-         const KeyType prefix = (key - min_key_) >> num_shift_bits_;
+         const KeyType prefix = GetPrefix(key);
          assert(prefix + 1 < radix_table_.size());
-         const uint32_t begin = radix_table_[prefix];
-         const uint32_t end = radix_table_[prefix + 1];
-
-         if (end - begin < 32) {
-            // Do linear search over narrowed range.
-            uint32_t current = begin;
-            while (spline_points_[current].x < key)
-               ++current;
-            return current;
+         return SearchSplineSegment(key, radix_table_[prefix], radix_table_[prefix + 1]);
+      }
+
+      // Returns the index of the first spline point in [begin, end] that is not
+      // less than `key`, assuming min_key_ < key < max_key_.
+      size_t SearchSplineSegment(const KeyType key, const uint32_t begin, const uint32_t end) const {
+         // No spline point shares the prefix of `key`, i.e., spline[begin] is the first one past `key`
+         if (begin == end)
+            return begin;
+
+         // Narrow search range to at most ScanWidth keys using branchless binary search.
+         const KeyType* base = spline_keys_.data() + begin;
+         size_t length = end - begin;
+         while (length > ScanWidth) {
+            const size_t half = length / 2;
+            base = (base[half] < key) ? base + half : base;
+            length -= half;
          }
 
-         // Do binary search over narrowed range.
-         const auto lb = std::lower_bound(spline_points_.begin() + begin, spline_points_.begin() + end, key,
-                                          [](const Coord<KeyType>& coord, const KeyType key) { return coord.x < key; });
-         return std::distance(spline_points_.begin(), lb);
+         // Count keys less than `key` in register sized chunks. Keys past `end`
+         // have a larger prefix than `key` and max_key_ (or padding) terminates
+         // the scan, i.e., the scan needs no bounds check.
+         size_t index = base - spline_keys_.data();
+         for (;;) {
+            const size_t count = CountLess(spline_keys_.data() + index, key);
+            index += count;
+            if (count < ScanWidth)
+               return index;
+         }
+      }
+
+      // Returns how many of keys[0, ScanWidth) are less than `key`.
+      static size_t CountLess(const KeyType* keys, const KeyType key) {
+#if defined(__AVX512F__)
+         if constexpr (sizeof(KeyType) == 8)
+            return std::popcount(_mm512_cmplt_epu64_mask(_mm512_loadu_si512(keys),
+                                                         _mm512_set1_epi64(static_cast<long long>(key))));
+         else if constexpr (sizeof(KeyType) == 4)
+            return std::popcount(
+               _mm512_cmplt_epu32_mask(_mm512_loadu_si512(keys), _mm512_set1_epi32(static_cast<int>(key))));
+#elif defined(__AVX2__)
+         // AVX2 only compares signed integers. Flipping the sign bit maps unsigned onto signed order
+         if constexpr (sizeof(KeyType) == 8) {
+            const auto sign = _mm256_set1_epi64x(std::numeric_limits<long long>::min());
+            const auto v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys)), sign);
+            const auto k = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(key)), sign);
+            const auto less = _mm256_castsi256_pd(_mm256_cmpgt_epi64(k, v));
+            return std::popcount(static_cast<uint32_t>(_mm256_movemask_pd(less)));
+         } else if constexpr (sizeof(KeyType) == 4) {
+            const auto sign = _mm256_set1_epi32(std::numeric_limits<int>::min());
+            const auto v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys)), sign);
+            const auto k = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(key)), sign);
+            const auto less = _mm256_castsi256_ps(_mm256_cmpgt_epi32(k, v));
+            return std::popcount(static_cast<uint32_t>(_mm256_movemask_ps(less)));
+         }
+#elif defined(__SSE4_2__)
+         // see AVX2
+         if constexpr (sizeof(KeyType) == 8) {
+            const auto sign = _mm_set1_epi64x(std::numeric_limits<long long>::min());
+            const auto v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys)), sign);
+            const auto k = _mm_xor_si128(_mm_set1_epi64x(static_cast<long long>(key)), sign);
+            return std::popcount(static_cast<uint32_t>(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(k, v)))));
+         } else if constexpr (sizeof(KeyType) == 4) {
+            const auto sign = _mm_set1_epi32(std::numeric_limits<int>::min());
+            const auto v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys)), sign);
+            const auto k = _mm_xor_si128(_mm_set1_epi32(static_cast<int>(key)), sign);
+            return std::popcount(static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(k, v)))));
+         }
+#endif
+         size_t count = 0;
+         for (size_t i = 0; i < ScanWidth; i++)
+            count += keys[i] < key;
+         return count;
+      }
+
+      // Interpolates the segment (spline[down], spline[down + 1]] at `key`.
+      double Interpolate(const size_t down, const KeyType key) const {
+         const double key_diff = key - spline_keys_[down];
+         return std::fma(key_diff, segments_[down].slope, segments_[down].y);
+      }
+
+      // Stores the spline points as struct of arrays: their keys, padded for
+      // register sized scans, and their positions together with the slope of
+      // the segment they start, i.e., lookups do not divide.
+      void Precompute(const std::vector<rs::Coord<KeyType>>& spline_points) {
+         spline_keys_.assign(spline_points.size() + ScanWidth, std::numeric_limits<KeyType>::max());
+         segments_.resize(spline_points.size());
+         for (size_t i = 0; i < spline_points.size(); ++i) {
+            spline_keys_[i] = spline_points[i].x;
+            segments_[i] = {spline_points[i].y, 0};
+            if (i + 1 == spline_points.size())
+               continue;
+
+            const Coord<KeyType> down = spline_points[i];
+            const Coord<KeyType> up = spline_points[i + 1];
+            const double x_diff = up.x - down.x;
+            const double y_diff = up.y - down.y;
+            segments_[i].slope = y_diff / x_diff;
+         }
       }
 
       KeyType min_key_;
@@ -91,7 +226,10 @@ namespace rs {
       size_t max_error_;
 
       std::vector<uint32_t> radix_table_;
-      std::vector<rs::Coord<KeyType>> spline_points_;
+
+      // Spline points, see Precompute()
+      std::vector<KeyType> spline_keys_;
+      std::vector<rs::Segment> segments_;
 
       template<typename>
       friend class Serializer;
@@ -33,13 +33,13 @@ class Serializer {
     }
 
     // Spline points.
-    const size_t spline_points_size = rs.spline_points_.size();
+    const size_t spline_points_size = rs.segments_.size();
     buffer.write(reinterpret_cast<const char*>(&spline_points_size),
                  sizeof(size_t));
-    for (size_t i = 0; i < rs.spline_points_.size(); ++i) {
-      buffer.write(reinterpret_cast<const char*>(&rs.spline_points_[i].x),
+    for (size_t i = 0; i < spline_points_size; ++i) {
+      buffer.write(reinterpret_cast<const char*>(&rs.spline_keys_[i]),
                    sizeof(KeyType));
-      buffer.write(reinterpret_cast<const char*>(&rs.spline_points_[i].y),
+      buffer.write(reinterpret_cast<const char*>(&rs.segments_[i].y),
                    sizeof(double));
     }
 
@@ -63,20 +63,22 @@ class Serializer {
     size_t radix_table_size;
     in.read(reinterpret_cast<char*>(&radix_table_size), sizeof(size_t));
     rs.radix_table_.resize(radix_table_size);
-    for (int i = 0; i < rs.radix_table_.size(); ++i) {
+    for (size_t i = 0; i < rs.radix_table_.size(); ++i) {
       in.read(reinterpret_cast<char*>(&rs.radix_table_[i]), sizeof(uint32_t));
     }
 
     // Spline points.
     size_t spline_points_size;
     in.read(reinterpret_cast<char*>(&spline_points_size), sizeof(size_t));
-    rs.spline_points_.resize(spline_points_size);
-    for (int i = 0; i < rs.spline_points_.size(); ++i) {
-      in.read(reinterpret_cast<char*>(&rs.spline_points_[i].x),
-              sizeof(KeyType));
-      in.read(reinterpret_cast<char*>(&rs.spline_points_[i].y), sizeof(double));
+    std::vector<Coord<KeyType>> spline_points(spline_points_size);
+    for (size_t i = 0; i < spline_points.size(); ++i) {
+      in.read(reinterpret_cast<char*>(&spline_points[i].x), sizeof(KeyType));
+      in.read(reinterpret_cast<char*>(&spline_points[i].y), sizeof(double));
     }
 
+    // Slopes are derived, not serialized.
+    rs.Precompute(spline_points);
+
     return rs;
   }
 };
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+#include <convenience.hpp>
+
+namespace Reduction {
+   /**
+    * Streams keys through hash_batch() and reduce_batch() and hands each
+    * resulting slot index to a consumer, e.g., a hashtable or histogram.
+    * Indices are computed BatchSize keys at a time and the memory the consumer
+    * will touch for the key Depth positions ahead is prefetched, i.e., the
+    * random access latency overlaps with hashing and consuming other keys
+    *
+    * @tparam Hashfn hash function
+    * @tparam Reducefn reducer mapping hashes to slot indices
+    * @tparam Depth prefetch distance in keys. 0 disables prefetching
+    * @tparam BatchSize amount of keys hashed and reduced at once
+    */
+   template<class Hashfn, class Reducefn, size_t Depth = 16, size_t BatchSize = 256>
+   struct HashPipeline {
+      static_assert(BatchSize > 0 && Depth <= BatchSize, "prefetch distance may not exceed the batch size");
+
+      explicit HashPipeline(const Reducefn reducefn, const Hashfn hashfn = Hashfn())
+         : hashfn(hashfn), reducefn(reducefn) {}
+
+      /**
+       * Calls consume(key, index) for every key in order
+       *
+       * @tparam Mode how consume() accesses the prefetched memory
+       * @param keys
+       * @param n amount of keys
+       * @param address index -> pointer to the memory consume() will access
+       * @param consume consumer, called with each key and its slot index
+       */
+      template<Cache::Mode Mode = Cache::READ, class T, class Address, class Consumer>
+      forceinline void stream(const T* keys, const size_t& n, const Address& address, const Consumer& consume) {
+         // indices of keys [consumed, hashed), stored from indices[0] on
+         size_t consumed = 0, hashed = compute(keys, n, 0, 0);
+         if constexpr (Depth > 0)
+            for (size_t j = 0; j < std::min(Depth, hashed); j++)
+               Cache::prefetch_address<Mode, Cache::HIGH>(address(indices[j]));
+
+         while (consumed < n) {
+            const auto buffered = hashed - consumed;
+            const auto cnt = std::min(BatchSize, buffered);
+            for (size_t j = 0; j < cnt; j++) {
+               if constexpr (Depth > 0)
+                  if (j + Depth < buffered)
+                     Cache::prefetch_address<Mode, Cache::HIGH>(address(indices[j + Depth]));
+               consume(keys[consumed + j], indices[j]);
+            }
+            consumed += cnt;
+
+            // keep the (already prefetched) indices of the next Depth keys and refill
+            std::copy(indices.begin() + cnt, indices.begin() + buffered, indices.begin());
+            hashed = compute(keys, n, hashed, buffered - cnt);
+         }
+      }
+
+     private:
+      Hashfn hashfn;
+      const Reducefn reducefn;
+      std::array<HASH_64, BatchSize + Depth> indices;
+
+      /**
+       * Computes indices for up to BatchSize keys starting at keys[hashed],
+       * stored behind the buffered indices still to be consumed
+       * @return amount of keys hashed in total
+       */
+      forceinline size_t compute(const auto* keys, const size_t& n, const size_t& hashed, const size_t& buffered) {
+         const auto cnt = std::min(indices.size() - buffered, n - hashed);
+         hash_batch(hashfn, keys + hashed, indices.data() + buffered, cnt);
+         reduce_batch(reducefn, indices.data() + buffered, indices.data() + buffered, cnt);
+         return hashed + cnt;
+      }
+   };
+} // namespace Reduction
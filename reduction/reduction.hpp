@@ -6,13 +6,14 @@
    #error "Your compiler is not supported"
 #endif
 
-// TODO(dominik): utilize this for batching!
-//#define LIBDIVIDE_SSE2
-//#define LIBDIVIDE_AVX2
-//#define LIBDIVIDE_AVX512
-//#define LIBDIVIDE_NEON
 #include <thirdparty/libdivide.h>
 
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
 #include <convenience.hpp>
 
 /**
@@ -21,6 +22,35 @@
  *
  */
 namespace Reduction {
+   /**
+    * Vectorized libdivide_u64_do(), i.e., hash / d in every lane for the divider
+    * libdivide generated for d. Implemented on top of Batch instead of using
+    * libdivide's vector API such that it works for every instruction set
+    * Batch::for_each_lane() dispatches to. Branches only depend on the divider,
+    * i.e., are uniform across lanes
+    */
+   template<class V>
+   forceinline V divide_lanes(const V& hash, const libdivide::libdivide_u64_t& denom) {
+      using namespace Batch;
+      if (denom.magic == 0)
+         return srl64(hash, denom.more);
+
+      const auto q = mulhi64(hash, set1<V>(denom.magic));
+      if (denom.more & libdivide::LIBDIVIDE_ADD_MARKER)
+         return srl64(add64(srli64<1>(sub64(hash, q)), q), denom.more & libdivide::LIBDIVIDE_64_SHIFT_MASK);
+      return srl64(q, denom.more);
+   }
+
+   /**
+    * Vectorized libdivide_u64_branchfree_do()
+    */
+   template<class V>
+   forceinline V divide_lanes(const V& hash, const libdivide::libdivide_u64_branchfree_t& denom) {
+      using namespace Batch;
+      const auto q = mulhi64(hash, set1<V>(denom.magic));
+      return srl64(add64(srli64<1>(sub64(hash, q)), q), denom.more);
+   }
+
    /**
     * NOOP reduction, i.e., doesn't do anything
     */
@@ -81,13 +111,28 @@ namespace Reduction {
       }
 
       forceinline T operator()(const T& hash) const {
-         // TODO(dominik): investigate SIMD batching opportunities (see libdivide include for different options)
-
          const auto div = hash / magic_div; // Operator overloading ensures this is not an actual division
          const auto remainder = hash - div * N;
          assert(remainder < N);
          return remainder;
       }
+
+      /**
+       * Reduces n hashes at once, see reduce_batch()
+       */
+      forceinline void reduce_batch(const HASH_64* in, HASH_64* out, const size_t& n) const
+         requires(sizeof(T) == 8)
+      {
+         Batch::for_each_lane(
+            in, out, n,
+            [&](auto hash) {
+               using namespace Batch;
+               using V = decltype(hash);
+               const auto div = divide_lanes(hash, magic_div.div.denom);
+               return sub64(hash, mullo64(div, set1<V>(N)));
+            },
+            *this);
+      }
    };
 
    template<typename T>
@@ -107,15 +152,100 @@ namespace Reduction {
       }
 
       forceinline T operator()(const T& hash) const {
-         // TODO(dominik): investigate SIMD batching opportunities (see libdivide include for different options)
-
          const auto div = hash / magic_div; // Operator overloading ensures this is not an actual division
          const auto remainder = hash - div * N;
          assert(remainder < N);
          return remainder;
       }
+
+      /**
+       * Reduces n hashes at once, see reduce_batch()
+       */
+      forceinline void reduce_batch(const HASH_64* in, HASH_64* out, const size_t& n) const
+         requires(sizeof(T) == 8)
+      {
+         Batch::for_each_lane(
+            in, out, n,
+            [&](auto hash) {
+               using namespace Batch;
+               using V = decltype(hash);
+               const auto div = divide_lanes(hash, magic_div.div.denom);
+               return sub64(hash, mullo64(div, set1<V>(N)));
+            },
+            *this);
+      }
    };
 
+   /**
+    * Direct remainder computation as proposed by Daniel Lemire:
+    * https://lemire.me/blog/2019/02/08/faster-remainders-when-the-divisor-is-a-constant-beating-compilers-and-libdivide/
+    *
+    * Precomputes M = ceil(2^(2w) / N) for w bit values. The remainder is obtained
+    * from the fractional part M * value (mod 2^(2w)) by a single multiplication
+    * with N, i.e., unlike FastModulo, no quotient is computed and subtracted.
+    *
+    * NOTE: for w = 64 this relies on 128 bit arithmetic, i.e., M * value
+    * requires three and the final multiplication two 64 bit multiplications.
+    *
+    * @tparam T should be one of HASH_32 or HASH_64
+    */
+   template<class T>
+   struct DirectFastMod {
+     private:
+      using Magic = std::conditional_t<sizeof(T) == 4, HASH_64, HASH_128>;
+
+      const Magic M;
+      const size_t N;
+
+     public:
+      explicit DirectFastMod(const size_t& num_buckets)
+         : M(static_cast<Magic>(~static_cast<Magic>(0)) / num_buckets + 1), N(num_buckets) {
+         assert(num_buckets > 0);
+         assert(sizeof(T) == 8 || num_buckets <= 0xFFFFFFFFLLU);
+      }
+
+      static std::string name() {
+         return "direct_fast_modulo" + std::to_string(sizeof(T) * 8);
+      }
+
+      forceinline T operator()(const T& hash) const {
+         const Magic lowbits = M * hash;
+
+         if constexpr (sizeof(T) == 4) {
+            return static_cast<T>((static_cast<HASH_128>(lowbits) * N) >> 64);
+         } else {
+            // upper 64 bits of the 192 bit product lowbits * N
+            const HASH_128 bottom_half = (lowbits & 0xFFFFFFFFFFFFFFFFLLU) * N;
+            const HASH_128 top_half = (lowbits >> 64) * N;
+            return static_cast<T>(((bottom_half >> 64) + top_half) >> 64);
+         }
+      }
+   };
+
+   /**
+    * Finds a divisor in [n, n * (1 + max_slack)] that is cheap to reduce by,
+    * i.e., a power of two (libdivide degrades to a shift) if there is one in
+    * range, otherwise the smallest divisor whose libdivide magic does not
+    * require the additional add & shift correction step. Similar to the divisor
+    * filtering in https://github.com/peterboncz/bloomfilter-bsd/blob/master/src/dtl/div.hpp
+    *
+    * @param n requested divisor, e.g., directory size
+    * @param max_slack how much larger than n the result may be, e.g., 0.01 for 1%
+    * @return cheap divisor >= n or n if there is none in range
+    */
+   inline size_t cheap_divisor(const size_t& n, const double& max_slack) {
+      const auto upper = static_cast<size_t>(static_cast<double>(n) * (1.0 + max_slack));
+
+      const size_t pow2 = n <= 1 ? 1 : (n > (1LLU << 63) ? 0 : 1LLU << (64 - __builtin_clzll(n - 1)));
+      if (pow2 >= n && pow2 <= upper)
+         return pow2;
+
+      for (size_t d = n; d <= upper; d++)
+         if ((libdivide::libdivide_u64_gen(d).more & libdivide::LIBDIVIDE_ADD_MARKER) == 0)
+            return d;
+      return n;
+   }
+
    /**
     * Multiply & Shift reduction as proposed by Daniel Lemire:
     * https://lemire.me/blog/2016/06/27/a-fast-alternative-to-the-modulo-reduction/
@@ -142,10 +272,125 @@ namespace Reduction {
 
       constexpr forceinline T operator()(const T& hash) const;
 
+      /**
+       * Reduces n hashes at once, see reduce_batch(). Like the scalar
+       * fastrange32, only the lower 32 bits of each hash are considered
+       */
+      forceinline void reduce_batch(const HASH_64* in, HASH_64* out, const size_t& n) const {
+         Batch::for_each_lane(
+            in, out, n,
+            [&](auto hash) {
+               using namespace Batch;
+               using V = decltype(hash);
+               if constexpr (sizeof(T) == 4)
+                  return srli64<32>(mul32(hash, set1<V>(N)));
+               else
+                  return mulhi64(hash, set1<V>(N));
+            },
+            [&](const HASH_64& hash) { return (*this)(static_cast<T>(hash)); });
+      }
+
      private:
       const size_t N;
    };
 
+   /**
+    * Masks the hash to its lower log2(N) bits, i.e., the cheapest possible
+    * reduction. Requires a power of two bucket count, e.g., tables that grow
+    * by doubling. Only uses the lower hash bits, which should therefore be of
+    * high quality
+    *
+    * @tparam T should be one of HASH_32 or HASH_64
+    */
+   template<class T>
+   struct PowerOfTwoMask {
+      explicit PowerOfTwoMask(const size_t& num_buckets) : mask(num_buckets - 1) {
+         if (num_buckets == 0 || (num_buckets & (num_buckets - 1)) != 0)
+            throw std::runtime_error("pow2_mask requires a power of two bucket count, got " +
+                                     std::to_string(num_buckets));
+      }
+
+      static std::string name() {
+         return "pow2_mask";
+      }
+
+      constexpr forceinline T operator()(const T& hash) const {
+         return hash & mask;
+      }
+
+      /**
+       * Reduces n hashes at once, see reduce_batch()
+       */
+      forceinline void reduce_batch(const HASH_64* in, HASH_64* out, const size_t& n) const {
+         Batch::for_each_lane(
+            in, out, n,
+            [&](auto hash) {
+               using namespace Batch;
+               using V = decltype(hash);
+               return and64(hash, set1<V>(mask));
+            },
+            [&](const HASH_64& hash) { return (*this)(static_cast<T>(hash)); });
+      }
+
+     private:
+      const size_t mask;
+   };
+
+   /**
+    * Modulo reduction by a bucket count N known at compile time. Compilers
+    * strength reduce the division, i.e., emit the multiply & shift sequence
+    * FastModulo computes at runtime with its constants folded into the
+    * instruction stream, or a single mask if N is a power of two
+    *
+    * @tparam T should be one of HASH_32 or HASH_64
+    * @tparam N bucket count
+    */
+   template<class T, size_t N>
+   struct ConstModulo {
+      static_assert(N > 0);
+
+      explicit ConstModulo(const size_t& num_buckets = N) {
+         if (num_buckets != N)
+            throw std::runtime_error(name() + " is fixed to " + std::to_string(N) + " buckets, got " +
+                                     std::to_string(num_buckets));
+      }
+
+      static std::string name() {
+         return "const_modulo";
+      }
+
+      constexpr forceinline T operator()(const T& hash) const {
+         return hash % N;
+      }
+   };
+
+   /**
+    * Fastrange by a bucket count N known at compile time, i.e., the
+    * multiplication is by a constant which becomes a shift if N is a power of two
+    *
+    * @tparam T should be one of HASH_32 or HASH_64
+    * @tparam N bucket count
+    */
+   template<class T, size_t N>
+   struct ConstFastrange {
+      explicit ConstFastrange(const size_t& num_buckets = N) {
+         if (num_buckets != N)
+            throw std::runtime_error(name() + " is fixed to " + std::to_string(N) + " buckets, got " +
+                                     std::to_string(num_buckets));
+      }
+
+      static std::string name() {
+         return "const_fastrange" + std::to_string(sizeof(T) * 8);
+      }
+
+      constexpr forceinline T operator()(const T& hash) const {
+         if constexpr (sizeof(T) == 4)
+            return static_cast<T>((static_cast<HASH_64>(hash) * N) >> 32);
+         else
+            return static_cast<T>((static_cast<HASH_128>(hash) * N) >> 64);
+      }
+   };
+
    template<typename T>
    struct Clamp {
       explicit Clamp(const size_t& num_buckets) : N(num_buckets) {}
@@ -340,6 +585,25 @@ namespace Reduction {
    }
 }; // namespace Reduction
 
+/**
+ * Reduces n hashes at once, i.e., out[i] = fn(in[i]). Uses the reducer's
+ * vectorized reduce_batch() if it has one and falls back to a scalar loop otherwise
+ *
+ * @param fn reducer
+ * @param in hashes
+ * @param out reduced values. May alias in
+ * @param n amount of hashes
+ */
+template<class Reducefn, class Out>
+forceinline void reduce_batch(const Reducefn& fn, const HASH_64* in, Out* out, const size_t& n) {
+   if constexpr (std::is_same_v<Out, HASH_64> && requires { fn.reduce_batch(in, out, n); }) {
+      fn.reduce_batch(in, out, n);
+   } else {
+      for (size_t i = 0; i < n; i++)
+         out[i] = static_cast<Out>(fn(in[i]));
+   }
+}
+
 template<>
 constexpr forceinline HASH_32 Reduction::Fastrange<HASH_32>::operator()(const HASH_32& value) const {
    return static_cast<HASH_32>((static_cast<uint64_t>(value) * static_cast<uint64_t>(N)) >> 32);
@@ -354,4 +618,6 @@ constexpr forceinline HASH_64 Reduction::Fastrange<HASH_64>::operator()(const HA
       "Fastrange fallback (actual modulo) active, since 128bit integer multiplication seems to be unsupported on this system/compiler"
    return value % n; // Fallback
 #endif
-}
\ No newline at end of file
+}
+
+#include "include/pipeline.hpp"
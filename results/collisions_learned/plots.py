@@ -96,6 +96,9 @@ for compiler in compilers:
 def plot_timing(key):
     for compiler in compilers:
         csv = pandas.read_csv(f'collisions_learned-{compiler}.csv')
+        # prepare_nanoseconds_* only exist in results measured before sampling moved ahead of the shuffle
+        if key not in csv:
+            continue
 
         for fig, dataset_name in enumerate(dataset_names):
             dataset = csv[csv['dataset'] == dataset_name]
@@ -44,6 +44,8 @@ for compiler in compilers:
         sample_sizes = list(reversed(sorted(list(set(dataset['sample_size'])))))
         plot_keys = ["sample_nanoseconds_per_key", "prepare_nanoseconds_per_key", "build_nanoseconds_per_key",
                      "hashing_nanoseconds_per_key"]
+        # prepare_nanoseconds_* only exist in results measured before sampling moved ahead of the shuffle
+        plot_keys = [key for key in plot_keys if key in csv]
 
         fig, subplts = plt.subplots(len(sample_sizes), len(plot_keys), sharey=True, sharex=True, figsize=(20, 15))
 
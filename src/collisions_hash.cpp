@@ -162,15 +162,18 @@ static void benchmark(const std::string& dataset_name, const std::shared_ptr<con
    measure64<SmallTabulationHash<Data>>(dataset_name, *dataset, collision_counter, outfile, iomutex);
    measure64<MediumTabulationHash<Data>>(dataset_name, *dataset, collision_counter, outfile, iomutex);
    measure64<LargeTabulationHash<Data>>(dataset_name, *dataset, collision_counter, outfile, iomutex);
+   measure64<TwistedTabulationHash<Data>>(dataset_name, *dataset, collision_counter, outfile, iomutex);
 
    measure64<CityHash64<Data>>(dataset_name, *dataset, collision_counter, outfile, iomutex);
    measure128<CityHash128<Data>>(dataset_name, *dataset, collision_counter, outfile, iomutex);
 
-   measure64<MeowHash64<Data, 0>>(dataset_name, *dataset, collision_counter, outfile, iomutex);
-   measure64<MeowHash64<Data, 1>>(dataset_name, *dataset, collision_counter, outfile, iomutex);
+   if (Cpu::has_aes()) {
+      measure64<MeowHash64<Data, 0>>(dataset_name, *dataset, collision_counter, outfile, iomutex);
+      measure64<MeowHash64<Data, 1>>(dataset_name, *dataset, collision_counter, outfile, iomutex);
 
-   measure64<AquaHash<Data, 0>>(dataset_name, *dataset, collision_counter, outfile, iomutex);
-   measure64<AquaHash<Data, 1>>(dataset_name, *dataset, collision_counter, outfile, iomutex);
+      measure64<AquaHash<Data, 0>>(dataset_name, *dataset, collision_counter, outfile, iomutex);
+      measure64<AquaHash<Data, 1>>(dataset_name, *dataset, collision_counter, outfile, iomutex);
+   }
 }
 
 void print_max_resource_usage(const Args& args) {
@@ -202,6 +205,8 @@ int main(int argc, char* argv[]) {
       auto args = Args(argc, argv);
 #ifdef VERBOSE
       print_max_resource_usage(args);
+      std::cout << "Vectorized kernels use " << Cpu::isa_name() << (Cpu::has_aes() ? "" : ", skipping aes hashes")
+                << std::endl;
 #endif
 
       CSV outfile(args.outfile, csv_columns);
@@ -14,6 +14,7 @@
 #include "include/benchmark.hpp"
 #include "include/csv.hpp"
 #include "include/random_hash.hpp"
+#include "include/sample.hpp"
 
 using Args = BenchmarkArgs::LearnedCollisionArgs;
 
@@ -23,6 +24,7 @@ const std::vector<std::string> csv_columns = {"dataset",
                                               "model",
                                               "reducer",
                                               "sample_size",
+                                              "model_bytes",
                                               "min",
                                               "max",
                                               "std_dev",
@@ -34,8 +36,6 @@ const std::vector<std::string> csv_columns = {"dataset",
                                               "total_colliding_keys_percent",
                                               "sample_nanoseconds_total",
                                               "sample_nanoseconds_per_key",
-                                              "prepare_nanoseconds_total",
-                                              "prepare_nanoseconds_per_key",
                                               "build_nanoseconds_total",
                                               "build_nanoseconds_per_key",
                                               "hashing_nanoseconds_total",
@@ -46,7 +46,7 @@ const std::vector<std::string> csv_columns = {"dataset",
 template<class Hashfn, class Reducerfn, class Data>
 static void measure(const std::string& dataset_name, const std::vector<Data>& dataset, const std::vector<Data>& sample,
                     const double& sample_size, std::vector<size_t>& collision_counter, const uint64_t& sample_ns,
-                    const uint64_t& prepare_ns, CSV& outfile, std::mutex& iomutex) {
+                    CSV& outfile, std::mutex& iomutex) {
    const size_t N = dataset.size();
    const auto load_factor = static_cast<long double>(N) / static_cast<long double>(collision_counter.size());
 
@@ -85,7 +85,7 @@ static void measure(const std::string& dataset_name, const std::vector<Data>& da
    const auto stats = Benchmark::measure_collisions<Hashfn, Reducerfn>(dataset, collision_counter, hashfn);
 
    // Sum up for easier access
-   const auto total_ns = sample_ns + prepare_ns + build_ns + stats.inference_reduction_memaccess_total_ns;
+   const auto total_ns = sample_ns + build_ns + stats.inference_reduction_memaccess_total_ns;
 
 #ifdef VERBOSE
    {
@@ -96,6 +96,7 @@ static void measure(const std::string& dataset_name, const std::vector<Data>& da
    };
 #endif
 
+   datapoint.emplace("model_bytes", str(hashfn.byte_size()));
    datapoint.emplace("min", str(stats.min));
    datapoint.emplace("max", str(stats.max));
    datapoint.emplace("std_dev", str(stats.std_dev));
@@ -107,8 +108,6 @@ static void measure(const std::string& dataset_name, const std::vector<Data>& da
    datapoint.emplace("total_colliding_keys_percent", str(relative_to(stats.total_colliding_keys, dataset.size())));
    datapoint.emplace("sample_nanoseconds_total", str(sample_ns));
    datapoint.emplace("sample_nanoseconds_per_key", str(relative_to(sample_ns, dataset.size())));
-   datapoint.emplace("prepare_nanoseconds_total", str(prepare_ns));
-   datapoint.emplace("prepare_nanoseconds_per_key", str(relative_to(prepare_ns, dataset.size())));
    datapoint.emplace("build_nanoseconds_total", str(build_ns));
    datapoint.emplace("build_nanoseconds_per_key", str(relative_to(build_ns, dataset.size())));
    datapoint.emplace("hashing_nanoseconds_total", str(stats.inference_reduction_memaccess_total_ns));
@@ -121,140 +120,145 @@ static void measure(const std::string& dataset_name, const std::vector<Data>& da
    outfile.write(datapoint);
 }
 
+/**
+ * @param sample sorted sample, drawn from the sorted dataset in sample_ns. There is no separate prepare (sort) phase
+ *    anymore, hence no prepare_nanoseconds_* columns
+ */
 template<class Data>
 static void benchmark(const std::string& dataset_name, const std::vector<Data>& dataset, const double load_factor,
-                      const double sample_chance, CSV& outfile, std::mutex& iomutex) {
-   uint64_t sample_ns = 0, prepare_ns = 0;
-
+                      const double sample_chance, const std::vector<Data>& sample, const uint64_t sample_ns,
+                      CSV& outfile, std::mutex& iomutex) {
    // Theoretical slot count of a hashtable on which we want to measure collisions
    const auto hashtable_size =
       static_cast<uint64_t>(static_cast<double>(dataset.size()) / static_cast<double>(load_factor));
    std::vector<size_t> collision_counter(hashtable_size);
 
-   // Take a random sample
-   std::vector<uint64_t> sample;
-   {
-      auto start_time = std::chrono::steady_clock::now();
-      if (sample_chance == 1.0) {
-         sample = dataset;
-      } else {
-         sample.reserve(sample_chance * dataset.size());
-         std::random_device seed_gen;
-         std::default_random_engine gen(seed_gen());
-         std::uniform_real_distribution<double> dist(0, 1);
-
-         for (size_t i = 0; i < dataset.size(); i++)
-            if (dist(gen) < sample_chance)
-               sample.push_back(dataset[i]);
-      }
-      sample_ns = static_cast<uint64_t>(
-         std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count());
-   }
-
-   // Prepare the sample
-   {
-      auto start_time = std::chrono::steady_clock::now();
-      std::sort(sample.begin(), sample.end());
-      prepare_ns = static_cast<uint64_t>(
-         std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count());
-   }
 
    //  /// RMI
    //  measure<rmi::RMIHash<Data, 10>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-   //                                                            collision_counter, sample_ns, prepare_ns, outfile,
+   //                                                            collision_counter, sample_ns, outfile,
    //                                                            iomutex);
    //  measure<rmi::RMIHash<Data, 100>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-   //                                                             collision_counter, sample_ns, prepare_ns, outfile,
+   //                                                             collision_counter, sample_ns, outfile,
    //                                                             iomutex);
    //  measure<rmi::RMIHash<Data, 1000>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-   //                                                              collision_counter, sample_ns, prepare_ns, outfile,
+   //                                                              collision_counter, sample_ns, outfile,
    //                                                              iomutex);
    //  measure<rmi::RMIHash<Data, 10000>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-   //                                                               collision_counter, sample_ns, prepare_ns, outfile,
+   //                                                               collision_counter, sample_ns, outfile,
    //                                                               iomutex);
    //  measure<rmi::RMIHash<Data, 100000>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-   //                                                                collision_counter, sample_ns, prepare_ns, outfile,
+   //                                                                collision_counter, sample_ns, outfile,
    //                                                                iomutex);
    //  measure<rmi::RMIHash<Data, 1000000>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-   //                                                                 collision_counter, sample_ns, prepare_ns, outfile,
+   //                                                                 collision_counter, sample_ns, outfile,
    //                                                                 iomutex);
    //  measure<rmi::RMIHash<Data, 10000000>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-   //                                                                  collision_counter, sample_ns, prepare_ns, outfile,
+   //                                                                  collision_counter, sample_ns, outfile,
    //                                                                  iomutex);
 
+   /// RMI second level training variants
+   measure<rmi::RMIHash<Data, 100000>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
+                                                                 collision_counter, sample_ns, outfile, iomutex);
+   measure<rmi::RMIHash<Data, 100000, rmi::LinearImpl<Data, double>, rmi::LeastSquaresImpl<Data, double>>,
+           Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, collision_counter, sample_ns,
+                                     outfile, iomutex);
+   measure<rmi::RMIHash<Data, 100000, rmi::LinearImpl<Data, double>, rmi::MonotoneLeastSquaresImpl<Data, double>>,
+           Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, collision_counter, sample_ns,
+                                     outfile, iomutex);
+
+   /// RMI with quantized second level models
+   measure<rmi::QuantizedRMIHash<Data, 100000, 16>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample,
+                                                                              sample_chance, collision_counter,
+                                                                              sample_ns, outfile, iomutex);
+   measure<rmi::QuantizedRMIHash<Data, 100000, 32>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample,
+                                                                              sample_chance, collision_counter,
+                                                                              sample_ns, outfile, iomutex);
+
+   /// RMI topologies
+   measure<rmi::RMI<Data, rmi::Layers<rmi::LinearImpl, rmi::LinearImpl, rmi::LinearImpl>, rmi::Sizes<1, 1024, 1 << 20>>,
+           Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, collision_counter, sample_ns,
+                                     outfile, iomutex);
+   measure<rmi::RMI<Data, rmi::Layers<rmi::CubicImpl, rmi::LinearImpl>, rmi::Sizes<1, 1 << 20>>,
+           Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, collision_counter, sample_ns,
+                                     outfile, iomutex);
+   measure<rmi::RMI<Data, rmi::Layers<rmi::RadixImpl, rmi::LinearImpl>, rmi::Sizes<1, 1 << 20>>,
+           Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, collision_counter, sample_ns,
+                                     outfile, iomutex);
+
    //  /// RadixSpline
    measure<rs::RadixSplineHash<Data, 8, 140>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                         collision_counter, sample_ns, prepare_ns,
-                                                                         outfile, iomutex);
+                                                                         collision_counter, sample_ns, outfile,
+                                                                         iomutex);
    measure<rs::RadixSplineHash<Data, 10, 90>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                         collision_counter, sample_ns, prepare_ns,
-                                                                         outfile, iomutex);
+                                                                         collision_counter, sample_ns, outfile,
+                                                                         iomutex);
    measure<rs::RadixSplineHash<Data, 26, 7>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                         collision_counter, sample_ns, prepare_ns,
-                                                                         outfile, iomutex);
+                                                                         collision_counter, sample_ns, outfile,
+                                                                         iomutex);
    //  measure<rs::RadixSplineHash<Data, 20, 160>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-   //                                                                        collision_counter, sample_ns, prepare_ns,
+   //                                                                        collision_counter, sample_ns,
    //                                                                        outfile, iomutex);
    //  measure<rs::RadixSplineHash<Data, 20, 80>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-   //                                                                       collision_counter, sample_ns, prepare_ns,
+   //                                                                       collision_counter, sample_ns,
    //                                                                       outfile, iomutex);
    //  measure<rs::RadixSplineHash<Data, 24, 40>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-   //                                                                       collision_counter, sample_ns, prepare_ns,
+   //                                                                       collision_counter, sample_ns,
    //                                                                       outfile, iomutex);
    //  measure<rs::RadixSplineHash<Data, 18, 32>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-   //                                                                       collision_counter, sample_ns, prepare_ns,
+   //                                                                       collision_counter, sample_ns,
    //                                                                       outfile, iomutex);
    //  measure<rs::RadixSplineHash<Data, 24, 20>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-   //                                                                       collision_counter, sample_ns, prepare_ns,
+   //                                                                       collision_counter, sample_ns,
    //                                                                       outfile, iomutex);
    //  measure<rs::RadixSplineHash<Data, 26, 8>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-   //                                                                      collision_counter, sample_ns, prepare_ns,
+   //                                                                      collision_counter, sample_ns,
    //                                                                      outfile, iomutex);
    //  measure<rs::RadixSplineHash<Data, 26, 3>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-   //                                                                      collision_counter, sample_ns, prepare_ns,
+   //                                                                      collision_counter, sample_ns,
    //                                                                      outfile, iomutex);
    //  measure<rs::RadixSplineHash<Data, 28, 2>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-   //                                                                      collision_counter, sample_ns, prepare_ns,
+   //                                                                      collision_counter, sample_ns,
    //                                                                      outfile, iomutex);
    //  measure<rs::RadixSplineHash<Data, 28, 1>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-   //                                                                      collision_counter, sample_ns, prepare_ns,
+   //                                                                      collision_counter, sample_ns,
    //                                                                      outfile, iomutex);
 
    /// PGM (eps_rec 4)
    measure<PGMHash<Data, 256, 4>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                            collision_counter, sample_ns, prepare_ns, outfile, iomutex);
+                                                            collision_counter, sample_ns, outfile, iomutex);
    measure<PGMHash<Data, 128, 4>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                            collision_counter, sample_ns, prepare_ns, outfile, iomutex);
+                                                            collision_counter, sample_ns, outfile, iomutex);
    measure<PGMHash<Data, 64, 4>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                           collision_counter, sample_ns, prepare_ns, outfile, iomutex);
+                                                           collision_counter, sample_ns, outfile, iomutex);
    measure<PGMHash<Data, 16, 4>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                           collision_counter, sample_ns, prepare_ns, outfile, iomutex);
+                                                           collision_counter, sample_ns, outfile, iomutex);
    measure<PGMHash<Data, 4, 4>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                          collision_counter, sample_ns, prepare_ns, outfile, iomutex);
+                                                          collision_counter, sample_ns, outfile, iomutex);
 
    /// PGM (eps_rec 1)
    measure<PGMHash<Data, 256, 1>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                            collision_counter, sample_ns, prepare_ns, outfile, iomutex);
+                                                            collision_counter, sample_ns, outfile, iomutex);
    measure<PGMHash<Data, 128, 1>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                            collision_counter, sample_ns, prepare_ns, outfile, iomutex);
+                                                            collision_counter, sample_ns, outfile, iomutex);
    measure<PGMHash<Data, 64, 1>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                           collision_counter, sample_ns, prepare_ns, outfile, iomutex);
+                                                           collision_counter, sample_ns, outfile, iomutex);
    measure<PGMHash<Data, 16, 1>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                           collision_counter, sample_ns, prepare_ns, outfile, iomutex);
+                                                           collision_counter, sample_ns, outfile, iomutex);
    measure<PGMHash<Data, 4, 1>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                          collision_counter, sample_ns, prepare_ns, outfile, iomutex);
+                                                          collision_counter, sample_ns, outfile, iomutex);
 
    // PGM (eps_rec 0)
    measure<PGMHash<Data, 256, 0>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                            collision_counter, sample_ns, prepare_ns, outfile, iomutex);
+                                                            collision_counter, sample_ns, outfile, iomutex);
    measure<PGMHash<Data, 128, 0>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                            collision_counter, sample_ns, prepare_ns, outfile, iomutex);
+                                                            collision_counter, sample_ns, outfile, iomutex);
    measure<PGMHash<Data, 64, 0>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                           collision_counter, sample_ns, prepare_ns, outfile, iomutex);
+                                                           collision_counter, sample_ns, outfile, iomutex);
    measure<PGMHash<Data, 16, 0>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                           collision_counter, sample_ns, prepare_ns, outfile, iomutex);
+                                                           collision_counter, sample_ns, outfile, iomutex);
    measure<PGMHash<Data, 4, 0>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                          collision_counter, sample_ns, prepare_ns, outfile, iomutex);
+                                                          collision_counter, sample_ns, outfile, iomutex);
 }
 
 int main(int argc, char* argv[]) {
@@ -304,13 +308,28 @@ int main(int argc, char* argv[]) {
       for (const auto& it : args.datasets) {
          // TODO: once we are on a NUMA machine, we should maybe load the dataset per thread (prevent cache conflicts)
          //  and purely operate on thread local data. i.e. move this load into threads after aquire()
-         const auto dataset_ptr = std::make_shared<const std::vector<uint64_t>>(it.load(iomutex));
+         // Draw every sample while the dataset is sorted, i.e., samples need no sorting
+         std::map<double, std::shared_ptr<const std::vector<uint64_t>>> samples;
+         std::map<double, uint64_t> sample_ns;
+         const auto dataset_ptr =
+            std::make_shared<const std::vector<uint64_t>>(it.load(iomutex, [&](const std::vector<uint64_t>& sorted) {
+               for (const auto sample_size : args.sample_sizes) {
+                  const auto start_time = std::chrono::steady_clock::now();
+                  samples[sample_size] =
+                     std::make_shared<const std::vector<uint64_t>>(Sampling::bernoulli(sorted, sample_size));
+                  sample_ns[sample_size] = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                                    std::chrono::steady_clock::now() - start_time)
+                                                                    .count());
+               }
+            }));
 
          for (const auto load_factor : args.load_factors) {
             for (const auto sample_size : args.sample_sizes) {
-               threads.emplace_back(std::thread([&, dataset_ptr, load_factor, sample_size] {
+               const auto sample_ptr = samples[sample_size];
+               const auto ns = sample_ns[sample_size];
+               threads.emplace_back(std::thread([&, dataset_ptr, sample_ptr, ns, load_factor, sample_size] {
                   cpu_blocker.aquire();
-                  benchmark(it.name(), *dataset_ptr, load_factor, sample_size, outfile, iomutex);
+                  benchmark(it.name(), *dataset_ptr, load_factor, sample_size, *sample_ptr, ns, outfile, iomutex);
                   cpu_blocker.release();
                }));
             }
@@ -0,0 +1,287 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+
+#include <convenience.hpp>
+#include <learned_models.hpp>
+
+#include "include/args.hpp"
+#include "include/csv.hpp"
+#include "include/sample.hpp"
+
+using Args = BenchmarkArgs::DriftLearnedArgs;
+
+const std::vector<std::string> csv_columns = {
+   // General statistics
+   "dataset", "numelements", "load_factor", "sample_size", "drift_fraction", "model", "retraining", "epoch",
+
+   // State after the epoch
+   "inserted_keys", "empty_slots", "empty_slots_percent", "colliding_keys", "colliding_keys_percent", "model_bytes",
+
+   // Cost of the epoch
+   "insert_nanoseconds_total", "insert_nanoseconds_per_key", "retrain_nanoseconds_total", "retrain_count",
+   "rehashed_slots"
+
+   //
+};
+
+/// Amount of epochs the drifting key stream is inserted in, i.e., measurements per run
+static constexpr size_t EpochCount = 10;
+
+/**
+ * Drifting key stream: keys at ranks [drift_begin, drift_end) of the sorted
+ * dataset are "new", i.e., not part of the initial distribution, and arrive
+ * increasingly often over time (arrival time density 2t), while all other
+ * keys arrive uniformly over time
+ */
+template<class Data>
+struct DriftingStream {
+   std::vector<Data> initial_sample;
+   std::vector<Data> keys;
+   double sample_size;
+
+   DriftingStream(const std::vector<Data>& sorted, const double drift_fraction, const double sample_size)
+      : sample_size(sample_size) {
+      const auto drift_begin = static_cast<size_t>(static_cast<double>(sorted.size()) * (0.5 - drift_fraction / 2));
+      const auto drift_end = static_cast<size_t>(static_cast<double>(sorted.size()) * (0.5 + drift_fraction / 2));
+
+      // Models are initially trained on a sample of the old keys only
+      std::vector<Data> old_keys;
+      old_keys.reserve(sorted.size() - (drift_end - drift_begin));
+      old_keys.insert(old_keys.end(), sorted.begin(), sorted.begin() + drift_begin);
+      old_keys.insert(old_keys.end(), sorted.begin() + drift_end, sorted.end());
+      initial_sample = Sampling::bernoulli(old_keys, sample_size);
+
+      std::mt19937_64 gen(std::random_device{}());
+      std::uniform_real_distribution<double> dist(0, 1);
+      std::vector<std::pair<double, Data>> arrivals(sorted.size());
+      for (size_t i = 0; i < sorted.size(); i++) {
+         const auto t = dist(gen);
+         arrivals[i] = {i >= drift_begin && i < drift_end ? std::sqrt(t) : t, sorted[i]};
+      }
+      std::sort(arrivals.begin(), arrivals.end());
+
+      keys.resize(arrivals.size());
+      for (size_t i = 0; i < arrivals.size(); i++)
+         keys[i] = arrivals[i].second;
+   }
+
+   size_t epoch_begin(const size_t epoch) const {
+      return epoch * keys.size() / EpochCount;
+   }
+};
+
+/**
+ * Counts keys per slot, i.e., models a hashtable whose chain length is
+ * the amount of keys hashed to a slot
+ */
+struct SlotCounter {
+   std::vector<uint32_t> counter;
+
+   explicit SlotCounter(const size_t slot_count) : counter(slot_count, 0) {}
+
+   /// inserts a key into slot and returns the slot's chain length
+   forceinline uint32_t insert(const size_t slot) {
+      return ++counter[std::min(slot, counter.size() - 1)];
+   }
+
+   /// rehashes all keys inserted so far with hashfn, e.g., after the hash function was retrained
+   template<class Hashfn, class Data>
+   void rehash(const Hashfn& hashfn, const std::vector<Data>& keys, const size_t key_count) {
+      std::fill(counter.begin(), counter.end(), 0);
+      for (size_t i = 0; i < key_count; i++)
+         insert(hashfn(keys[i]));
+   }
+
+   size_t empty_slots() const {
+      return static_cast<size_t>(std::count(counter.begin(), counter.end(), 0));
+   }
+};
+
+static uint64_t ns_since(const std::chrono::steady_clock::time_point& start_time) {
+   return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count());
+}
+
+template<class Hashfn, class Data>
+static void measure(const std::string& dataset_name, const DriftingStream<Data>& stream, const double load_factor,
+                    const double drift_fraction, CSV& outfile, std::mutex& iomutex) {
+   const auto str = [](auto s) { return std::to_string(s); };
+   const auto slot_count = static_cast<size_t>(static_cast<double>(stream.keys.size()) / load_factor);
+   const auto full_size = slot_count - 1;
+
+   const auto record = [&](const std::string& retraining, const size_t epoch, const SlotCounter& counter,
+                           const size_t model_bytes, const uint64_t insert_ns, const uint64_t retrain_ns,
+                           const size_t retrain_count, const size_t rehashed_slots) {
+      const auto inserted = stream.epoch_begin(epoch + 1);
+      const auto epoch_keys = inserted - stream.epoch_begin(epoch);
+      const auto empty_slots = counter.empty_slots();
+      // every key that does not occupy a slot on its own collides
+      const auto colliding_keys = inserted - (slot_count - empty_slots);
+
+      std::map<std::string, std::string> datapoint({{"dataset", dataset_name},
+                                                    {"numelements", str(stream.keys.size())},
+                                                    {"load_factor", str(load_factor)},
+                                                    {"sample_size", str(stream.sample_size)},
+                                                    {"drift_fraction", str(drift_fraction)},
+                                                    {"model", Hashfn::name()},
+                                                    {"retraining", retraining},
+                                                    {"epoch", str(epoch)}});
+      datapoint.emplace("inserted_keys", str(inserted));
+      datapoint.emplace("empty_slots", str(empty_slots));
+      datapoint.emplace("empty_slots_percent", str(relative_to(empty_slots, slot_count)));
+      datapoint.emplace("colliding_keys", str(colliding_keys));
+      datapoint.emplace("colliding_keys_percent", str(relative_to(colliding_keys, inserted)));
+      datapoint.emplace("model_bytes", str(model_bytes));
+      datapoint.emplace("insert_nanoseconds_total", str(insert_ns));
+      datapoint.emplace("insert_nanoseconds_per_key", str(relative_to(insert_ns, epoch_keys)));
+      datapoint.emplace("retrain_nanoseconds_total", str(retrain_ns));
+      datapoint.emplace("retrain_count", str(retrain_count));
+      datapoint.emplace("rehashed_slots", str(rehashed_slots));
+      outfile.write(datapoint);
+
+#ifdef VERBOSE
+      std::unique_lock<std::mutex> lock(iomutex);
+      std::cout << std::setw(55) << std::right << Hashfn::name() + " (" + retraining + ") epoch " + str(epoch) + ": "
+                << relative_to(colliding_keys, inserted) * 100 << "% colliding keys, "
+                << relative_to(insert_ns, epoch_keys) << " ns/insert, " << nanoseconds_to_seconds(retrain_ns)
+                << " s retraining" << std::endl;
+#endif
+   };
+
+   // Static: trained once on the initial sample
+   {
+      const Hashfn hashfn(stream.initial_sample.begin(), stream.initial_sample.end(), full_size);
+      SlotCounter counter(slot_count);
+      for (size_t epoch = 0; epoch < EpochCount; epoch++) {
+         const auto start_time = std::chrono::steady_clock::now();
+         for (size_t i = stream.epoch_begin(epoch); i < stream.epoch_begin(epoch + 1); i++)
+            counter.insert(hashfn(stream.keys[i]));
+         const auto insert_ns = ns_since(start_time);
+
+         record("static", epoch, counter, hashfn.byte_size(), insert_ns, 0, 0, 0);
+      }
+   }
+
+   // Incremental: overflowing segments are retrained in the background, the
+   // table rehashes retrained slot ranges after each epoch
+   {
+      learned::IncrementalHash<Data, Hashfn> hashfn(stream.initial_sample.begin(), stream.initial_sample.end(),
+                                                    full_size, stream.sample_size);
+      SlotCounter counter(slot_count);
+      auto previous = hashfn.statistics();
+      for (size_t epoch = 0; epoch < EpochCount; epoch++) {
+         const auto start_time = std::chrono::steady_clock::now();
+         for (size_t i = stream.epoch_begin(epoch); i < stream.epoch_begin(epoch + 1); i++) {
+            const auto& key = stream.keys[i];
+            const auto slot = hashfn(key);
+            hashfn.feedback(key, slot, counter.insert(slot));
+         }
+         hashfn.sync();
+         const auto insert_ns = ns_since(start_time);
+
+         size_t rehashed_slots = 0;
+         for (const auto& range : hashfn.take_retrained())
+            rehashed_slots += range.end - range.begin;
+         if (rehashed_slots > 0)
+            counter.rehash(hashfn, stream.keys, stream.epoch_begin(epoch + 1));
+         // No lookups run between epochs
+         hashfn.reclaim();
+
+         const auto stats = hashfn.statistics();
+         record("incremental", epoch, counter, hashfn.byte_size(), insert_ns,
+                stats.retrain_nanoseconds - previous.retrain_nanoseconds, stats.retrain_count - previous.retrain_count,
+                rehashed_slots);
+         previous = stats;
+      }
+   }
+
+   // Full: retrained from scratch after each epoch on a sample of all keys inserted so far, which is as large as
+   // the initial sample, i.e., retraining models is as accurate and expensive as training them initially
+   {
+      std::optional<Hashfn> hashfn;
+      hashfn.emplace(stream.initial_sample.begin(), stream.initial_sample.end(), full_size);
+      SlotCounter counter(slot_count);
+      for (size_t epoch = 0; epoch < EpochCount; epoch++) {
+         auto start_time = std::chrono::steady_clock::now();
+         for (size_t i = stream.epoch_begin(epoch); i < stream.epoch_begin(epoch + 1); i++)
+            counter.insert((*hashfn)(stream.keys[i]));
+         const auto insert_ns = ns_since(start_time);
+
+         start_time = std::chrono::steady_clock::now();
+         const std::vector<Data> inserted(stream.keys.begin(), stream.keys.begin() + stream.epoch_begin(epoch + 1));
+         const auto sample_rate = std::min(stream.sample_size * static_cast<double>(stream.keys.size()) /
+                                              static_cast<double>(inserted.size()),
+                                           1.0);
+         const auto sample = Sampling::sorted_sample(inserted, sample_rate);
+         hashfn.emplace(sample.begin(), sample.end(), full_size);
+         const auto retrain_ns = ns_since(start_time);
+         counter.rehash(*hashfn, stream.keys, inserted.size());
+
+         record("full", epoch, counter, hashfn->byte_size(), insert_ns, retrain_ns, 1, slot_count);
+      }
+   }
+}
+
+template<class Data>
+static void benchmark(const std::string& dataset_name, const DriftingStream<Data>& stream, const double load_factor,
+                      const double drift_fraction, CSV& outfile, std::mutex& iomutex) {
+   measure<rmi::RMIHash<Data, 100000>>(dataset_name, stream, load_factor, drift_fraction, outfile, iomutex);
+   measure<rmi::RMIHash<Data, 1000000>>(dataset_name, stream, load_factor, drift_fraction, outfile, iomutex);
+   measure<PGMHash<Data, 64, 4>>(dataset_name, stream, load_factor, drift_fraction, outfile, iomutex);
+   measure<PGMHash<Data, 16, 4>>(dataset_name, stream, load_factor, drift_fraction, outfile, iomutex);
+}
+
+int main(int argc, char* argv[]) {
+   try {
+      auto args = Args(argc, argv);
+
+      CSV outfile(args.outfile, csv_columns);
+
+      // Worker pool for speeding up the benchmarking
+      std::mutex iomutex;
+      std_ext::counting_semaphore cpu_blocker(args.max_threads);
+      std::vector<std::thread> threads{};
+
+      for (const auto& it : args.datasets) {
+         // Streams are built from the sorted dataset, i.e., the shuffled copy is not needed
+         std::vector<std::shared_ptr<const DriftingStream<uint64_t>>> streams;
+         std::vector<std::pair<double, double>> stream_params;
+         it.load(iomutex, [&](const std::vector<uint64_t>& sorted) {
+            for (const auto drift_fraction : args.drift_fractions)
+               for (const auto sample_size : args.sample_sizes) {
+                  streams.push_back(
+                     std::make_shared<const DriftingStream<uint64_t>>(sorted, drift_fraction, sample_size));
+                  stream_params.emplace_back(drift_fraction, sample_size);
+               }
+         });
+
+         for (size_t s = 0; s < streams.size(); s++)
+            for (const auto load_factor : args.load_factors) {
+               const auto stream = streams[s];
+               const auto drift_fraction = stream_params[s].first;
+               threads.emplace_back(std::thread([&, stream, drift_fraction, load_factor] {
+                  cpu_blocker.aquire();
+                  benchmark(it.name(), *stream, load_factor, drift_fraction, outfile, iomutex);
+                  cpu_blocker.release();
+               }));
+            }
+      }
+      for (auto& t : threads)
+         t.join();
+   } catch (const std::exception& ex) {
+      std::cerr << ex.what() << std::endl;
+      return -1;
+   }
+
+   return 0;
+}
@@ -0,0 +1,193 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <convenience.hpp>
+#include <filter.hpp>
+#include <hashtable.hpp>
+
+#include "include/args.hpp"
+#include "include/benchmark.hpp"
+#include "include/csv.hpp"
+#include "include/functors/hash_functors.hpp"
+
+using Args = BenchmarkArgs::HashFilterArgs;
+
+const std::vector<std::string> csv_columns = {
+   "dataset",
+   "numelements",
+   "numqueries",
+   "load_factor",
+   "filter",
+   "hash",
+   "reducer",
+   "bytes",
+   "bits_per_key",
+   "failed_inserts",
+   "insert_nanoseconds_total",
+   "insert_nanoseconds_per_key",
+   "positive_lookup_nanoseconds_total",
+   "positive_lookup_nanoseconds_per_key",
+   "negative_lookup_nanoseconds_total",
+   "negative_lookup_nanoseconds_per_key",
+   "false_positive_rate",
+   "erase_nanoseconds_total",
+   "erase_nanoseconds_per_key",
+   "num_runs",
+};
+
+template<class Filter, class Data>
+static void measure(const std::string& dataset_name, const std::vector<Data>& members,
+                    const std::vector<Data>& nonmembers, const double load_factor, CSV& outfile,
+                    std::mutex& iomutex) {
+   const auto str = [](auto s) { return std::to_string(s); };
+   std::map<std::string, std::string> datapoint({{"dataset", dataset_name},
+                                                 {"numelements", str(members.size())},
+                                                 {"numqueries", str(nonmembers.size())},
+                                                 {"load_factor", str(load_factor)},
+                                                 {"filter", Filter::name()},
+                                                 {"hash", Filter::hash_name()},
+                                                 {"reducer", Filter::reducer_name()}});
+
+   if (outfile.exists(datapoint)) {
+      std::unique_lock<std::mutex> lock(iomutex);
+      std::cout << "Skipping (";
+      auto iter = datapoint.begin();
+      while (iter != datapoint.end()) {
+         std::cout << iter->first << ": " << iter->second;
+
+         iter++;
+         if (iter != datapoint.end())
+            std::cout << ", ";
+      }
+      std::cout << ") since it already exist" << std::endl;
+      return;
+   }
+
+   try {
+      const auto capacity = static_cast<uint64_t>(static_cast<double>(members.size()) / load_factor);
+      Filter filter(capacity);
+
+      const auto stats = Benchmark::measure_filter(members, nonmembers, filter);
+      const auto fpr = nonmembers.empty()
+         ? 0.0
+         : static_cast<double>(stats.false_positives) / static_cast<double>(nonmembers.size());
+
+#ifdef VERBOSE
+      {
+         std::unique_lock<std::mutex> lock(iomutex);
+         std::cout << std::setw(55) << std::right
+                   << Filter::name() + "<" + Filter::reducer_name() + "(" + Filter::hash_name() + ")> insert took "
+                   << relative_to(stats.total_insert_ns, members.size()) << " ns/key, lookup took "
+                   << relative_to(stats.avg_total_positive_lookup_ns, members.size()) << " ns/key (positive) "
+                   << relative_to(stats.avg_total_negative_lookup_ns, nonmembers.size())
+                   << " ns/key (negative), false positive rate " << fpr << std::endl;
+      };
+#endif
+
+      datapoint.emplace("bytes", str(filter.byte_size()));
+      datapoint.emplace("bits_per_key",
+                        str(members.empty() ? 0.0
+                                            : static_cast<double>(filter.byte_size() * 8) /
+                                               static_cast<double>(members.size())));
+      datapoint.emplace("failed_inserts", str(stats.failed_inserts));
+      datapoint.emplace("insert_nanoseconds_total", str(stats.total_insert_ns));
+      datapoint.emplace("insert_nanoseconds_per_key", str(relative_to(stats.total_insert_ns, members.size())));
+      datapoint.emplace("positive_lookup_nanoseconds_total", str(stats.avg_total_positive_lookup_ns));
+      datapoint.emplace("positive_lookup_nanoseconds_per_key",
+                        str(relative_to(stats.avg_total_positive_lookup_ns, members.size())));
+      datapoint.emplace("negative_lookup_nanoseconds_total", str(stats.avg_total_negative_lookup_ns));
+      datapoint.emplace("negative_lookup_nanoseconds_per_key",
+                        str(relative_to(stats.avg_total_negative_lookup_ns, nonmembers.size())));
+      datapoint.emplace("false_positive_rate", str(fpr));
+      datapoint.emplace("erase_nanoseconds_total", str(stats.total_erase_ns));
+      datapoint.emplace("erase_nanoseconds_per_key", str(relative_to(stats.total_erase_ns, members.size())));
+      datapoint.emplace("num_runs", str(stats.lookup_repeats));
+   } catch (const std::exception& e) {
+      std::unique_lock<std::mutex> lock(iomutex);
+      std::cout << std::setw(55) << std::right
+                << Filter::reducer_name() + "(" + Filter::hash_name() + ") failed: " << e.what() << std::endl;
+   }
+
+   outfile.write(datapoint);
+}
+
+template<class Hashfn, class Data>
+static void measure_filters(const std::string& dataset_name, const std::vector<Data>& members,
+                            const std::vector<Data>& nonmembers, const double load_factor, CSV& outfile,
+                            std::mutex& iomutex) {
+   using namespace Reduction;
+
+   measure<Filter::Cuckoo<Data, 12, Hashfn, FastModulo<HASH_64>, Hashtable::BalancedKicking>>(
+      dataset_name, members, nonmembers, load_factor, outfile, iomutex);
+   measure<Filter::Cuckoo<Data, 16, Hashfn, FastModulo<HASH_64>, Hashtable::BalancedKicking>>(
+      dataset_name, members, nonmembers, load_factor, outfile, iomutex);
+   measure<Filter::Cuckoo<Data, 12, Hashfn, FastModulo<HASH_64>, Hashtable::BiasedKicking<10>>>(
+      dataset_name, members, nonmembers, load_factor, outfile, iomutex);
+   measure<Filter::Cuckoo<Data, 16, Hashfn, FastModulo<HASH_64>, Hashtable::BiasedKicking<10>>>(
+      dataset_name, members, nonmembers, load_factor, outfile, iomutex);
+
+   measure<Filter::Quotient<Data, 8, Hashfn, FastModulo<HASH_64>>>(dataset_name, members, nonmembers, load_factor,
+                                                                     outfile, iomutex);
+   measure<Filter::Quotient<Data, 16, Hashfn, FastModulo<HASH_64>>>(dataset_name, members, nonmembers, load_factor,
+                                                                      outfile, iomutex);
+}
+
+template<class Data>
+static void benchmark(const std::string& dataset_name, const std::vector<Data>& members,
+                      const std::vector<Data>& nonmembers, const std::vector<double>& load_factors, CSV& outfile,
+                      std::mutex& iomutex) {
+   for (const auto load_factor : load_factors) {
+      if (Cpu::has_aes())
+         measure_filters<AquaHash<Data>>(dataset_name, members, nonmembers, load_factor, outfile, iomutex);
+      measure_filters<LargeTabulationHash<Data>>(dataset_name, members, nonmembers, load_factor, outfile, iomutex);
+      measure_filters<MurmurFinalizer<Data>>(dataset_name, members, nonmembers, load_factor, outfile, iomutex);
+      measure_filters<PrimeMultiplicationHash64>(dataset_name, members, nonmembers, load_factor, outfile, iomutex);
+      measure_filters<MultAddHash64>(dataset_name, members, nonmembers, load_factor, outfile, iomutex);
+      measure_filters<FibonacciHash64>(dataset_name, members, nonmembers, load_factor, outfile, iomutex);
+      measure_filters<XXHash3<Data>>(dataset_name, members, nonmembers, load_factor, outfile, iomutex);
+   }
+}
+
+int main(int argc, char* argv[]) {
+   try {
+      auto args = Args(argc, argv);
+
+      CSV outfile(args.outfile, csv_columns);
+
+      // Worker pool for speeding up the benchmarking
+      std::mutex iomutex;
+      std_ext::counting_semaphore cpu_blocker(args.max_threads);
+      std::vector<std::thread> threads{};
+
+      for (const auto& it : args.datasets) {
+         threads.emplace_back(std::thread([&, it] {
+            cpu_blocker.aquire();
+
+            // Datasets are deduplicated and shuffled on load, i.e., we may simply
+            // use one half as members and the other half as guaranteed non-members
+            auto members = it.load(iomutex);
+            std::vector<uint64_t> nonmembers(members.begin() + members.size() / 2, members.end());
+            members.resize(members.size() / 2);
+            members.shrink_to_fit();
+
+            benchmark(it.name(), members, nonmembers, args.load_factors, outfile, iomutex);
+
+            cpu_blocker.release();
+         }));
+      }
+
+      for (auto& t : threads) {
+         t.join();
+      }
+      threads.clear();
+   } catch (const std::exception& ex) {
+      std::cerr << ex.what() << std::endl;
+      return -1;
+   }
+
+   return 0;
+}
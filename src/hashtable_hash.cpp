@@ -20,10 +20,10 @@ const std::vector<std::string> csv_columns = {
    "dataset", "numelements", "load_factor", "bucket_size", "hashtable", "hash", "reducer", "payload",
    "insert_nanoseconds_total", "insert_nanoseconds_per_key", "avg_lookup_nanoseconds_total",
    "avg_lookup_nanoseconds_per_key", "median_lookup_nanoseconds_total", "median_lookup_nanoseconds_per_key",
-   "unsuccessful_lookup_percent", "num_runs",
+   "unsuccessful_lookup_percent", "capacity_slack_percent", "num_runs", "lookup_l1d_misses_per_key",
 
    // Cuckoo custom statistics
-   "primary_key_ratio",
+   "primary_key_ratio", "rehash_count",
 
    // Chained custom statistics
    "empty_buckets", "min_chain_length", "max_chain_length", "additional_buckets", "empty_additional_slots",
@@ -58,12 +58,22 @@ struct Payload64 {
    }
 } packed;
 
+/// Sets use buckets spanning exactly one cache line, i.e., 8 64-bit or 16 32-bit
+/// keys, which are compared with a single SIMD instruction
+template<class Data>
+static constexpr size_t SetBucketSize = 64 / sizeof(Data);
+
 static const auto UNSUCCESSFUL_0_PERCENT = 0;
 static const auto UNSUCCESSFUL_25_PERCENT = std::numeric_limits<uint32_t>::max() / 4;
 static const auto UNSUCCESSFUL_50_PERCENT = UNSUCCESSFUL_25_PERCENT * 2;
 static const auto UNSUCCESSFUL_75_PERCENT = UNSUCCESSFUL_25_PERCENT * 3;
 
-template<class Hashtable, const uint32_t UnsuccessfulLookupPercent = UNSUCCESSFUL_0_PERCENT, class Data>
+/**
+ * @tparam CapacitySlackPercent if > 0, capacity may be rounded up by this many
+ *    percent to obtain a directory size that is cheap to reduce by, see Hashtable::cheap_capacity()
+ */
+template<class Hashtable, const uint32_t UnsuccessfulLookupPercent = UNSUCCESSFUL_0_PERCENT,
+         const uint32_t CapacitySlackPercent = 0, class Data>
 static void measure(const std::string& dataset_name, const std::vector<Data>& dataset, const double load_factor,
                     CSV& outfile, std::mutex& iomutex) {
    const auto str = [](auto s) { return std::to_string(s); };
@@ -73,11 +83,12 @@ static void measure(const std::string& dataset_name, const std::vector<Data>& da
        {"load_factor", str(load_factor)},
        {"bucket_size", str(Hashtable::bucket_size())},
        {"hashtable", Hashtable::name()},
-       {"payload", str(sizeof(typename Hashtable::PayloadType))},
+       {"payload", str(::Hashtable::payload_byte_size<typename Hashtable::PayloadType>())},
        {"hash", Hashtable::hash_name()},
        {"reducer", Hashtable::reducer_name()},
        {"unsuccessful_lookup_percent",
-        str(relative_to(UnsuccessfulLookupPercent, std::numeric_limits<uint32_t>::max()))}});
+        str(relative_to(UnsuccessfulLookupPercent, std::numeric_limits<uint32_t>::max()))},
+       {"capacity_slack_percent", str(CapacitySlackPercent)}});
 
    if (outfile.exists(datapoint)) {
       std::unique_lock<std::mutex> lock(iomutex);
@@ -97,8 +108,10 @@ static void measure(const std::string& dataset_name, const std::vector<Data>& da
    try {
       // Theoretical slot count of a hashtable on which we want to measure collisions
       const double unsuccessful_perc = relative_to(UnsuccessfulLookupPercent, std::numeric_limits<uint32_t>::max());
-      const auto ht_capacity = static_cast<uint64_t>(static_cast<double>(dataset.size()) * (1 - unsuccessful_perc) /
-                                                     static_cast<double>(load_factor));
+      auto ht_capacity = static_cast<uint64_t>(static_cast<double>(dataset.size()) * (1 - unsuccessful_perc) /
+                                               static_cast<double>(load_factor));
+      if constexpr (CapacitySlackPercent > 0)
+         ht_capacity = ::Hashtable::cheap_capacity<Hashtable>(ht_capacity, CapacitySlackPercent / 100.0);
 
       Hashtable hashtable(ht_capacity);
 
@@ -125,6 +138,9 @@ static void measure(const std::string& dataset_name, const std::vector<Data>& da
       datapoint.emplace("median_lookup_nanoseconds_per_key",
                         str(relative_to(stats.median_total_lookup_ns, dataset.size())));
       datapoint.emplace("num_runs", str(stats.lookup_repeats));
+      if (stats.avg_lookup_l1d_misses.has_value())
+         datapoint.emplace("lookup_l1d_misses_per_key",
+                           str(relative_to(stats.avg_lookup_l1d_misses.value(), dataset.size())));
 
       // Make sure we collect more insight based on hashtable
       for (const auto& stat : hashtable.lookup_statistics(dataset)) {
@@ -155,6 +171,9 @@ static void measure_chained(const std::string& dataset_name, const std::vector<D
    //                                                                                     outfile, iomutex);
    //   measure<Hashtable::Chained<Data, Payload16<Data>, 4, Hashfn, Fastrange<HASH_64>>>(dataset_name, dataset, load_factor,
    //                                                                                     outfile, iomutex);
+   measure<Hashtable::Chained<Data, Payload16<Data>, 4, Hashfn, FastModulo<HASH_64>, std::numeric_limits<Data>::max(),
+                              Hashtable::SlotOccupancy::Bitmap>>(dataset_name, dataset, load_factor, outfile,
+                                                                 iomutex);
    measure<Hashtable::Chained<Data, Payload16<Data>, 4, Hashfn, FastModulo<HASH_64>>>(dataset_name, dataset,
                                                                                       load_factor, outfile, iomutex);
 
@@ -171,6 +190,10 @@ static void measure_chained(const std::string& dataset_name, const std::vector<D
    //                                                                                     outfile, iomutex);
    measure<Hashtable::Chained<Data, Payload64<Data>, 4, Hashfn, FastModulo<HASH_64>>>(dataset_name, dataset,
                                                                                       load_factor, outfile, iomutex);
+
+   /// Sets (keys only)
+   measure<Hashtable::Chained<Data, void, SetBucketSize<Data>, Hashfn, FastModulo<HASH_64>>>(
+      dataset_name, dataset, load_factor, outfile, iomutex);
 }
 
 template<class Hashfn, const uint32_t UnsuccessfulLookupPercent = UNSUCCESSFUL_0_PERCENT, class Data>
@@ -192,6 +215,27 @@ static void measure_probing(const std::string& dataset_name, const std::vector<D
    measure<Hashtable::Probing<Data, Payload64<Data>, Hashfn, FastModulo<HASH_64>, Hashtable::LinearProbingFunc>,
            UnsuccessfulLookupPercent>(dataset_name, dataset, load_factor, outfile, iomutex);
 
+   /// Direct remainder computation & cheap divisors (capacity may grow by up to 1%)
+   measure<Hashtable::Probing<Data, Payload16<Data>, Hashfn, DirectFastMod<HASH_64>, Hashtable::LinearProbingFunc>,
+           UnsuccessfulLookupPercent>(dataset_name, dataset, load_factor, outfile, iomutex);
+   measure<Hashtable::Probing<Data, Payload16<Data>, Hashfn, FastModulo<HASH_64>, Hashtable::LinearProbingFunc>,
+           UnsuccessfulLookupPercent, 1>(dataset_name, dataset, load_factor, outfile, iomutex);
+
+   /// Occupancy bitmap instead of sentinel key, i.e., full key domain
+   measure<Hashtable::Probing<Data, Payload16<Data>, Hashfn, FastModulo<HASH_64>, Hashtable::LinearProbingFunc, 1,
+                              std::numeric_limits<Data>::max(), Hashtable::SlotOccupancy::Bitmap>,
+           UnsuccessfulLookupPercent>(dataset_name, dataset, load_factor, outfile, iomutex);
+   measure<Hashtable::Probing<Data, Payload16<Data>, Hashfn, FastModulo<HASH_64>, Hashtable::LinearProbingFunc, 4,
+                              std::numeric_limits<Data>::max(), Hashtable::SlotOccupancy::Bitmap>,
+           UnsuccessfulLookupPercent>(dataset_name, dataset, load_factor, outfile, iomutex);
+
+   /// Sets (keys only)
+   measure<Hashtable::Probing<Data, void, Hashfn, FastModulo<HASH_64>, Hashtable::LinearProbingFunc>,
+           UnsuccessfulLookupPercent>(dataset_name, dataset, load_factor, outfile, iomutex);
+   measure<
+      Hashtable::Probing<Data, void, Hashfn, FastModulo<HASH_64>, Hashtable::LinearProbingFunc, SetBucketSize<Data>>,
+      UnsuccessfulLookupPercent>(dataset_name, dataset, load_factor, outfile, iomutex);
+
    //   measure<Hashtable::Probing<Data, Payload16<Data>, Hashfn, Fastrange<HASH_32>, Hashtable::QuadraticProbingFunc>, UnsuccessfulLookupPercent>(
    //      dataset_name, dataset, load_factor, outfile, iomutex);
    //   measure<Hashtable::Probing<Data, Payload16<Data>, Hashfn, Fastrange<HASH_64>, Hashtable::QuadraticProbingFunc>, UnsuccessfulLookupPercent>(
@@ -224,6 +268,9 @@ static void measure_probing(const std::string& dataset_name, const std::vector<D
    measure<
       Hashtable::RobinhoodProbing<Data, Payload64<Data>, Hashfn, FastModulo<HASH_64>, Hashtable::LinearProbingFunc>,
       UnsuccessfulLookupPercent>(dataset_name, dataset, load_factor, outfile, iomutex);
+   measure<Hashtable::RobinhoodProbing<Data, Payload16<Data>, Hashfn, FastModulo<HASH_64>, Hashtable::LinearProbingFunc,
+                                       1, std::numeric_limits<Data>::max(), Hashtable::SlotOccupancy::Bitmap>,
+           UnsuccessfulLookupPercent>(dataset_name, dataset, load_factor, outfile, iomutex);
 
    //   measure<
    //      Hashtable::RobinhoodProbing<Data, Payload16<Data>, Hashfn, Fastrange<HASH_32>, Hashtable::QuadraticProbingFunc>, UnsuccessfulLookupPercent>(
@@ -263,6 +310,18 @@ static void measure_cuckoo(const std::string& dataset_name, const std::vector<Da
                              Hashtable::BalancedKicking>>(dataset_name, dataset, load_factor, outfile, iomutex);
    measure<Hashtable::Cuckoo<Data, Payload64<Data>, 8, Hashfn1, Hashfn2, FastModulo<HASH_64>, FastModulo<HASH_64>,
                              Hashtable::BalancedKicking>>(dataset_name, dataset, load_factor, outfile, iomutex);
+   measure<Hashtable::Cuckoo<Data, Payload16<Data>, 8, Hashfn1, Hashfn2, FastModulo<HASH_64>, FastModulo<HASH_64>,
+                             Hashtable::BalancedKicking, std::numeric_limits<Data>::max(),
+                             Hashtable::SlotOccupancy::Bitmap>>(dataset_name, dataset, load_factor, outfile, iomutex);
+   measure<Hashtable::Cuckoo<Data, void, SetBucketSize<Data>, Hashfn1, Hashfn2, FastModulo<HASH_64>,
+                             FastModulo<HASH_64>, Hashtable::BalancedKicking>>(dataset_name, dataset, load_factor,
+                                                                               outfile, iomutex);
+   measure<Hashtable::Cuckoo<Data, Payload16<Data>, 8, Hashfn1, Hashfn2, DirectFastMod<HASH_64>,
+                             DirectFastMod<HASH_64>, Hashtable::BalancedKicking>>(dataset_name, dataset, load_factor,
+                                                                                  outfile, iomutex);
+   measure<Hashtable::Cuckoo<Data, Payload16<Data>, 8, Hashfn1, Hashfn2, FastModulo<HASH_64>, FastModulo<HASH_64>,
+                             Hashtable::BalancedKicking>,
+           UNSUCCESSFUL_0_PERCENT, 1>(dataset_name, dataset, load_factor, outfile, iomutex);
 
    /// Unbiased kicking (place in primary bucket first & always kick from primary bucket)
    //   measure<Hashtable::Cuckoo<Data, Payload16<Data>, 8, Hashfn1, Hashfn2, Fastrange<HASH_32>, Fastrange<HASH_32>,
@@ -293,6 +352,42 @@ static void measure_cuckoo(const std::string& dataset_name, const std::vector<Da
                              Hashtable::BiasedKicking<10>>>(dataset_name, dataset, load_factor, outfile, iomutex);
 }
 
+/**
+ * Probing and cuckoo tables on 128-bit keys, e.g., (tenant_id, object_id) pairs.
+ * Set buckets compare all their keys with a single SIMD instruction
+ */
+template<class Hashfn, class Data>
+static void measure_wide(const std::string& dataset_name, const std::vector<Data>& dataset, const double load_factor,
+                         CSV& outfile, std::mutex& iomutex) {
+   using namespace Reduction;
+
+   measure<Hashtable::Probing<Data, Payload16<Data>, Hashfn, FastModulo<HASH_64>, Hashtable::LinearProbingFunc>>(
+      dataset_name, dataset, load_factor, outfile, iomutex);
+   measure<Hashtable::Probing<Data, Payload16<Data>, Hashfn, FastModulo<HASH_64>, Hashtable::LinearProbingFunc, 4,
+                              std::numeric_limits<Data>::max(), Hashtable::SlotOccupancy::Bitmap>>(
+      dataset_name, dataset, load_factor, outfile, iomutex);
+   measure<
+      Hashtable::Probing<Data, void, Hashfn, FastModulo<HASH_64>, Hashtable::LinearProbingFunc, SetBucketSize<Data>>>(
+      dataset_name, dataset, load_factor, outfile, iomutex);
+
+   measure<Hashtable::Cuckoo<Data, Payload16<Data>, 8, Hashfn, DoubleHashingCuckoo2Func, FastModulo<HASH_64>,
+                             FastModulo<HASH_64>, Hashtable::BalancedKicking>>(dataset_name, dataset, load_factor,
+                                                                               outfile, iomutex);
+   measure<Hashtable::Cuckoo<Data, void, SetBucketSize<Data>, Hashfn, DoubleHashingCuckoo2Func, FastModulo<HASH_64>,
+                             FastModulo<HASH_64>, Hashtable::BalancedKicking>>(dataset_name, dataset, load_factor,
+                                                                               outfile, iomutex);
+}
+
+static void benchmark_wide(const std::string& dataset_name, const std::vector<HASH_128>& dataset, CSV& outfile,
+                           std::mutex& iomutex) {
+   for (const auto load_factor : {0.8, 0.95}) {
+      if (Cpu::has_aes())
+         measure_wide<AquaHash<HASH_128>>(dataset_name, dataset, load_factor, outfile, iomutex);
+      measure_wide<MurmurFinalizer<HASH_128>>(dataset_name, dataset, load_factor, outfile, iomutex);
+      measure_wide<XXHash3<HASH_128>>(dataset_name, dataset, load_factor, outfile, iomutex);
+   }
+}
+
 template<class Data>
 static void benchmark(const std::string& dataset_name, const std::vector<Data>& dataset, CSV& outfile,
                       std::mutex& iomutex) {
@@ -300,7 +395,8 @@ static void benchmark(const std::string& dataset_name, const std::vector<Data>&
 
    /// Chained
    for (const auto load_factor : {1.}) {
-      measure_chained<AquaHash<Data>>(dataset_name, dataset, load_factor, outfile, iomutex);
+      if (Cpu::has_aes())
+         measure_chained<AquaHash<Data>>(dataset_name, dataset, load_factor, outfile, iomutex);
       //   measure_chained<MeowHash64<Data>>(dataset_name, dataset, load_factor, outfile, iomutex);
       //   measure_chained<CityHash64<Data>>(dataset_name, dataset, load_factor, outfile, iomutex);
       measure_chained<LargeTabulationHash<Data>>(dataset_name, dataset, load_factor, outfile, iomutex);
@@ -313,11 +409,19 @@ static void benchmark(const std::string& dataset_name, const std::vector<Data>&
 
    /// Cuckoo
    for (const auto load_factor : {0.98, 0.95}) {
-      measure_cuckoo<AquaHash<Data>, Murmur3FinalizerCuckoo2Func>(dataset_name, dataset, load_factor, outfile, iomutex);
+      if (Cpu::has_aes())
+         measure_cuckoo<AquaHash<Data>, Murmur3FinalizerCuckoo2Func>(dataset_name, dataset, load_factor, outfile,
+                                                                     iomutex);
       //   measure_cuckoo<MeowHash64<Data>>(dataset_name, dataset, load_factor, outfile, iomutex);
       //   measure_cuckoo<CityHash64<Data>>(dataset_name, dataset, load_factor, outfile, iomutex);
       measure_cuckoo<LargeTabulationHash<Data>, Murmur3FinalizerCuckoo2Func>(dataset_name, dataset, load_factor,
                                                                              outfile, iomutex);
+      measure_cuckoo<TwistedTabulationHash<Data>, Murmur3FinalizerCuckoo2Func>(dataset_name, dataset, load_factor,
+                                                                               outfile, iomutex);
+      measure_cuckoo<MultiplyShiftFamily<Data>, DoubleHashingCuckoo2Func>(dataset_name, dataset, load_factor, outfile,
+                                                                          iomutex);
+      measure_cuckoo<XXHash3Family<Data>, DoubleHashingCuckoo2Func>(dataset_name, dataset, load_factor, outfile,
+                                                                    iomutex);
       measure_cuckoo<MurmurFinalizer<Data>, Murmur3FinalizerCuckoo2Func>(dataset_name, dataset, load_factor, outfile,
                                                                          iomutex);
       measure_cuckoo<PrimeMultiplicationHash64, Murmur3FinalizerCuckoo2Func>(dataset_name, dataset, load_factor,
@@ -428,8 +532,17 @@ int main(int argc, char* argv[]) {
       std::mutex iomutex;
 
       for (const auto& it : args.datasets) {
-         const auto dataset = it.load(iomutex);
-         benchmark(it.name(), dataset, outfile, iomutex);
+         // 4 byte datasets are benchmarked on true 32-bit key layouts
+         if (it.bytesPerValue == 4) {
+            const auto dataset = it.load_as<uint32_t>(iomutex);
+            benchmark(it.name(), dataset, outfile, iomutex);
+         } else if (it.bytesPerValue == 16) {
+            const auto dataset = it.load_as<HASH_128>(iomutex);
+            benchmark_wide(it.name(), dataset, outfile, iomutex);
+         } else {
+            const auto dataset = it.load(iomutex);
+            benchmark(it.name(), dataset, outfile, iomutex);
+         }
       }
    } catch (const std::exception& ex) {
       std::cerr << ex.what() << std::endl;
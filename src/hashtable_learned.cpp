@@ -13,6 +13,7 @@
 #include "include/args.hpp"
 #include "include/benchmark.hpp"
 #include "include/csv.hpp"
+#include "include/sample.hpp"
 #include "include/functors/hash_functors.hpp"
 
 using Args = BenchmarkArgs::LearnedHashtableArgs;
@@ -76,7 +77,7 @@ static void measure(const std::string& dataset_name, const std::vector<Data>& da
        {"sample_size", str(sample_size)},
        {"bucket_size", str(Hashtable::bucket_size())},
        {"hashtable", Hashtable::name()},
-       {"payload", str(sizeof(typename Hashtable::PayloadType))},
+       {"payload", str(::Hashtable::payload_byte_size<typename Hashtable::PayloadType>())},
        {"model", Hashtable::hash_name()},
        {"reducer", Hashtable::reducer_name()},
        {"unsuccessful_lookup_percent",
@@ -237,24 +238,8 @@ template<class Data>
 static void benchmark(const std::string& dataset_name, const std::vector<Data>& dataset, CSV& outfile,
                       std::mutex& iomutex) {
    for (double sample_chance : {0.01, 1.0}) {
-      // Take a random sample
-      std::vector<uint64_t> sample;
-      {
-         if (sample_chance == 1.0) {
-            sample = dataset;
-         } else {
-            sample.reserve(sample_chance * dataset.size());
-            std::random_device seed_gen;
-            std::default_random_engine gen(seed_gen());
-            std::uniform_real_distribution<double> dist(0, 1);
-
-            for (size_t i = 0; i < dataset.size(); i++)
-               if (dist(gen) < sample_chance)
-                  sample.push_back(dataset[i]);
-         }
-      }
-      // Sort the sample
-      std::sort(sample.begin(), sample.end());
+      // Take a sorted random sample
+      const auto sample = Sampling::sorted_sample(dataset, sample_chance, std::thread::hardware_concurrency());
 
       /// Chained
       for (const auto load_factor : {1.}) {
@@ -283,24 +268,8 @@ static void benchmark(const std::string& dataset_name, const std::vector<Data>&
    }
 
    for (double sample_chance : {0.01, 1.0}) {
-      // Take a random sample
-      std::vector<uint64_t> sample;
-      {
-         if (sample_chance == 1.0) {
-            sample = dataset;
-         } else {
-            sample.reserve(sample_chance * dataset.size());
-            std::random_device seed_gen;
-            std::default_random_engine gen(seed_gen());
-            std::uniform_real_distribution<double> dist(0, 1);
-
-            for (size_t i = 0; i < dataset.size(); i++)
-               if (dist(gen) < sample_chance)
-                  sample.push_back(dataset[i]);
-         }
-      }
-      // Sort the sample
-      std::sort(sample.begin(), sample.end());
+      // Take a sorted random sample
+      const auto sample = Sampling::sorted_sample(dataset, sample_chance, std::thread::hardware_concurrency());
 
       /// Cuckoo
       for (const auto load_factor : {0.98, 0.95}) {
@@ -408,8 +377,14 @@ int main(int argc, char* argv[]) {
       std::mutex iomutex;
 
       for (const auto& it : args.datasets) {
-         const auto dataset = it.load(iomutex);
-         benchmark(it.name(), dataset, outfile, iomutex);
+         // 4 byte datasets are benchmarked on true 32-bit key layouts
+         if (it.bytesPerValue == 4) {
+            const auto dataset = it.load_as<uint32_t>(iomutex);
+            benchmark(it.name(), dataset, outfile, iomutex);
+         } else {
+            const auto dataset = it.load(iomutex);
+            benchmark(it.name(), dataset, outfile, iomutex);
+         }
       }
    } catch (const std::exception& ex) {
       std::cerr << ex.what() << std::endl;
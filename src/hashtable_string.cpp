@@ -0,0 +1,168 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include <convenience.hpp>
+#include <hashing.hpp>
+#include <hashtable.hpp>
+
+#include "include/args.hpp"
+#include "include/benchmark.hpp"
+#include "include/csv.hpp"
+
+using Args = BenchmarkArgs::HashStringArgs;
+
+const std::vector<std::string> csv_columns = {
+   // General statistics
+   "dataset", "numelements", "avg_key_length", "load_factor", "hashtable", "hash", "reducer", "payload", "bytes",
+   "insert_nanoseconds_total", "insert_nanoseconds_per_key", "avg_lookup_nanoseconds_total",
+   "avg_lookup_nanoseconds_per_key", "median_lookup_nanoseconds_total", "median_lookup_nanoseconds_per_key",
+   "num_runs",
+
+   // String table custom statistics
+   "max_psl", "total_psl", "tag_collisions", "inline_keys", "arena_keys", "arena_bytes"
+
+   //
+};
+
+struct Payload16 {
+   uint64_t q0 = 0, q1 = 0;
+   explicit Payload16(const std::string_view& key) : q0(key.size()), q1(key.empty() ? 0 : key.front()) {}
+   explicit Payload16() {}
+
+   bool operator==(const Payload16& other) {
+      return q0 == other.q0 && q1 == other.q1;
+   }
+} packed;
+
+template<class Hashtable>
+static void measure(const std::string& dataset_name, const std::vector<std::string_view>& dataset,
+                    const double load_factor, CSV& outfile, std::mutex& iomutex) {
+   const auto str = [](auto s) { return std::to_string(s); };
+
+   size_t total_key_length = 0;
+   for (const auto& key : dataset)
+      total_key_length += key.size();
+
+   std::map<std::string, std::string> datapoint(
+      {{"dataset", dataset_name},
+       {"numelements", str(dataset.size())},
+       {"avg_key_length", str(relative_to(total_key_length, dataset.size()))},
+       {"load_factor", str(load_factor)},
+       {"hashtable", Hashtable::name()},
+       {"payload", str(::Hashtable::payload_byte_size<typename Hashtable::PayloadType>())},
+       {"hash", Hashtable::hash_name()},
+       {"reducer", Hashtable::reducer_name()}});
+
+   if (outfile.exists(datapoint)) {
+      std::unique_lock<std::mutex> lock(iomutex);
+      std::cout << "Skipping (";
+      auto iter = datapoint.begin();
+      while (iter != datapoint.end()) {
+         std::cout << iter->first << ": " << iter->second;
+
+         iter++;
+         if (iter != datapoint.end())
+            std::cout << ", ";
+      }
+      std::cout << ") since it already exist" << std::endl;
+      return;
+   }
+
+   try {
+      const auto ht_capacity = static_cast<uint64_t>(static_cast<double>(dataset.size()) / load_factor);
+      Hashtable hashtable(ht_capacity);
+
+      // Measure
+      const auto stats = Benchmark::measure_hashtable(dataset, hashtable);
+
+#ifdef VERBOSE
+      {
+         std::unique_lock<std::mutex> lock(iomutex);
+         std::cout << std::setw(55) << std::right
+                   << Hashtable::name() + "<" + Hashtable::reducer_name() + "(" + Hashtable::hash_name() +
+                   ")> insert took "
+                   << relative_to(stats.total_insert_ns, dataset.size()) << " ns/key ("
+                   << nanoseconds_to_seconds(stats.total_insert_ns) << " s total), lookup took "
+                   << relative_to(stats.median_total_lookup_ns, dataset.size()) << " ns/key ("
+                   << nanoseconds_to_seconds(stats.median_total_lookup_ns) << " s total)" << std::endl;
+      };
+#endif
+
+      datapoint.emplace("bytes", str(hashtable.byte_size()));
+      datapoint.emplace("insert_nanoseconds_total", str(stats.total_insert_ns));
+      datapoint.emplace("insert_nanoseconds_per_key", str(relative_to(stats.total_insert_ns, dataset.size())));
+      datapoint.emplace("avg_lookup_nanoseconds_total", str(stats.avg_total_lookup_ns));
+      datapoint.emplace("avg_lookup_nanoseconds_per_key", str(relative_to(stats.avg_total_lookup_ns, dataset.size())));
+      datapoint.emplace("median_lookup_nanoseconds_total", str(stats.median_total_lookup_ns));
+      datapoint.emplace("median_lookup_nanoseconds_per_key",
+                        str(relative_to(stats.median_total_lookup_ns, dataset.size())));
+      datapoint.emplace("num_runs", str(stats.lookup_repeats));
+
+      // Make sure we collect more insight based on hashtable
+      for (const auto& stat : hashtable.lookup_statistics(dataset)) {
+         datapoint.emplace(stat);
+      }
+   } catch (const std::exception& e) {
+      std::unique_lock<std::mutex> lock(iomutex);
+      std::cout << std::setw(55) << std::right
+                << Hashtable::reducer_name() + "(" + Hashtable::hash_name() + ") failed: " << e.what() << std::endl;
+   }
+
+   // Write to csv (if experiment failed this will visibly log that)
+   outfile.write(datapoint);
+}
+
+template<class Hashfn>
+static void measure_tables(const std::string& dataset_name, const std::vector<std::string_view>& dataset,
+                           const double load_factor, CSV& outfile, std::mutex& iomutex) {
+   using namespace Reduction;
+
+   // Inline storage for short keys (e.g., emails) vs. only storing the 8 byte arena offset
+   measure<Hashtable::StringProbing<Payload16, Hashfn, FastModulo<HASH_64>, 8>>(dataset_name, dataset, load_factor,
+                                                                                outfile, iomutex);
+   measure<Hashtable::StringProbing<Payload16, Hashfn, FastModulo<HASH_64>, 26>>(dataset_name, dataset, load_factor,
+                                                                                 outfile, iomutex);
+   measure<Hashtable::StringProbing<Payload16, Hashfn, FastModulo<HASH_64>, 58>>(dataset_name, dataset, load_factor,
+                                                                                 outfile, iomutex);
+
+   /// Sets (keys only)
+   measure<Hashtable::StringProbing<void, Hashfn, FastModulo<HASH_64>, 26>>(dataset_name, dataset, load_factor,
+                                                                            outfile, iomutex);
+}
+
+static void benchmark(const std::string& dataset_name, const std::vector<std::string_view>& dataset,
+                      const std::vector<double>& load_factors, CSV& outfile, std::mutex& iomutex) {
+   for (const auto load_factor : load_factors) {
+      measure_tables<XXHash3<std::string_view>>(dataset_name, dataset, load_factor, outfile, iomutex);
+      measure_tables<XXHash64<std::string_view>>(dataset_name, dataset, load_factor, outfile, iomutex);
+      measure_tables<CityHash64<std::string_view>>(dataset_name, dataset, load_factor, outfile, iomutex);
+      if (Cpu::has_aes())
+         measure_tables<MeowHash64<std::string_view>>(dataset_name, dataset, load_factor, outfile, iomutex);
+   }
+}
+
+int main(int argc, char* argv[]) {
+   try {
+      auto args = Args(argc, argv);
+
+      CSV outfile(args.outfile, csv_columns);
+      std::mutex iomutex;
+
+      for (const auto& it : args.datasets) {
+         // Benchmarks operate on views, i.e., keys must outlive dataset
+         const auto keys = it.load(iomutex);
+         const std::vector<std::string_view> dataset(keys.begin(), keys.end());
+
+         benchmark(it.name(), dataset, args.load_factors, outfile, iomutex);
+      }
+   } catch (const std::exception& ex) {
+      std::cerr << ex.what() << std::endl;
+      return -1;
+   }
+
+   return 0;
+}
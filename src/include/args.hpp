@@ -18,6 +18,9 @@ namespace BenchmarkArgs {
    const std::string load_factors_key = "load-factors";
    const std::string sample_sizes_key = "sample-sizes";
    const std::string datasets_key = "datasets";
+   const std::string snapshot_dir_key = "snapshot-dir";
+   const std::string model_cache_key = "model-cache";
+   const std::string drift_fractions_key = "drift-fractions";
 
    struct HashCollisionArgs {
       std::string outfile;
@@ -211,6 +214,7 @@ namespace BenchmarkArgs {
       unsigned int max_threads;
       std::vector<Dataset> datasets;
       std::vector<double> sample_sizes;
+      std::string model_cache;
 
       LearnedThroughputArgs(int argc, char* argv[]) {
          const std::vector<std::string> required{outfile_key, datasets_key};
@@ -230,6 +234,10 @@ namespace BenchmarkArgs {
                (sample_sizes_key,
                 "comma separated list of sample sizes to measure, i.e., percentage floating point values",
                 cxxopts::value<std::vector<double>>()->default_value("0.01")) //
+               (model_cache_key,
+                "directory of cached trained models. Models found in the cache are loaded instead of trained, trained "
+                "models are added to it. Disabled if empty",
+                cxxopts::value<std::string>()->default_value("")) //
                (datasets_key,
                 "datasets to benchmark on, formatted as '<PATH_TO_DATASET>:<BYTES_PER_NUMBER>'. Collects positional "
                 "arguments",
@@ -258,6 +266,7 @@ namespace BenchmarkArgs {
             // Extract
             outfile = result[outfile_key].as<std::string>();
             sample_sizes = result[sample_sizes_key].as<std::vector<double>>();
+            model_cache = result[model_cache_key].as<std::string>();
             max_threads = result[max_threads_key].as<unsigned int>();
             datasets = result[datasets_key].as<std::vector<Dataset>>();
          } catch (const std::exception& ex) {
@@ -330,6 +339,200 @@ namespace BenchmarkArgs {
       }
    };
 
+   struct HashFilterArgs {
+      std::string outfile;
+      std::vector<double> load_factors;
+      std::vector<Dataset> datasets;
+      unsigned int max_threads;
+
+      HashFilterArgs(int argc, char* argv[]) {
+         const std::vector<std::string> required{outfile_key, datasets_key};
+
+         try {
+            // Define
+            cxxopts::Options options("Filter",
+                                     "Benchmark designed to measure throughput and false positive rate statistics for "
+                                     "various filters and hash functions.");
+            options.add_options()("h," + help_key, "display help") //
+               (outfile_key,
+                "path to output file for storing results as csv. NOTE: file will always be overwritten",
+                cxxopts::value<std::string>()) //
+               (max_threads_key,
+                "maximum amount of threads to concurrently execute. NOTE: more threads may be created but only " +
+                   max_threads_key + " will actually execute at the same time.",
+                cxxopts::value<unsigned int>()->default_value(std::to_string(std::thread::hardware_concurrency()))) //
+               (load_factors_key,
+                "comma separated list of load factors, i.e., percentage floating point values",
+                cxxopts::value<std::vector<double>>()->default_value("0.95")) //
+               (datasets_key,
+                "datasets to benchmark on, formatted as '<PATH_TO_DATASET>:<BYTES_PER_NUMBER>'. Collects positional "
+                "arguments",
+                cxxopts::value<std::vector<Dataset>>());
+            options.parse_positional({datasets_key});
+
+            if (argc <= 1) {
+               std::cout << options.help() << std::endl;
+               exit(0);
+            }
+
+            // Parse
+            auto result = options.parse(argc, argv);
+
+            // Validate
+            if (result.count(help_key)) {
+               std::cout << options.help() << std::endl;
+               exit(0);
+            }
+            for (const auto& key : required) {
+               if (!result.count(key)) {
+                  throw std::runtime_error("Please specify the required '" + key + "' option");
+               }
+            }
+
+            // Extract
+            outfile = result[outfile_key].as<std::string>();
+            max_threads = result[max_threads_key].as<unsigned int>();
+            load_factors = result[load_factors_key].as<std::vector<double>>();
+            datasets = result[datasets_key].as<std::vector<Dataset>>();
+         } catch (const std::exception& ex) {
+            std::cerr << "error: " << ex.what() << std::endl;
+            std::cerr << "Use --help for information on how to run this benchmark" << std::endl;
+            exit(1);
+         }
+      }
+   };
+
+   struct HashStringArgs {
+      std::string outfile;
+      std::vector<double> load_factors;
+      std::vector<StringDataset> datasets;
+      unsigned int max_threads;
+
+      HashStringArgs(int argc, char* argv[]) {
+         const std::vector<std::string> required{outfile_key, datasets_key};
+
+         try {
+            // Define
+            cxxopts::Options options("String Hashtable",
+                                     "Benchmark designed to measure hashtable performance on variable length string "
+                                     "keys for various hash functions.");
+            options.add_options()("h," + help_key, "display help") //
+               (outfile_key,
+                "path to output file for storing results as csv. NOTE: file will always be overwritten",
+                cxxopts::value<std::string>()) //
+               (max_threads_key,
+                "maximum amount of threads to concurrently execute. NOTE: more threads may be created but only " +
+                   max_threads_key + " will actually execute at the same time.",
+                cxxopts::value<unsigned int>()->default_value(std::to_string(std::thread::hardware_concurrency()))) //
+               (load_factors_key,
+                "comma separated list of load factors, i.e., percentage floating point values",
+                cxxopts::value<std::vector<double>>()->default_value("0.5,0.75")) //
+               (datasets_key,
+                "datasets to benchmark on, formatted as '<PATH_TO_DATASET>:<newline|prefixed>', i.e., one key per "
+                "line or 4 byte little endian length prefixed keys. Collects positional arguments",
+                cxxopts::value<std::vector<StringDataset>>());
+            options.parse_positional({datasets_key});
+
+            if (argc <= 1) {
+               std::cout << options.help() << std::endl;
+               exit(0);
+            }
+
+            // Parse
+            auto result = options.parse(argc, argv);
+
+            // Validate
+            if (result.count(help_key)) {
+               std::cout << options.help() << std::endl;
+               exit(0);
+            }
+            for (const auto& key : required) {
+               if (!result.count(key)) {
+                  throw std::runtime_error("Please specify the required '" + key + "' option");
+               }
+            }
+
+            // Extract
+            outfile = result[outfile_key].as<std::string>();
+            max_threads = result[max_threads_key].as<unsigned int>();
+            load_factors = result[load_factors_key].as<std::vector<double>>();
+            datasets = result[datasets_key].as<std::vector<StringDataset>>();
+         } catch (const std::exception& ex) {
+            std::cerr << "error: " << ex.what() << std::endl;
+            std::cerr << "Use --help for information on how to run this benchmark" << std::endl;
+            exit(1);
+         }
+      }
+   };
+
+   struct SnapshotHashArgs {
+      std::string outfile;
+      std::string snapshot_dir;
+      std::vector<double> load_factors;
+      std::vector<Dataset> datasets;
+      unsigned int max_threads;
+
+      SnapshotHashArgs(int argc, char* argv[]) {
+         const std::vector<std::string> required{outfile_key, datasets_key};
+
+         try {
+            // Define
+            cxxopts::Options options("Snapshot",
+                                     "Benchmark designed to compare cold start time of hashtables opened from an mmap "
+                                     "snapshot against rebuilding them.");
+            options.add_options()("h," + help_key, "display help") //
+               (outfile_key,
+                "path to output file for storing results as csv. NOTE: file will always be overwritten",
+                cxxopts::value<std::string>()) //
+               (snapshot_dir_key,
+                "directory to write hashtable snapshots to. NOTE: snapshots may be as large as the hashtables",
+                cxxopts::value<std::string>()->default_value("snapshots")) //
+               (max_threads_key,
+                "maximum amount of threads to concurrently execute. NOTE: more threads may be created but only " +
+                   max_threads_key + " will actually execute at the same time.",
+                cxxopts::value<unsigned int>()->default_value(std::to_string(std::thread::hardware_concurrency()))) //
+               (load_factors_key,
+                "comma separated list of load factors, i.e., percentage floating point values",
+                cxxopts::value<std::vector<double>>()->default_value("0.75")) //
+               (datasets_key,
+                "datasets to benchmark on, formatted as '<PATH_TO_DATASET>:<BYTES_PER_NUMBER>'. Collects positional "
+                "arguments",
+                cxxopts::value<std::vector<Dataset>>());
+            options.parse_positional({datasets_key});
+
+            if (argc <= 1) {
+               std::cout << options.help() << std::endl;
+               exit(0);
+            }
+
+            // Parse
+            auto result = options.parse(argc, argv);
+
+            // Validate
+            if (result.count(help_key)) {
+               std::cout << options.help() << std::endl;
+               exit(0);
+            }
+            for (const auto& key : required) {
+               if (!result.count(key)) {
+                  throw std::runtime_error("Please specify the required '" + key + "' option");
+               }
+            }
+
+            // Extract
+            outfile = result[outfile_key].as<std::string>();
+            snapshot_dir = result[snapshot_dir_key].as<std::string>();
+            max_threads = result[max_threads_key].as<unsigned int>();
+            load_factors = result[load_factors_key].as<std::vector<double>>();
+            datasets = result[datasets_key].as<std::vector<Dataset>>();
+         } catch (const std::exception& ex) {
+            std::cerr << "error: " << ex.what() << std::endl;
+            std::cerr << "Use --help for information on how to run this benchmark" << std::endl;
+            exit(1);
+         }
+      }
+   };
+
    struct LearnedHashtableArgs {
       std::string outfile;
       std::vector<double> load_factors;
@@ -391,4 +594,79 @@ namespace BenchmarkArgs {
          }
       }
    };
+
+   struct DriftLearnedArgs {
+      std::string outfile;
+      unsigned int max_threads;
+      std::vector<double> load_factors;
+      std::vector<double> sample_sizes;
+      std::vector<double> drift_fractions;
+      std::vector<Dataset> datasets;
+
+      DriftLearnedArgs(int argc, char* argv[]) {
+         const std::vector<std::string> required{outfile_key, datasets_key};
+
+         try {
+            // Define
+            cxxopts::Options options("Learned Drift",
+                                     "Benchmark designed to measure collisions of learned hash functions while keys "
+                                     "from a drifting distribution are inserted, comparing static, incrementally "
+                                     "retrained and fully retrained models.");
+            options.add_options()("h," + help_key, "display help") //
+               (outfile_key,
+                "path to output file for storing results as csv. NOTE: file will always be overwritten",
+                cxxopts::value<std::string>()) //
+               (max_threads_key,
+                "maximum amount of threads to concurrently execute. NOTE: more threads may be created but only " +
+                   max_threads_key + " will actually execute at the same time.",
+                cxxopts::value<unsigned int>()->default_value(std::to_string(std::thread::hardware_concurrency()))) //
+               (load_factors_key,
+                "comma separated list of load factors to measure, i.e., percentage floating point values",
+                cxxopts::value<std::vector<double>>()->default_value("1.0")) //
+               (sample_sizes_key,
+                "comma separated list of sample sizes to measure, i.e., percentage floating point values",
+                cxxopts::value<std::vector<double>>()->default_value("0.01")) //
+               (drift_fractions_key,
+                "comma separated list of the fraction of keys that drift, i.e., are not part of the initial "
+                "distribution and arrive increasingly often over time",
+                cxxopts::value<std::vector<double>>()->default_value("0.01,0.1")) //
+               (datasets_key,
+                "datasets to benchmark on, formatted as '<PATH_TO_DATASET>:<BYTES_PER_NUMBER>'. Collects positional "
+                "arguments",
+                cxxopts::value<std::vector<Dataset>>());
+            options.parse_positional({datasets_key});
+
+            if (argc <= 1) {
+               std::cout << options.help() << std::endl;
+               exit(0);
+            }
+
+            // Parse
+            auto result = options.parse(argc, argv);
+
+            // Validate
+            if (result.count(help_key)) {
+               std::cout << options.help() << std::endl;
+               exit(0);
+            }
+            for (const auto& key : required) {
+               if (!result.count(key)) {
+                  throw std::runtime_error("Please specify the required '" + key + "' option");
+               }
+            }
+
+            // Extract
+            outfile = result[outfile_key].as<std::string>();
+            max_threads = result[max_threads_key].as<unsigned int>();
+            load_factors = result[load_factors_key].as<std::vector<double>>();
+            sample_sizes = result[sample_sizes_key].as<std::vector<double>>();
+            drift_fractions = result[drift_fractions_key].as<std::vector<double>>();
+            datasets = result[datasets_key].as<std::vector<Dataset>>();
+         } catch (const std::exception& ex) {
+            std::cerr << "error: " << ex.what() << std::endl;
+            std::cerr << "Use --help for information on how to run this benchmark" << std::endl;
+            exit(1);
+         }
+      }
+   };
 } // namespace BenchmarkArgs
\ No newline at end of file
@@ -1,9 +1,12 @@
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <chrono>
 #include <cmath>
 #include <numeric>
+#include <optional>
 #include <random>
+#include <type_traits>
 #include <vector>
 
 #ifdef __APPLE__
@@ -18,6 +21,8 @@
    #include <thirdparty/perf-macos.hpp>
 #endif
 
+#include "perf.hpp"
+
 namespace Benchmark {
 
    struct ThroughputStats {
@@ -71,6 +76,42 @@ namespace Benchmark {
       return {avg, repeatCnt};
    }
 
+   /**
+    * Same as measure_throughput() but hashes and reduces BatchSize keys at once
+    * via hash_batch() and reduce_batch(), i.e., using vectorized kernels where
+    * available. Hashes of a batch stay in L1 between both steps
+    *
+    * @tparam Hashfn
+    * @tparam Reducerfn
+    * @tparam BatchSize amount of keys hashed per hash_batch() call
+    */
+   template<typename Hashfn, typename Reducefn, class Data, unsigned int repeatCnt = 10, size_t BatchSize = 256>
+   ThroughputStats measure_batch_throughput(const std::vector<Data>& dataset, Hashfn hashfn = Hashfn()) {
+      uint64_t avg = 0;
+
+      // For throughput experiment, assume load_factor = 1
+      Reducefn reducefn(dataset.size());
+      std::array<HASH_64, BatchSize> hashes;
+
+      for (unsigned int repetiton = 0; repetiton < repeatCnt; repetiton++) {
+         const auto start_time = std::chrono::steady_clock::now();
+         for (size_t i = 0; i < dataset.size(); i += BatchSize) {
+            const auto n = std::min(BatchSize, dataset.size() - i);
+            hash_batch(hashfn, dataset.data() + i, hashes.data(), n);
+            reduce_batch(reducefn, hashes.data(), hashes.data(), n);
+
+            for (size_t j = 0; j < n; j++)
+               Optimizer::DoNotEliminate(hashes[j]);
+         }
+         const auto end_time = std::chrono::steady_clock::now();
+         const auto delta_ns =
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count());
+         avg += delta_ns / repeatCnt;
+      }
+
+      return {avg, repeatCnt};
+   }
+
    // These are probably to large but these few additional bytes don't hurt
    template<typename Counter, typename PreciseMath>
    struct CollisionStats {
@@ -93,10 +134,16 @@ namespace Benchmark {
     * using HashFunction to obtain a hash value and Reducer to reduce the hash value to an index into
     * the hashtable.
     *
+    * Keys stream through a Reduction::HashPipeline, i.e., are hashed and
+    * reduced in batches of BatchSize using vectorized kernels where available,
+    * and counters are prefetched PrefetchDepth keys ahead.
+    *
     * @tparam HashFunction
     * @tparam Reducer
+    * @tparam BatchSize amount of keys hashed and reduced at once
+    * @tparam PrefetchDepth prefetch distance in keys
     */
-   template<class Hashfn, class Reducerfn, class Data>
+   template<class Hashfn, class Reducerfn, class Data, size_t BatchSize = 256, size_t PrefetchDepth = 16>
    CollisionStats<uint64_t, double> measure_collisions(const std::vector<Data>& dataset,
                                                        std::vector<size_t>& collision_counter,
                                                        Hashfn hashfn = Hashfn()) {
@@ -104,26 +151,28 @@ namespace Benchmark {
       std::fill(collision_counter.begin(), collision_counter.end(), 0);
 
       auto start_time = std::chrono::steady_clock::now();
-      Reducerfn reducefn(collision_counter.size());
+      Reduction::HashPipeline<Hashfn, Reducerfn, PrefetchDepth, BatchSize> pipeline(
+         Reducerfn(collision_counter.size()), hashfn);
 #ifdef MACOS
       {
          Perf::BlockCounter ctr(dataset.size());
 #endif
          // Hash each value and record entries per bucket
-         for (const auto key : dataset) {
-            const auto ht_address = reducefn(hashfn(key));
-            collision_counter[ht_address]++;
-
-            // Our datasets are currently too small to ever cause unsigned int addition overflow
-            // therefore this check is redundant. Doesn't hurt in release mode however
-            assert(collision_counter[ht_address] != 0);
-
-            // Optimizer will never eliminate this (visible side effect in collision counter),
-            // however it might try to be clever about computing ht_address since it knows that
-            // we only really care about the correct values in collision_counter in the end. Therefore
-            // constrain optimizer to actually to proper insertions
-            Optimizer::DoNotEliminate(ht_address);
-         }
+         pipeline.template stream<Cache::WRITE>(
+            dataset.data(), dataset.size(), [&](const HASH_64& ht_address) { return &collision_counter[ht_address]; },
+            [&](const Data&, const HASH_64& ht_address) {
+               collision_counter[ht_address]++;
+
+               // Our datasets are currently too small to ever cause unsigned int addition overflow
+               // therefore this check is redundant. Doesn't hurt in release mode however
+               assert(collision_counter[ht_address] != 0);
+
+               // Optimizer will never eliminate this (visible side effect in collision counter),
+               // however it might try to be clever about computing ht_address since it knows that
+               // we only really care about the correct values in collision_counter in the end. Therefore
+               // constrain optimizer to actually to proper insertions
+               Optimizer::DoNotEliminate(ht_address);
+            });
 #ifdef MACOS
       }
 #endif
@@ -156,8 +205,23 @@ namespace Benchmark {
       uint64_t median_total_lookup_ns;
 
       unsigned int lookup_repeats;
+
+      /// L1 data cache misses of an average lookup run, if perf counters are available
+      std::optional<uint64_t> avg_lookup_l1d_misses;
    };
 
+   /**
+    * Inserts key into ht, deriving the payload from key. Sets (PayloadType = void)
+    * only receive the key
+    */
+   template<typename Hashtable>
+   forceinline void insert(Hashtable& ht, const typename Hashtable::KeyType& key) {
+      if constexpr (std::is_void_v<typename Hashtable::PayloadType>)
+         ht.insert(key);
+      else
+         ht.insert(key, typename Hashtable::PayloadType(key));
+   }
+
    template<const uint32_t UnsuccessfulLookupPercent = 0, typename Hashtable, const unsigned int LookupRepeatCount = 7>
    HashtableStats measure_hashtable(const std::vector<typename Hashtable::KeyType>& dataset, Hashtable& ht) {
       // Random generator
@@ -175,14 +239,14 @@ namespace Benchmark {
          // previous path, i.e., fast path
          if (UnsuccessfulLookupPercent == 0) {
             for (const auto key : dataset) {
-               ht.insert(key, typename Hashtable::PayloadType(key));
+               insert(ht, key);
             }
          } else {
             // This is slower and adds overhead depending on speed of rand(), i.e., insert numbers should be taken with
             // a grain of salt
             for (const auto key : dataset) {
                if (rng() >= UnsuccessfulLookupPercent)
-                  ht.insert(key, typename Hashtable::PayloadType(key));
+                  insert(ht, key);
             }
          }
 #ifdef MACOS
@@ -193,8 +257,11 @@ namespace Benchmark {
          static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count());
 
       std::vector<uint64_t> probe_times;
+      Perf::L1DMissCounter l1d_misses;
+      uint64_t total_lookup_l1d_misses = 0;
       for (auto i = LookupRepeatCount; i > 0; i--) {
          // Lookup every key
+         l1d_misses.start();
          start_time = std::chrono::steady_clock::now();
 #ifdef MACOS
          {
@@ -208,7 +275,8 @@ namespace Benchmark {
                // Only perform these checks when debugging
                if (UnsuccessfulLookupPercent == 0) {
                   assert(payload);
-                  assert(payload.value() == typename Hashtable::PayloadType(key));
+                  if constexpr (!std::is_void_v<typename Hashtable::PayloadType>)
+                     assert(payload.value() == typename Hashtable::PayloadType(key));
                }
 #endif
             }
@@ -216,6 +284,7 @@ namespace Benchmark {
          }
 #endif
          end_time = std::chrono::steady_clock::now();
+         total_lookup_l1d_misses += l1d_misses.stop();
          probe_times.emplace_back(
             static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count()));
       }
@@ -232,6 +301,88 @@ namespace Benchmark {
       return {.total_insert_ns = total_insert_ns,
               .avg_total_lookup_ns = avg_total_lookup_ns,
               .median_total_lookup_ns = median_total_lookup_ns,
+              .lookup_repeats = LookupRepeatCount,
+              .avg_lookup_l1d_misses = l1d_misses.valid()
+                 ? std::optional<uint64_t>(total_lookup_l1d_misses / LookupRepeatCount)
+                 : std::nullopt};
+   }
+
+   struct FilterStats {
+      uint64_t total_insert_ns;
+      size_t failed_inserts;
+
+      uint64_t avg_total_positive_lookup_ns;
+      uint64_t avg_total_negative_lookup_ns;
+      size_t false_positives;
+
+      uint64_t total_erase_ns;
+
+      unsigned int lookup_repeats;
+   };
+
+   /**
+    * Inserts every member into the filter, then measures lookup throughput for
+    * members and non-members, the false positive rate and finally the cost of
+    * erasing every member again.
+    *
+    * @param members keys to insert
+    * @param nonmembers keys that must not be contained in members
+    */
+   template<typename Filter, const unsigned int LookupRepeatCount = 7>
+   FilterStats measure_filter(const std::vector<typename Filter::KeyType>& members,
+                              const std::vector<typename Filter::KeyType>& nonmembers, Filter& filter) {
+      filter.clear();
+
+      size_t failed_inserts = 0;
+      auto start_time = std::chrono::steady_clock::now();
+      for (const auto& key : members)
+         failed_inserts += filter.insert(key) ? 0 : 1;
+      auto end_time = std::chrono::steady_clock::now();
+      const uint64_t total_insert_ns =
+         static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count());
+
+      uint64_t avg_total_positive_lookup_ns = 0, avg_total_negative_lookup_ns = 0;
+      size_t false_positives = 0;
+      for (auto i = LookupRepeatCount; i > 0; i--) {
+         start_time = std::chrono::steady_clock::now();
+         for (const auto& key : members) {
+            const auto found = filter.contains(key);
+            Optimizer::DoNotEliminate(found);
+#ifndef NDEBUG
+            // filters must never produce false negatives
+            assert(found || failed_inserts > 0);
+#endif
+         }
+         end_time = std::chrono::steady_clock::now();
+         avg_total_positive_lookup_ns +=
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count());
+
+         false_positives = 0;
+         start_time = std::chrono::steady_clock::now();
+         for (const auto& key : nonmembers)
+            false_positives += filter.contains(key) ? 1 : 0;
+         end_time = std::chrono::steady_clock::now();
+         avg_total_negative_lookup_ns +=
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count());
+      }
+      avg_total_positive_lookup_ns /= LookupRepeatCount;
+      avg_total_negative_lookup_ns /= LookupRepeatCount;
+
+      start_time = std::chrono::steady_clock::now();
+      for (const auto& key : members) {
+         const auto erased = filter.erase(key);
+         Optimizer::DoNotEliminate(erased);
+      }
+      end_time = std::chrono::steady_clock::now();
+      const uint64_t total_erase_ns =
+         static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count());
+
+      return {.total_insert_ns = total_insert_ns,
+              .failed_inserts = failed_inserts,
+              .avg_total_positive_lookup_ns = avg_total_positive_lookup_ns,
+              .avg_total_negative_lookup_ns = avg_total_negative_lookup_ns,
+              .false_positives = false_positives,
+              .total_erase_ns = total_erase_ns,
               .lookup_repeats = LookupRepeatCount};
    }
 } // namespace Benchmark
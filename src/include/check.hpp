@@ -0,0 +1,50 @@
+#pragma once
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * Minimal checking facilities shared by the test_* targets. Unlike assert(),
+ * checks are not compiled out in release builds and a failed check does not
+ * abort, i.e., a single run reports every failure
+ */
+namespace Check {
+   inline size_t failures = 0;
+
+   inline void report(const bool passed, const char* condition, const char* file, const int line) {
+      if (passed)
+         return;
+
+      failures++;
+      std::cerr << file << ":" << line << ": check failed: " << condition << std::endl;
+   }
+
+   /// exit code for main()
+   inline int result() {
+      if (failures > 0)
+         std::cerr << failures << " check(s) failed" << std::endl;
+      return failures > 0 ? 1 : 0;
+   }
+
+   /**
+    * Generates n distinct random keys (0 excluded, since some structures reserve it)
+    */
+   template<class Data>
+   std::vector<Data> distinct_keys(const size_t n, const uint64_t seed = 42) {
+      std::mt19937_64 gen(seed);
+      std::unordered_set<Data> seen;
+      std::vector<Data> keys;
+      keys.reserve(n);
+      while (keys.size() < n) {
+         const auto key = static_cast<Data>(gen());
+         if (key != 0 && seen.insert(key).second)
+            keys.push_back(key);
+      }
+      return keys;
+   }
+} // namespace Check
+
+#define CHECK(condition) Check::report(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
@@ -2,12 +2,14 @@
 
 #include <exception>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <iterator>
 #include <map>
 #include <random>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include <convenience.hpp>
@@ -17,7 +19,8 @@ struct Dataset {
    /// file name of the dataset
    std::string filepath;
 
-   /// Bytes per value, i.e., 4 for 32-bit integers, 8 for 64 bit integers
+   /// Bytes per value, i.e., 4 for 32-bit integers, 8 for 64 bit integers, 16
+   /// for 128-bit integers, e.g., (tenant_id, object_id) pairs
    size_t bytesPerValue;
 
    std::string name() const {
@@ -26,9 +29,29 @@ struct Dataset {
 
    /**
     * Loads the datasets values into memory
+    * @param sorted_hook see load_as()
     * @return a sorted and deduplicated list of all members of the dataset
     */
-   std::vector<uint64_t> load(std::mutex& iomutex) const {
+   std::vector<uint64_t> load(std::mutex& iomutex,
+                              const std::function<void(const std::vector<uint64_t>&)>& sorted_hook = {}) const {
+      return load_as<uint64_t>(iomutex, sorted_hook);
+   }
+
+   /**
+    * Loads the datasets values into memory, stored as Key. Allows benchmarking
+    * 4 byte datasets with true 32-bit key layouts and 16 byte datasets with
+    * 128-bit keys (HASH_128)
+    * @param sorted_hook invoked on the sorted and deduplicated keys before they
+    *    are shuffled, e.g., to draw a sorted sample without sorting it
+    * @return a sorted and deduplicated list of all members of the dataset
+    */
+   template<class Key>
+   std::vector<Key> load_as(std::mutex& iomutex,
+                            const std::function<void(const std::vector<Key>&)>& sorted_hook = {}) const {
+      if (sizeof(Key) < bytesPerValue)
+         throw std::runtime_error("Can't load " + std::to_string(bytesPerValue) + " byte dataset '" + filepath +
+                                  "' as " + std::to_string(sizeof(Key)) + " byte keys");
+
 #ifdef VERBOSE
       {
          std::unique_lock<std::mutex> lock(iomutex);
@@ -45,7 +68,7 @@ struct Dataset {
       }
 
       const auto max_num_elements = (size - sizeof(uint64_t)) / bytesPerValue;
-      std::vector<uint64_t> dataset(max_num_elements, 0);
+      std::vector<Key> dataset(max_num_elements, 0);
       {
          std::vector<unsigned char> buffer(size);
          if (!input.read(reinterpret_cast<char*>(buffer.data()), size)) {
@@ -67,7 +90,15 @@ struct Dataset {
                uint64_t offset = i * 4 + 8;
                dataset[i] = read_little_endian_4(buffer, offset);
             }
-         else {
+         else if (bytesPerValue == 16) {
+            if constexpr (sizeof(Key) == 16)
+               for (uint64_t i = 0; i < num_elements; i++) {
+                  // 8 byte header, 16 bytes per entry, i.e., lower followed by upper 8 bytes
+                  uint64_t offset = i * 16 + 8;
+                  dataset[i] =
+                     to_hash128(read_little_endian_8(buffer, offset + 8), read_little_endian_8(buffer, offset));
+               }
+         } else {
             throw std::runtime_error("Unimplemented amount of bytes per value in dataset: " +
                                      std::to_string(this->bytesPerValue));
          }
@@ -88,6 +119,8 @@ struct Dataset {
       }
 #endif
       deduplicate(dataset);
+      if (sorted_hook)
+         sorted_hook(dataset);
 
 #ifdef VERBOSE
       {
@@ -116,11 +149,14 @@ struct Dataset {
    }
 
   private:
+   friend struct StringDataset;
+
    /**
     * Sorts a dataset using std::sort
     * @param dataset
     */
-   static forceinline void sort(std::vector<uint64_t>& dataset) {
+   template<class T>
+   static forceinline void sort(std::vector<T>& dataset) {
       std::sort(dataset.begin(), dataset.end());
    }
 
@@ -128,7 +164,8 @@ struct Dataset {
     * Deduplicates the dataset. NOTE: data must be sorted for this to work
     * @param dataset
     */
-   static forceinline void deduplicate(std::vector<uint64_t>& dataset) {
+   template<class T>
+   static forceinline void deduplicate(std::vector<T>& dataset) {
       dataset.erase(std::unique(dataset.begin(), dataset.end()), dataset.end());
    }
 
@@ -137,7 +174,8 @@ struct Dataset {
     * @param dataset
     * @param seed
     */
-   static forceinline void shuffle(std::vector<uint64_t>& dataset, const uint64_t seed = std::random_device()()) {
+   template<class T>
+   static forceinline void shuffle(std::vector<T>& dataset, const uint64_t seed = std::random_device()()) {
       if (dataset.empty())
          return;
 
@@ -192,3 +230,141 @@ std::istream& operator>>(std::istream& is, Dataset& ds) {
    is >> ds.bytesPerValue;
    return is;
 }
+
+struct StringDataset {
+  public:
+   enum class Format {
+      /// one key per line. Trailing '\r' are stripped, empty lines skipped
+      Newline,
+      /// sequence of <4 byte little endian length><length key bytes> entries
+      LengthPrefixed,
+   };
+
+   /// file name of the dataset
+   std::string filepath;
+
+   /// on disk encoding of the keys
+   Format format;
+
+   std::string name() const {
+      return filepath.substr(filepath.find_last_of("/\\") + 1);
+   }
+
+   /**
+    * Loads the datasets keys into memory
+    * @return a deduplicated and shuffled list of all members of the dataset
+    */
+   std::vector<std::string> load(std::mutex& iomutex) const {
+#ifdef VERBOSE
+      {
+         std::unique_lock<std::mutex> lock(iomutex);
+         std::cout << "Loading dataset " << filepath << " ... " << std::flush;
+      }
+#endif
+
+      std::ifstream input(filepath, std::ios::binary | std::ios::ate);
+      if (!input.is_open()) {
+         throw std::runtime_error("Dataset file at data_folder_path '" + filepath + "' does not exist");
+      }
+      std::streamsize size = input.tellg();
+      input.seekg(0, std::ios::beg);
+
+      std::vector<char> buffer(size);
+      if (!input.read(buffer.data(), size)) {
+         throw std::runtime_error("Failed to read dataset at data_folder_path '" + filepath + "'");
+      }
+
+      // Parse file
+      std::vector<std::string> dataset;
+      if (format == Format::Newline) {
+         size_t begin = 0;
+         for (size_t i = 0; i <= buffer.size(); i++) {
+            if (i < buffer.size() && buffer[i] != '\n')
+               continue;
+
+            auto end = i;
+            if (end > begin && buffer[end - 1] == '\r')
+               end--;
+            if (end > begin)
+               dataset.emplace_back(buffer.data() + begin, end - begin);
+            begin = i + 1;
+         }
+      } else {
+         size_t offset = 0;
+         while (offset + sizeof(uint32_t) <= buffer.size()) {
+            const auto* b = reinterpret_cast<const unsigned char*>(buffer.data() + offset);
+            const size_t length = b[0] | (b[1] << 8) | (b[2] << (2 * 8)) | (static_cast<size_t>(b[3]) << (3 * 8));
+            offset += sizeof(uint32_t);
+
+            if (offset + length > buffer.size())
+               throw std::runtime_error("Dataset at data_folder_path '" + filepath + "' is truncated");
+            dataset.emplace_back(buffer.data() + offset, length);
+            offset += length;
+         }
+      }
+
+#ifdef VERBOSE
+      {
+         std::unique_lock<std::mutex> lock(iomutex);
+         std::cout << "Sorting ... " << std::flush;
+      }
+#endif
+      Dataset::sort(dataset);
+
+#ifdef VERBOSE
+      {
+         std::unique_lock<std::mutex> lock(iomutex);
+         std::cout << "Removing duplicates ... " << std::flush;
+      }
+#endif
+      Dataset::deduplicate(dataset);
+
+#ifdef VERBOSE
+      {
+         std::unique_lock<std::mutex> lock(iomutex);
+         std::cout << "Fisher-Yates shuffling ... " << std::flush;
+      }
+#endif
+      Dataset::shuffle(dataset);
+      dataset.shrink_to_fit();
+
+#ifdef VERBOSE
+      {
+         std::unique_lock<std::mutex> lock(iomutex);
+         std::cout << "done. " << dataset.size() << " elements loaded" << std::endl;
+      }
+#endif
+
+      return dataset;
+   }
+};
+
+/**
+ * Overloading of the >> operator for parsing with cxxopts
+ * @param is
+ * @param ds
+ * @return
+ */
+std::istream& operator>>(std::istream& is, StringDataset& ds) {
+   char ch = 0;
+   while (!is.eof()) {
+      is >> std::noskipws >> ch;
+      if (ch == ':')
+         break;
+      ds.filepath += ch;
+   };
+   if (is.eof()) {
+      throw std::runtime_error("Failed to parse dataset " + ds.filepath + ": Format not specified");
+   }
+
+   std::string format;
+   is >> std::skipws >> format;
+   if (format == "newline")
+      ds.format = StringDataset::Format::Newline;
+   else if (format == "prefixed")
+      ds.format = StringDataset::Format::LengthPrefixed;
+   else
+      throw std::runtime_error("Failed to parse dataset " + ds.filepath + ": Unknown format '" + format +
+                               "', expected 'newline' or 'prefixed'");
+   return is;
+}
@@ -8,9 +8,6 @@ struct Murmur3FinalizerCuckoo2Func {
    }
 
    forceinline HASH_64 operator()(const HASH_64& key, const HASH_64& h1) const {
-      return fin(key ^ h1);
+      return MurmurFinalizer<HASH_64>{}(key ^ h1);
    }
-
-  private:
-   MurmurFinalizer<HASH_64> fin;
 };
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#ifdef __linux__
+   #include <linux/perf_event.h>
+   #include <sys/ioctl.h>
+   #include <sys/syscall.h>
+   #include <unistd.h>
+#endif
+
+namespace Perf {
+   /**
+    * Counts L1 data cache read misses of the calling thread (user space only)
+    * via perf_event_open(2). Counting is unavailable (valid() = false) on other
+    * platforms or if the kernel denies access, e.g., due to perf_event_paranoid
+    */
+   struct L1DMissCounter {
+      L1DMissCounter() {
+#ifdef __linux__
+         perf_event_attr attr;
+         std::memset(&attr, 0, sizeof(attr));
+         attr.size = sizeof(attr);
+         attr.type = PERF_TYPE_HW_CACHE;
+         attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+         attr.disabled = 1;
+         attr.exclude_kernel = 1;
+         attr.exclude_hv = 1;
+
+         fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+      }
+
+      ~L1DMissCounter() {
+#ifdef __linux__
+         if (valid())
+            close(fd);
+#endif
+      }
+
+      L1DMissCounter(const L1DMissCounter&) = delete;
+      L1DMissCounter& operator=(const L1DMissCounter&) = delete;
+
+      bool valid() const {
+         return fd >= 0;
+      }
+
+      void start() {
+#ifdef __linux__
+         if (!valid())
+            return;
+         ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+         ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+      }
+
+      /**
+       * @return misses since the last start(), 0 if counting is unavailable
+       */
+      std::uint64_t stop() {
+         std::uint64_t count = 0;
+#ifdef __linux__
+         if (!valid())
+            return count;
+         ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+         if (read(fd, &count, sizeof(count)) != sizeof(count))
+            count = 0;
+#endif
+         return count;
+      }
+
+     private:
+      int fd = -1;
+   };
+} // namespace Perf
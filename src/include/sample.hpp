@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <convenience.hpp>
+
+namespace Sampling {
+   /**
+    * Bernoulli sample of [begin, end), i.e., each key is taken independently
+    * with probability rate. Instead of drawing a random number per key, the
+    * gap to the next sampled key is drawn from a geometric distribution, i.e.,
+    * cost is proportional to the sample size instead of the input size.
+    * Keys keep their relative order, hence sampling sorted input yields a
+    * sorted sample
+    */
+   template<class Data>
+   void bernoulli(const Data* begin, const Data* end, const double rate, std::vector<Data>& sample,
+                  const uint64_t seed = std::random_device()()) {
+      const auto size = static_cast<size_t>(end - begin);
+      if (rate >= 1.0) {
+         sample.insert(sample.end(), begin, end);
+         return;
+      }
+      if (rate <= 0.0)
+         return;
+
+      sample.reserve(sample.size() + static_cast<size_t>(rate * static_cast<double>(size) * 1.05) + 16);
+      std::mt19937_64 gen(seed);
+      std::geometric_distribution<size_t> skip(rate);
+      for (size_t i = skip(gen); i < size; i += skip(gen) + 1)
+         sample.push_back(begin[i]);
+   }
+
+   template<class Data>
+   std::vector<Data> bernoulli(const std::vector<Data>& dataset, const double rate,
+                               const uint64_t seed = std::random_device()()) {
+      std::vector<Data> sample;
+      bernoulli(dataset.data(), dataset.data() + dataset.size(), rate, sample, seed);
+      return sample;
+   }
+
+   /**
+    * Bernoulli sample of dataset, drawn in parallel: dataset is split into
+    * thread_count contiguous strata, each of which is sampled independently
+    * (see bernoulli()) by its own thread. Strata are concatenated in order,
+    * i.e., sampling sorted input still yields a sorted sample
+    */
+   template<class Data>
+   std::vector<Data> stratified(const std::vector<Data>& dataset, const double rate, const size_t thread_count,
+                                const uint64_t seed = std::random_device()()) {
+      // Spawning threads only pays off for large strata
+      constexpr size_t MinStratumSize = 1 << 20;
+      const auto strata_count =
+         std::clamp(dataset.size() / MinStratumSize, static_cast<size_t>(1), std::max(thread_count, size_t(1)));
+      if (strata_count == 1)
+         return bernoulli(dataset, rate, seed);
+
+      std::vector<std::vector<Data>> strata(strata_count);
+      std::vector<std::thread> threads;
+      for (size_t s = 0; s < strata_count; s++)
+         threads.emplace_back([&, s] {
+            const auto begin = dataset.data() + s * dataset.size() / strata_count;
+            const auto end = dataset.data() + (s + 1) * dataset.size() / strata_count;
+            bernoulli(begin, end, rate, strata[s], seed + s * 0x9E3779B97F4A7C15LLU);
+         });
+      for (auto& t : threads)
+         t.join();
+
+      size_t sample_size = 0;
+      for (const auto& stratum : strata)
+         sample_size += stratum.size();
+
+      std::vector<Data> sample;
+      sample.reserve(sample_size);
+      for (const auto& stratum : strata)
+         sample.insert(sample.end(), stratum.begin(), stratum.end());
+      return sample;
+   }
+
+   /**
+    * Sorted Bernoulli sample of a (shuffled) dataset, as required to train
+    * learned models. Prefer sampling the sorted dataset, e.g., via
+    * Dataset::load_as()'s sorted hook, which makes the sort obsolete
+    */
+   template<class Data>
+   std::vector<Data> sorted_sample(const std::vector<Data>& dataset, const double rate, const size_t thread_count = 1,
+                                   const uint64_t seed = std::random_device()()) {
+      auto sample = stratified(dataset, rate, thread_count, seed);
+      std::sort(sample.begin(), sample.end());
+      return sample;
+   }
+} // namespace Sampling
@@ -0,0 +1,254 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <convenience.hpp>
+#include <hashtable.hpp>
+#include <learned_models.hpp>
+
+#include "include/args.hpp"
+#include "include/csv.hpp"
+#include "include/functors/hash_functors.hpp"
+#include "include/sample.hpp"
+
+using Args = BenchmarkArgs::SnapshotHashArgs;
+
+const std::vector<std::string> csv_columns = {
+   // General statistics
+   "dataset", "numelements", "load_factor", "bucket_size", "hashtable", "hash", "reducer", "payload", "snapshot_bytes",
+
+   // Cold start (build from scratch vs. mmap open)
+   "build_nanoseconds_total", "save_nanoseconds_total", "open_nanoseconds_total",
+
+   // Lookup passes over every key
+   "built_lookup_nanoseconds_total", "cold_lookup_nanoseconds_total", "warm_lookup_nanoseconds_total"
+
+   //
+};
+
+template<class Data>
+struct Payload16 {
+   uint64_t q0 = 0, q1 = 0;
+   explicit Payload16(const Data& key) : q0(key + 1), q1(key + 2) {}
+   explicit Payload16() {}
+
+   bool operator==(const Payload16& other) const {
+      return q0 == other.q0 && q1 == other.q1;
+   }
+} packed;
+
+/**
+ * Drops the file's pages from the page cache (if possible), i.e., the
+ * next access has to hit the disk as it would on a freshly started machine
+ */
+static void evict_page_cache(const std::string& path) {
+   const int fd = ::open(path.c_str(), O_RDONLY);
+   if (fd < 0)
+      return;
+   ::fdatasync(fd);
+   ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+   ::close(fd);
+}
+
+/**
+ * Looks up every key once, throwing if any key is missing or maps to a wrong payload
+ *
+ * @return total nanoseconds spent on all lookups
+ */
+template<class Hashtable, class Data>
+static uint64_t lookup_all(const Hashtable& hashtable, const std::vector<Data>& dataset) {
+   const auto start_time = std::chrono::steady_clock::now();
+   size_t misses = 0;
+   for (const auto& key : dataset) {
+      const auto payload = hashtable.lookup(key);
+      misses += !payload || !(*payload == Payload16<Data>(key)) ? 1 : 0;
+   }
+   const auto end_time = std::chrono::steady_clock::now();
+
+   if (misses > 0)
+      throw std::runtime_error(std::to_string(misses) + " keys were not found");
+
+   return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count());
+}
+
+/**
+ * Measures building a hashtable from scratch vs. opening its snapshot via mmap
+ *
+ * @param make constructs an empty hashtable for a given capacity, including
+ *    (potentially expensive) hash function construction such as model training
+ */
+template<class Hashtable, class Data, class Make>
+static void measure(const std::string& dataset_name, const std::vector<Data>& dataset, const double load_factor,
+                    const std::string& snapshot_dir, const Make& make, CSV& outfile, std::mutex& iomutex) {
+   const auto str = [](auto s) { return std::to_string(s); };
+   const auto ns_since = [](const auto& start_time) {
+      return static_cast<uint64_t>(
+         std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count());
+   };
+
+   std::map<std::string, std::string> datapoint({{"dataset", dataset_name},
+                                                 {"numelements", str(dataset.size())},
+                                                 {"load_factor", str(load_factor)},
+                                                 {"bucket_size", str(Hashtable::bucket_size())},
+                                                 {"hashtable", Hashtable::name()},
+                                                 {"payload", str(sizeof(typename Hashtable::PayloadType))},
+                                                 {"hash", Hashtable::hash_name()},
+                                                 {"reducer", Hashtable::reducer_name()}});
+
+   if (outfile.exists(datapoint)) {
+      std::unique_lock<std::mutex> lock(iomutex);
+      std::cout << "Skipping (";
+      auto iter = datapoint.begin();
+      while (iter != datapoint.end()) {
+         std::cout << iter->first << ": " << iter->second;
+
+         iter++;
+         if (iter != datapoint.end())
+            std::cout << ", ";
+      }
+      std::cout << ") since it already exist" << std::endl;
+      return;
+   }
+
+   const auto path = (std::filesystem::path(snapshot_dir) /
+                      (dataset_name + "_" + Hashtable::name() + "_" + Hashtable::hash_name() + ".snapshot"))
+                        .string();
+   try {
+      const auto ht_capacity = static_cast<uint64_t>(static_cast<double>(dataset.size()) / load_factor);
+
+      {
+         // Build from scratch
+         auto start_time = std::chrono::steady_clock::now();
+         Hashtable hashtable = make(ht_capacity);
+         for (const auto& key : dataset)
+            hashtable.insert(key, Payload16<Data>(key));
+         datapoint.emplace("build_nanoseconds_total", str(ns_since(start_time)));
+         datapoint.emplace("built_lookup_nanoseconds_total", str(lookup_all(hashtable, dataset)));
+
+         start_time = std::chrono::steady_clock::now();
+         hashtable.save(path);
+         datapoint.emplace("save_nanoseconds_total", str(ns_since(start_time)));
+      }
+      datapoint.emplace("snapshot_bytes", str(std::filesystem::file_size(path)));
+      evict_page_cache(path);
+
+      {
+         // Open snapshot. First lookup pass faults pages in from disk
+         const auto start_time = std::chrono::steady_clock::now();
+         const auto hashtable = Hashtable::open_mmap(path);
+         const auto open_ns = ns_since(start_time);
+         const auto cold_ns = lookup_all(hashtable, dataset);
+         const auto warm_ns = lookup_all(hashtable, dataset);
+
+         datapoint.emplace("open_nanoseconds_total", str(open_ns));
+         datapoint.emplace("cold_lookup_nanoseconds_total", str(cold_ns));
+         datapoint.emplace("warm_lookup_nanoseconds_total", str(warm_ns));
+
+#ifdef VERBOSE
+         std::unique_lock<std::mutex> lock(iomutex);
+         std::cout << std::setw(55) << std::right
+                   << Hashtable::name() + "<" + Hashtable::reducer_name() + "(" + Hashtable::hash_name() +
+               ")> build took "
+                   << nanoseconds_to_seconds(std::stoull(datapoint["build_nanoseconds_total"])) << " s, open took "
+                   << nanoseconds_to_seconds(open_ns) << " s (+" << nanoseconds_to_seconds(cold_ns)
+                   << " s for first lookup pass)" << std::endl;
+#endif
+      }
+   } catch (const std::exception& e) {
+      std::unique_lock<std::mutex> lock(iomutex);
+      std::cout << std::setw(55) << std::right
+                << Hashtable::reducer_name() + "(" + Hashtable::hash_name() + ") failed: " << e.what() << std::endl;
+   }
+   std::filesystem::remove(path);
+
+   // Write to csv (if experiment failed this will visibly log that)
+   outfile.write(datapoint);
+}
+
+template<class Hashfn, class Data>
+static void measure_tables(const std::string& dataset_name, const std::vector<Data>& dataset, const double load_factor,
+                           const std::string& snapshot_dir, CSV& outfile, std::mutex& iomutex) {
+   using namespace Reduction;
+
+   using Probing =
+      Hashtable::Probing<Data, Payload16<Data>, Hashfn, FastModulo<HASH_64>, Hashtable::LinearProbingFunc, 4>;
+   measure<Probing>(
+      dataset_name, dataset, load_factor, snapshot_dir, [](const size_t& capacity) { return Probing(capacity); },
+      outfile, iomutex);
+
+   using Robinhood =
+      Hashtable::RobinhoodProbing<Data, Payload16<Data>, Hashfn, FastModulo<HASH_64>, Hashtable::LinearProbingFunc, 4>;
+   measure<Robinhood>(
+      dataset_name, dataset, load_factor, snapshot_dir, [](const size_t& capacity) { return Robinhood(capacity); },
+      outfile, iomutex);
+
+   using Cuckoo = Hashtable::Cuckoo<Data, Payload16<Data>, 8, Hashfn, Murmur3FinalizerCuckoo2Func, FastModulo<HASH_64>,
+                                    FastModulo<HASH_64>, Hashtable::BalancedKicking>;
+   measure<Cuckoo>(
+      dataset_name, dataset, load_factor, snapshot_dir, [](const size_t& capacity) { return Cuckoo(capacity); },
+      outfile, iomutex);
+}
+
+template<class Hashfn, class Data>
+static void measure_learned(const std::string& dataset_name, const std::vector<Data>& dataset,
+                            const double load_factor, const std::string& snapshot_dir, CSV& outfile,
+                            std::mutex& iomutex) {
+   using namespace Reduction;
+
+   // Rebuilding includes training on a 1% sample
+   const auto make_sample = [&]() { return Sampling::sorted_sample(dataset, 0.01); };
+
+   using Probing = Hashtable::Probing<Data, Payload16<Data>, Hashfn, Clamp<HASH_64>, Hashtable::LinearProbingFunc, 4>;
+   measure<Probing>(
+      dataset_name, dataset, load_factor, snapshot_dir,
+      [&](const size_t& capacity) {
+         const auto sample = make_sample();
+         return Probing(capacity,
+                        Hashfn(sample.begin(), sample.end(), Probing::directory_address_count(capacity)));
+      },
+      outfile, iomutex);
+}
+
+template<class Data>
+static void benchmark(const std::string& dataset_name, const std::vector<Data>& dataset,
+                      const std::vector<double>& load_factors, const std::string& snapshot_dir, CSV& outfile,
+                      std::mutex& iomutex) {
+   for (const auto load_factor : load_factors) {
+      measure_tables<MurmurFinalizer<Data>>(dataset_name, dataset, load_factor, snapshot_dir, outfile, iomutex);
+      measure_tables<LargeTabulationHash<Data>>(dataset_name, dataset, load_factor, snapshot_dir, outfile, iomutex);
+      measure_tables<XXHash3<Data>>(dataset_name, dataset, load_factor, snapshot_dir, outfile, iomutex);
+
+      measure_learned<rmi::RMIHash<Data, 100000>>(dataset_name, dataset, load_factor, snapshot_dir, outfile,
+                                                  iomutex);
+      measure_learned<rs::RadixSplineHash<Data, 18, 32>>(dataset_name, dataset, load_factor, snapshot_dir, outfile,
+                                                         iomutex);
+   }
+}
+
+int main(int argc, char* argv[]) {
+   try {
+      auto args = Args(argc, argv);
+
+      CSV outfile(args.outfile, csv_columns);
+      std::mutex iomutex;
+      std::filesystem::create_directories(args.snapshot_dir);
+
+      for (const auto& it : args.datasets) {
+         const auto dataset = it.load(iomutex);
+         benchmark(it.name(), dataset, args.load_factors, args.snapshot_dir, outfile, iomutex);
+      }
+   } catch (const std::exception& ex) {
+      std::cerr << ex.what() << std::endl;
+      return -1;
+   }
+
+   return 0;
+}
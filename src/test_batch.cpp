@@ -0,0 +1,114 @@
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <convenience.hpp>
+#include <hashing.hpp>
+#include <reduction.hpp>
+
+#include "include/check.hpp"
+
+/**
+ * Checks that hash_batch() yields exactly the scalar hashes. n is odd, i.e.,
+ * vectorized kernels also have to get their scalar tail right
+ */
+template<class Hashfn, class Data>
+static void check_hash(const std::vector<Data>& keys, Hashfn hashfn = Hashfn()) {
+   std::vector<HASH_64> hashes(keys.size());
+   hash_batch(hashfn, keys.data(), hashes.data(), keys.size());
+
+   size_t mismatches = 0;
+   for (size_t i = 0; i < keys.size(); i++)
+      mismatches += hashes[i] != static_cast<HASH_64>(hashfn(keys[i]));
+   CHECK(mismatches == 0);
+
+   std::cout << Hashfn::name() << " batch checked (" << Cpu::isa_name() << ")" << std::endl;
+}
+
+/**
+ * Checks that reduce_batch() yields exactly the scalar reduced values, in place and out of place
+ */
+template<class Reducefn>
+static void check_reduce(const std::vector<HASH_64>& hashes, const size_t& num_buckets) {
+   const Reducefn reducefn(num_buckets);
+
+   std::vector<HASH_64> reduced(hashes.size());
+   reduce_batch(reducefn, hashes.data(), reduced.data(), hashes.size());
+   std::vector<HASH_64> in_place(hashes);
+   reduce_batch(reducefn, in_place.data(), in_place.data(), in_place.size());
+
+   size_t mismatches = 0;
+   for (size_t i = 0; i < hashes.size(); i++) {
+      const auto expected = static_cast<HASH_64>(reducefn(hashes[i]));
+      mismatches += reduced[i] != expected || in_place[i] != expected || expected >= num_buckets;
+   }
+   CHECK(mismatches == 0);
+
+   std::cout << Reducefn::name() << " batch checked for " << num_buckets << " buckets" << std::endl;
+}
+
+/**
+ * Checks that HashPipeline hands every key to the consumer, in order, with its scalar slot index
+ */
+template<class Hashfn, class Reducefn, size_t Depth, size_t BatchSize>
+static void check_pipeline(const std::vector<uint64_t>& keys, const size_t& num_buckets) {
+   const Hashfn hashfn;
+   const Reducefn reducefn(num_buckets);
+   Reduction::HashPipeline<Hashfn, Reducefn, Depth, BatchSize> pipeline(reducefn, hashfn);
+
+   std::vector<uint64_t> slots(num_buckets);
+   size_t consumed = 0, mismatches = 0;
+   pipeline.stream(
+      keys.data(), keys.size(), [&](const auto& index) { return &slots[index]; },
+      [&](const auto& key, const auto& index) {
+         mismatches += key != keys[consumed] || index != reducefn(hashfn(key));
+         consumed++;
+      });
+   CHECK(consumed == keys.size());
+   CHECK(mismatches == 0);
+}
+
+int main() {
+   using namespace Reduction;
+
+   const auto keys64 = Check::distinct_keys<uint64_t>(10'007);
+   const auto keys32 = Check::distinct_keys<uint32_t>(10'007);
+
+   check_hash<MurmurFinalizer<uint64_t>>(keys64);
+   check_hash<MurmurFinalizer<uint32_t>>(keys32);
+   check_hash<PrimeMultiplicationHash64>(keys64);
+   check_hash<FibonacciHash64>(keys64);
+   check_hash<MultAddHash64>(keys64);
+   check_hash<XXHash3<uint64_t>>(keys64);
+   check_hash<LargeTabulationHash<uint64_t>>(keys64);
+   check_hash<CompactTabulationHash<uint64_t>>(keys64);
+   check_hash<TwistedTabulationHash<uint64_t>>(keys64);
+   if (Cpu::has_aes()) {
+      check_hash<AquaHash<uint64_t>>(keys64);
+      check_hash<AquaHash<uint32_t>>(keys32);
+      check_hash<MeowHash64<uint64_t>>(keys64);
+      check_hash<MeowHash64<uint32_t>>(keys32);
+   }
+
+   MurmurFinalizer<uint64_t> murmur;
+   std::vector<HASH_64> hashes(keys64.size());
+   hash_batch(murmur, keys64.data(), hashes.data(), hashes.size());
+   // Include the extremes, where multiply-high based reductions are most likely off by one
+   hashes.push_back(0);
+   hashes.push_back(~0LLU);
+
+   // libdivide's branchfree dividers (BranchlessFastModulo) do not support 1
+   for (const size_t num_buckets : {7LLU, 1000LLU, 1LLU << 20, (1LLU << 32) + 15}) {
+      check_reduce<FastModulo<HASH_64>>(hashes, num_buckets);
+      check_reduce<BranchlessFastModulo<HASH_64>>(hashes, num_buckets);
+      check_reduce<DirectFastMod<HASH_64>>(hashes, num_buckets);
+      check_reduce<Fastrange<HASH_64>>(hashes, num_buckets);
+   }
+   check_reduce<PowerOfTwoMask<HASH_64>>(hashes, 1LLU << 20);
+
+   check_pipeline<MurmurFinalizer<uint64_t>, FastModulo<HASH_64>, 16, 256>(keys64, 1000);
+   check_pipeline<XXHash3<uint64_t>, Fastrange<HASH_64>, 0, 64>(keys64, 1 << 20);
+
+   return Check::result();
+}
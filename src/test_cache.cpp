@@ -0,0 +1,72 @@
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <convenience.hpp>
+#include <learned_models.hpp>
+
+#include "include/check.hpp"
+
+/**
+ * Checks that a saved model loads back with identical hashes, but only for
+ * the (dataset, sample rate, output range) it was trained on
+ */
+template<class Hashfn>
+static void check_round_trip(const learned::ModelCache& cache, const std::vector<uint64_t>& dataset,
+                             const std::vector<uint64_t>& sample) {
+   constexpr double SampleRate = 0.01;
+   const auto full_size = dataset.size();
+   const Hashfn hashfn(sample.begin(), sample.end(), full_size);
+
+   CHECK(!cache.load<Hashfn>(dataset, SampleRate, full_size).has_value());
+   cache.save(hashfn, dataset, SampleRate, full_size);
+
+   const auto loaded = cache.load<Hashfn>(dataset, SampleRate, full_size);
+   CHECK(loaded.has_value());
+   if (loaded.has_value()) {
+      size_t mismatches = 0;
+      for (const auto& key : dataset)
+         mismatches += (*loaded)(key) != hashfn(key);
+      CHECK(mismatches == 0);
+      CHECK(loaded->byte_size() == hashfn.byte_size());
+   }
+
+   CHECK(!cache.load<Hashfn>(dataset, SampleRate * 2, full_size).has_value());
+   CHECK(!cache.load<Hashfn>(dataset, SampleRate, full_size + 1).has_value());
+   const std::vector<uint64_t> other(dataset.begin(), dataset.end() - 1);
+   CHECK(!cache.load<Hashfn>(other, SampleRate, full_size).has_value());
+
+   std::cout << Hashfn::name() << " round trip checked" << std::endl;
+}
+
+int main() {
+   const auto directory = std::filesystem::temp_directory_path() / "test_cache_models";
+   std::filesystem::remove_all(directory);
+   const learned::ModelCache cache(directory);
+
+   const auto dataset = Check::distinct_keys<uint64_t>(100'000);
+   std::vector<uint64_t> sample;
+   for (size_t i = 0; i < dataset.size(); i += 100)
+      sample.push_back(dataset[i]);
+   std::sort(sample.begin(), sample.end());
+
+   check_round_trip<rmi::RMIHash<uint64_t, 100>>(cache, dataset, sample);
+   check_round_trip<rmi::RMI<uint64_t, rmi::Layers<rmi::LinearImpl, rmi::LinearImpl>, rmi::Sizes<1, 100>>>(
+      cache, dataset, sample);
+   check_round_trip<rs::RadixSplineHash<uint64_t>>(cache, dataset, sample);
+   // PGMHash persists PGMIndex's members through a mirror of its layout, i.e., catches layout drift of PGM updates
+   check_round_trip<PGMHash<uint64_t, 16, 4>>(cache, dataset, sample);
+
+   // Truncated files (e.g., a full disk while saving) are misses, not garbage models
+   using Hashfn = rmi::RMIHash<uint64_t, 100>;
+   for (const auto& entry : std::filesystem::directory_iterator(directory))
+      if (entry.path().filename().string().rfind(Hashfn::name(), 0) == 0)
+         std::filesystem::resize_file(entry.path(), std::filesystem::file_size(entry.path()) - 1);
+   CHECK(!cache.load<Hashfn>(dataset, 0.01, dataset.size()).has_value());
+
+   std::filesystem::remove_all(directory);
+   return Check::result();
+}
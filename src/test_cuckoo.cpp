@@ -0,0 +1,54 @@
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include <hashing.hpp>
+#include <hashtable.hpp>
+#include <reduction.hpp>
+
+#include "include/check.hpp"
+
+using Family = MultiplyShiftFamily<uint64_t>;
+using Table = Hashtable::Cuckoo<uint64_t, uint64_t, 4, Family, DoubleHashingCuckoo2Func, Reduction::FastModulo<HASH_64>,
+                                Reduction::FastModulo<HASH_64>, Hashtable::BalancedKicking>;
+
+static size_t count_found(const Table& table, const std::vector<uint64_t>& keys, const size_t& n) {
+   size_t found = 0;
+   for (size_t i = 0; i < n; i++) {
+      const auto payload = table.lookup(keys[i]);
+      found += payload.has_value() && payload.value() == keys[i] + 1;
+   }
+   return found;
+}
+
+int main() {
+   const auto keys = Check::distinct_keys<uint64_t>(100'000);
+
+   {
+      // Full cuckoo tables with 4 slots per bucket only build at high load factors
+      // if failed kick cycles are resolved by rehashing
+      Table table(static_cast<size_t>(static_cast<double>(keys.size()) / 0.97));
+      for (const auto& key : keys)
+         table.insert(key, key + 1);
+      CHECK(count_found(table, keys, keys.size()) == keys.size());
+   }
+
+   {
+      // A table with more keys than slots has to give up eventually. Giving up
+      // must restore the table, i.e., it may only lose the entry displaced last
+      Table table(64);
+      size_t inserted = 0;
+      bool gave_up = false;
+      for (; inserted < 128 && !gave_up; inserted++) {
+         try {
+            table.insert(keys[inserted], keys[inserted] + 1);
+         } catch (const std::runtime_error&) {
+            gave_up = true;
+         }
+      }
+      CHECK(gave_up);
+      CHECK(count_found(table, keys, inserted) == inserted - 1);
+   }
+
+   return Check::result();
+}
@@ -0,0 +1,95 @@
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <convenience.hpp>
+#include <filter.hpp>
+#include <hashing.hpp>
+#include <hashtable.hpp>
+#include <reduction.hpp>
+
+#include "include/check.hpp"
+
+/**
+ * Inserts members at the given load factor and checks that
+ *  1. no member is reported absent, neither right after inserting nor after erasing every other member
+ *  2. the false positive rate measured on nonmembers lies within [min_fpr, max_fpr], the range of the filter's
+ *     expected false positive rate, widened by four standard deviations of the measurement's sampling noise
+ */
+template<class Filter>
+static void check_filter(const std::vector<uint64_t>& members, const std::vector<uint64_t>& nonmembers,
+                         const double load_factor, const double min_fpr, const double max_fpr) {
+   const auto name = Filter::name() + "<" + Filter::reducer_name() + "(" + Filter::hash_name() + ")>";
+   Filter filter(static_cast<size_t>(static_cast<double>(members.size()) / load_factor));
+
+   size_t inserted = 0;
+   for (const auto& key : members)
+      inserted += filter.insert(key);
+   CHECK(inserted == members.size());
+   CHECK(filter.size() == members.size());
+
+   size_t false_negatives = 0;
+   for (const auto& key : members)
+      false_negatives += !filter.contains(key);
+   CHECK(false_negatives == 0);
+
+   size_t false_positives = 0;
+   for (const auto& key : nonmembers)
+      false_positives += filter.contains(key);
+   const auto fpr = static_cast<double>(false_positives) / static_cast<double>(nonmembers.size());
+   const auto noise = [&](const double p) {
+      return 4.0 * std::sqrt(p * (1.0 - p) / static_cast<double>(nonmembers.size()));
+   };
+   CHECK(fpr >= min_fpr - noise(min_fpr));
+   CHECK(fpr <= max_fpr + noise(max_fpr));
+
+   // Erasing members must not remove other members' fingerprints/remainders
+   size_t erased = 0;
+   for (size_t i = 0; i < members.size(); i += 2)
+      erased += filter.erase(members[i]);
+   CHECK(erased == (members.size() + 1) / 2);
+
+   false_negatives = 0;
+   for (size_t i = 1; i < members.size(); i += 2)
+      false_negatives += !filter.contains(members[i]);
+   CHECK(false_negatives == 0);
+
+   std::cout << name << " at load factor " << load_factor << ": fpr " << fpr << " (expected " << min_fpr << " to "
+             << max_fpr << ")" << std::endl;
+}
+
+int main() {
+   using Hashfn = MurmurFinalizer<uint64_t>;
+   using Reducer = Reduction::FastModulo<HASH_64>;
+
+   const auto keys = Check::distinct_keys<uint64_t>(1'200'000);
+   const std::vector<uint64_t> members(keys.begin(), keys.begin() + 200'000);
+   const std::vector<uint64_t> nonmembers(keys.begin() + 200'000, keys.end());
+
+   // A cuckoo filter lookup compares at most 2 * BucketSize fingerprints, each matching with chance
+   // 2^-FingerprintBits, i.e., its expected false positive rate is at most 2 * BucketSize * 2^-FingerprintBits
+   const auto cuckoo_bound = [](const size_t fingerprint_bits) {
+      return 2.0 * 4.0 / std::pow(2.0, static_cast<double>(fingerprint_bits));
+   };
+   // A quotient filter lookup compares all remainders of its quotient's run. Run lengths are Poisson distributed
+   // with mean load_factor, each remainder matches with chance p = 2^-RemainderBits, i.e., the expected false
+   // positive rate is exactly sum_k Poisson(k) * (1 - (1 - p)^k) = 1 - e^(-load_factor * p), just below
+   // load_factor * p. Measured rates scatter around it, on both sides
+   const auto quotient_fpr = [](const size_t remainder_bits, const double load_factor) {
+      return 1.0 - std::exp(-load_factor / std::pow(2.0, static_cast<double>(remainder_bits)));
+   };
+
+   for (const auto load_factor : {0.5, 0.9}) {
+      check_filter<Filter::Cuckoo<uint64_t, 12, Hashfn, Reducer, Hashtable::BalancedKicking>>(
+         members, nonmembers, load_factor, 0, cuckoo_bound(12));
+      check_filter<Filter::Cuckoo<uint64_t, 16, Hashfn, Reducer, Hashtable::BiasedKicking<10>>>(
+         members, nonmembers, load_factor, 0, cuckoo_bound(16));
+
+      const auto fpr8 = quotient_fpr(8, load_factor), fpr16 = quotient_fpr(16, load_factor);
+      check_filter<Filter::Quotient<uint64_t, 8, Hashfn, Reducer>>(members, nonmembers, load_factor, fpr8, fpr8);
+      check_filter<Filter::Quotient<uint64_t, 16, Hashfn, Reducer>>(members, nonmembers, load_factor, fpr16, fpr16);
+   }
+
+   return Check::result();
+}
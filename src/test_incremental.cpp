@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <convenience.hpp>
+#include <learned_models.hpp>
+
+#include "include/check.hpp"
+
+using Base = rmi::RMIHash<uint64_t, 100>;
+using Incremental = learned::IncrementalHash<uint64_t, Base, 256>;
+
+constexpr size_t FullSize = 1 << 16;
+
+/**
+ * Inserts keys, feeding back each slot's chain length, and waits for all retrains
+ */
+static void insert(Incremental& hashfn, std::vector<size_t>& chains, const std::vector<uint64_t>& keys) {
+   for (const auto& key : keys) {
+      const auto slot = hashfn(key);
+      hashfn.feedback(key, slot, ++chains[slot]);
+   }
+   hashfn.sync();
+}
+
+/**
+ * Checks routing after patches were swapped in: keys of unpatched slots keep
+ * their base model slot, keys of patched slots stay within the widest
+ * retrained range containing their base slot (windows only ever widen), and
+ * batched hashing agrees with operator()
+ */
+static void check_routing(const Incremental& hashfn, const Base& base,
+                          const std::vector<Incremental::SlotRange>& retrained, const std::vector<uint64_t>& queries) {
+   size_t misrouted = 0;
+   for (const auto& key : queries) {
+      const auto base_slot = std::min(base(key), FullSize);
+      const auto slot = hashfn(key);
+
+      Incremental::SlotRange window{base_slot, base_slot + 1};
+      bool patched = false;
+      for (const auto& range : retrained)
+         if (range.begin <= base_slot && base_slot < range.end && range.end - range.begin >= window.end - window.begin) {
+            window = range;
+            patched = true;
+         }
+      misrouted += patched ? slot < window.begin || slot >= window.end : slot != base_slot;
+   }
+   CHECK(misrouted == 0);
+
+   std::vector<size_t> hashes(queries.size());
+   hashfn(queries.data(), hashes.data(), queries.size());
+   size_t mismatches = 0;
+   for (size_t i = 0; i < queries.size(); i++)
+      mismatches += hashes[i] != hashfn(queries[i]);
+   CHECK(mismatches == 0);
+}
+
+static size_t distinct_slots(const Incremental& hashfn, const std::vector<uint64_t>& keys) {
+   std::vector<size_t> slots;
+   for (const auto& key : keys)
+      slots.push_back(hashfn(key));
+   std::sort(slots.begin(), slots.end());
+   return static_cast<size_t>(std::unique(slots.begin(), slots.end()) - slots.begin());
+}
+
+int main() {
+   // Uniform keys in [0, 2^40), drifted keys crowd a 2^20 wide range that the base model maps to a single slot
+   std::mt19937_64 rng(42);
+   std::vector<uint64_t> uniform(FullSize / 2), drifted(FullSize / 4);
+   for (auto& key : uniform)
+      key = rng() >> 24;
+   for (auto& key : drifted)
+      key = (1LLU << 39) + (rng() >> 44);
+
+   auto sample = uniform;
+   std::sort(sample.begin(), sample.end());
+   sample.erase(std::unique(sample.begin(), sample.end()), sample.end());
+   const Base base(sample.begin(), sample.end(), FullSize);
+
+   auto queries = uniform;
+   queries.insert(queries.end(), drifted.begin(), drifted.end());
+   queries.insert(queries.end(), {0, 1, (1LLU << 39) - 1, (1LLU << 39) + (1LLU << 20), ~0LLU});
+
+   for (const double sample_rate : {0.05, 1.0}) {
+      Incremental hashfn(sample.begin(), sample.end(), FullSize, sample_rate);
+      std::vector<size_t> chains(FullSize + 1);
+      insert(hashfn, chains, uniform);
+      const auto crowded = distinct_slots(hashfn, drifted);
+      insert(hashfn, chains, drifted);
+
+      const auto retrained = hashfn.take_retrained();
+      CHECK(!retrained.empty());
+      CHECK(hashfn.statistics().retrain_count > 0);
+      check_routing(hashfn, base, retrained, queries);
+      // Patches spread drifted keys over their window
+      CHECK(distinct_slots(hashfn, drifted) > 100 * crowded);
+
+      hashfn.reclaim();
+      check_routing(hashfn, base, retrained, queries);
+
+      std::cout << "sample rate " << sample_rate << ": " << retrained.size() << " retrains, drifted keys on "
+                << distinct_slots(hashfn, drifted) << " instead of " << crowded << " slots" << std::endl;
+   }
+
+   {
+      // Without samples nothing is retrained, and pending feedback must not block destruction
+      Incremental hashfn(sample.begin(), sample.end(), FullSize, 0.0);
+      std::vector<size_t> chains(FullSize + 1);
+      insert(hashfn, chains, uniform);
+      insert(hashfn, chains, drifted);
+      CHECK(hashfn.take_retrained().empty());
+      check_routing(hashfn, base, {}, queries);
+
+      for (size_t i = 0; i < 100; i++)
+         hashfn.feedback(drifted[i], hashfn(drifted[i]), 2);
+   }
+
+   return Check::result();
+}
@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <convenience.hpp>
+#include <learned_models.hpp>
+
+#include "include/check.hpp"
+
+constexpr size_t NumRadixBits = 18;
+constexpr size_t MaxError = 32;
+
+/**
+ * Checks the RadixSpline contract on sorted keys: each key is found within its
+ * search bound, and estimated positions are monotone in the key
+ */
+static void check_spline(const rs::RadixSpline<uint64_t>& spline, const std::vector<uint64_t>& keys) {
+   size_t misses = 0, inversions = 0;
+   for (size_t i = 0; i < keys.size(); i++) {
+      const auto bound = spline.GetSearchBound(keys[i]);
+      misses += !std::binary_search(keys.begin() + bound.begin, keys.begin() + bound.end, keys[i]);
+      inversions += i > 0 && spline.GetEstimatedPosition(keys[i]) < spline.GetEstimatedPosition(keys[i - 1]);
+   }
+   CHECK(misses == 0);
+   CHECK(inversions == 0);
+}
+
+int main() {
+   // Runs of equal keys, i.e., chunk boundaries have to move to the start of their run
+   auto keys = Check::distinct_keys<uint64_t>(1'000'003);
+   std::sort(keys.begin(), keys.end());
+   for (const size_t run : {250'000, 500'001, 750'000})
+      std::fill(keys.begin() + run - 5000, keys.begin() + run + 5000, keys[run]);
+
+   const auto sequential = rs::Builder<uint64_t>::Build(keys.begin(), keys.end(), NumRadixBits, MaxError, 1);
+   check_spline(sequential, keys);
+
+   // 64 threads are capped by the minimum chunk size
+   for (const size_t thread_count : {2, 3, 8, 64}) {
+      const auto parallel =
+         rs::Builder<uint64_t>::Build(keys.begin(), keys.end(), NumRadixBits, MaxError, thread_count);
+      check_spline(parallel, keys);
+      // Each chunk boundary adds at most two spline points
+      CHECK(parallel.GetNumSplinePoints() <= sequential.GetNumSplinePoints() + 2 * (thread_count - 1));
+
+      std::cout << thread_count << " threads: " << parallel.GetNumSplinePoints() << " spline points ("
+                << sequential.GetNumSplinePoints() << " sequential)" << std::endl;
+   }
+
+   // Hash functions built in parallel persist like sequentially built ones
+   const auto full_size = keys.size();
+   const rs::RadixSplineHash<uint64_t, NumRadixBits, MaxError> hashfn(keys.begin(), keys.end(), full_size, 8);
+   std::stringstream stream;
+   hashfn.serialize(stream);
+   const auto copy = decltype(hashfn)::deserialize(stream);
+
+   size_t out_of_range = 0, mismatches = 0;
+   for (const auto& key : keys) {
+      out_of_range += hashfn(key) > full_size;
+      mismatches += copy(key) != hashfn(key);
+   }
+   CHECK(out_of_range == 0);
+   CHECK(mismatches == 0);
+
+   return Check::result();
+}
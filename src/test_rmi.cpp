@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <convenience.hpp>
+#include <learned_models.hpp>
+
+#include "include/check.hpp"
+
+/**
+ * Checks that batched inference yields exactly operator()'s hashes, both for
+ * keys within and outside of the trained key range
+ */
+template<class Model>
+static void check_batch(const Model& model, const std::vector<uint64_t>& keys) {
+   std::vector<size_t> hashes(keys.size());
+   model(keys.data(), hashes.data(), keys.size());
+
+   size_t mismatches = 0;
+   for (size_t i = 0; i < keys.size(); i++)
+      mismatches += hashes[i] != model(keys[i]);
+   CHECK(mismatches == 0);
+
+   std::cout << Model::name() << " batch checked" << std::endl;
+}
+
+/**
+ * Checks an RMI with compile time topology on its (sorted) training sample:
+ *  1. predictions stay within [0, full_size] and approximate the key's rank, i.e.,
+ *     the mean absolute error is below max_error * full_size
+ *  2. predictions are monotone if all layers are monotone
+ *  3. a deserialized copy yields identical predictions
+ */
+template<class Model>
+static void check_topology(const std::vector<uint64_t>& sample, const std::vector<uint64_t>& queries,
+                           const double max_error, const bool monotone) {
+   const auto full_size = sample.size();
+   const Model model(sample.begin(), sample.end(), full_size);
+
+   size_t out_of_range = 0, inversions = 0;
+   double error = 0;
+   for (size_t i = 0; i < sample.size(); i++) {
+      const auto prediction = model(sample[i]);
+      out_of_range += prediction > full_size;
+      inversions += i > 0 && prediction < model(sample[i - 1]);
+      error += std::abs(static_cast<double>(prediction) - static_cast<double>(i));
+   }
+   error /= static_cast<double>(sample.size());
+   CHECK(out_of_range == 0);
+   CHECK(error <= max_error * static_cast<double>(full_size));
+   if (monotone)
+      CHECK(inversions == 0);
+
+   std::stringstream stream;
+   model.serialize(stream);
+   const auto copy = Model::deserialize(stream);
+   size_t mismatches = 0;
+   for (const auto& key : queries)
+      mismatches += copy(key) != model(key);
+   CHECK(mismatches == 0);
+
+   std::cout << Model::name() << " mean absolute error " << error << " (" << model.byte_size() << " bytes)"
+             << std::endl;
+}
+
+/**
+ * Checks a QuantizedRMIHash against the RMIHash it quantizes: predictions on
+ * the training sample differ by at most one slot (truncation of slightly
+ * different doubles), and a deserialized copy yields identical predictions
+ */
+template<class Quantized, class Unquantized>
+static void check_quantized(const std::vector<uint64_t>& sample, const std::vector<uint64_t>& queries,
+                            const size_t full_size) {
+   const Quantized quantized(sample.begin(), sample.end(), full_size);
+   const Unquantized unquantized(sample.begin(), sample.end(), full_size);
+
+   size_t off = 0;
+   for (const auto& key : sample) {
+      const auto q = quantized(key), u = unquantized(key);
+      off += (q > u ? q - u : u - q) > 1;
+   }
+   CHECK(off == 0);
+
+   std::stringstream stream;
+   quantized.serialize(stream);
+   const auto copy = Quantized::deserialize(stream);
+   size_t mismatches = 0;
+   for (const auto& key : queries)
+      mismatches += copy(key) != quantized(key);
+   CHECK(mismatches == 0);
+
+   std::cout << Quantized::name() << " checked (" << quantized.byte_size() << " instead of "
+             << unquantized.byte_size() << " bytes)" << std::endl;
+}
+
+int main() {
+   using namespace rmi;
+
+   // Clustered keys, i.e., second level models actually differ
+   auto keys = Check::distinct_keys<uint64_t>(100'003);
+   for (auto& key : keys)
+      key = (key >> 20) * (key % 7 == 0 ? 1 : 64);
+   auto sample = keys;
+   std::sort(sample.begin(), sample.end());
+   sample.erase(std::unique(sample.begin(), sample.end()), sample.end());
+
+   auto queries = keys;
+   queries.insert(queries.end(), {0, 1, sample.front() - 1, sample.back() + 1, ~0LLU >> 12, ~0LLU});
+
+   const auto full_size = keys.size();
+   check_batch(RMIHash<uint64_t, 1000>(sample.begin(), sample.end(), full_size), queries);
+   check_batch(RMIHash<uint64_t, 1000, LinearImpl<uint64_t, double>, LeastSquaresImpl<uint64_t, double>>(
+                  sample.begin(), sample.end(), full_size),
+               queries);
+   check_batch(RMIHash<uint64_t, 1000, LinearImpl<uint64_t, double>, MonotoneLeastSquaresImpl<uint64_t, double>>(
+                  sample.begin(), sample.end(), full_size),
+               queries);
+   check_batch(QuantizedRMIHash<uint64_t, 1000, 16>(sample.begin(), sample.end(), full_size), queries);
+   check_batch(QuantizedRMIHash<uint64_t, 1000, 32>(sample.begin(), sample.end(), full_size), queries);
+
+   check_quantized<QuantizedRMIHash<uint64_t, 1000, 16>, RMIHash<uint64_t, 1000>>(sample, queries, full_size);
+   check_quantized<QuantizedRMIHash<uint64_t, 1000, 32>, RMIHash<uint64_t, 1000>>(sample, queries, full_size);
+   check_quantized<QuantizedRMIHash<uint64_t, 100'000, 16>, RMIHash<uint64_t, 100'000>>(sample, queries, full_size);
+
+   // Each topology stays well below the error bounds on this sample
+   check_topology<RMI<uint64_t, Layers<LinearImpl, LinearImpl>, Sizes<1, 1000>>>(sample, queries, 0.001, true);
+   check_topology<RMI<uint64_t, Layers<LinearImpl, LinearImpl, LinearImpl>, Sizes<1, 64, 4096>>>(sample, queries,
+                                                                                                 0.001, true);
+   check_topology<RMI<uint64_t, Layers<CubicImpl, LinearImpl>, Sizes<1, 1000>>>(sample, queries, 0.001, false);
+   check_topology<RMI<uint64_t, Layers<RadixImpl, LinearImpl>, Sizes<1, 1024>>>(sample, queries, 0.001, true);
+   check_topology<RMI<uint64_t, Layers<LinearImpl, CubicImpl, LinearImpl>, Sizes<1, 16, 4096>>>(sample, queries,
+                                                                                                0.001, false);
+   // A single linear model can not fit clustered keys well, but stays monotone
+   check_topology<RMI<uint64_t, Layers<LinearImpl>, Sizes<1>>>(sample, queries, 0.2, true);
+
+   return Check::result();
+}
@@ -0,0 +1,88 @@
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <hashing.hpp>
+#include <hashtable.hpp>
+#include <reduction.hpp>
+
+#include "include/check.hpp"
+#include "include/functors/hash_functors.hpp"
+
+/**
+ * Saves a table, reopens it via open_mmap() and checks that
+ *  1. every key is found with its payload, absent keys are not
+ *  2. inserting into the opened table works, but never reaches the snapshot file
+ *  3. opening the snapshot as a different table type is rejected
+ */
+template<class Table, class OtherTable>
+static void check_snapshot(const std::vector<uint64_t>& members, const std::vector<uint64_t>& nonmembers,
+                           const std::string& path) {
+   {
+      Table table(members.size() * 2);
+      for (const auto& key : members)
+         table.insert(key, key + 1);
+      table.save(path);
+   }
+
+   {
+      auto table = Table::open_mmap(path);
+      size_t mismatches = 0;
+      for (const auto& key : members) {
+         const auto payload = table.lookup(key);
+         mismatches += !payload.has_value() || payload.value() != key + 1;
+      }
+      CHECK(mismatches == 0);
+
+      size_t false_positives = 0;
+      for (const auto& key : nonmembers)
+         false_positives += table.lookup(key).has_value();
+      CHECK(false_positives == 0);
+
+      table.insert(nonmembers.front(), 1);
+      CHECK(table.lookup(nonmembers.front()).has_value());
+   }
+
+   {
+      const auto table = Table::open_mmap(path);
+      CHECK(!table.lookup(nonmembers.front()).has_value());
+   }
+
+   bool rejected = false;
+   try {
+      OtherTable::open_mmap(path);
+   } catch (const std::runtime_error&) {
+      rejected = true;
+   }
+   CHECK(rejected);
+
+   std::filesystem::remove(path);
+   std::cout << Table::name() << "<" << Table::hash_name() << "> snapshot round trip done" << std::endl;
+}
+
+int main() {
+   using namespace Hashtable;
+   using Reducer = Reduction::FastModulo<HASH_64>;
+
+   const auto keys = Check::distinct_keys<uint64_t>(110'000);
+   const std::vector<uint64_t> members(keys.begin(), keys.begin() + 100'000);
+   const std::vector<uint64_t> nonmembers(keys.begin() + 100'000, keys.end());
+   const auto path = (std::filesystem::temp_directory_path() / "test_snapshot.snapshot").string();
+
+   // Stateless functors store nothing, hash families (tabulation) store their seed
+   check_snapshot<Probing<uint64_t, uint64_t, MurmurFinalizer<uint64_t>, Reducer, LinearProbingFunc, 4>,
+                  Probing<uint64_t, uint64_t, XXHash3<uint64_t>, Reducer, LinearProbingFunc, 4>>(members,
+                                                                                                nonmembers, path);
+   check_snapshot<RobinhoodProbing<uint64_t, uint64_t, LargeTabulationHash<uint64_t>, Reducer, LinearProbingFunc, 4>,
+                  Probing<uint64_t, uint64_t, LargeTabulationHash<uint64_t>, Reducer, LinearProbingFunc, 4>>(
+      members, nonmembers, path);
+   check_snapshot<Cuckoo<uint64_t, uint64_t, 8, LargeTabulationHash<uint64_t>, Murmur3FinalizerCuckoo2Func, Reducer,
+                         Reducer, BalancedKicking>,
+                  Cuckoo<uint64_t, uint64_t, 8, MurmurFinalizer<uint64_t>, Murmur3FinalizerCuckoo2Func, Reducer,
+                         Reducer, BalancedKicking>>(members, nonmembers, path);
+
+   return Check::result();
+}
@@ -0,0 +1,95 @@
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <convenience.hpp>
+#include <hashing.hpp>
+#include <hashtable.hpp>
+#include <reduction.hpp>
+
+#include "include/check.hpp"
+
+/// payload stored with each key, depends on both key halves
+static uint64_t payload_of(const HASH_128& key) {
+   return static_cast<uint64_t>(key) ^ static_cast<uint64_t>(key >> 64);
+}
+
+/**
+ * Inserts members into Table and checks that all of them are found (with their
+ * payload) while nonmembers are not. Nonmembers share one key half with members,
+ * i.e., a table that does not compare all 16 key bytes reports false positives
+ */
+template<class Table>
+static void check_table(const std::vector<HASH_128>& members, const std::vector<HASH_128>& nonmembers,
+                        const std::string& variant) {
+   constexpr bool is_set = std::is_void_v<typename Table::PayloadType>;
+
+   Table table(members.size() * 10 / 8);
+   for (const auto& key : members)
+      if constexpr (is_set)
+         table.insert(key);
+      else
+         table.insert(key, payload_of(key));
+
+   size_t mismatches = 0;
+   for (const auto& key : members) {
+      const auto result = table.lookup(key);
+      if constexpr (is_set)
+         mismatches += !result;
+      else
+         mismatches += !result.has_value() || result.value() != payload_of(key);
+   }
+   CHECK(mismatches == 0);
+
+   size_t false_positives = 0;
+   for (const auto& key : nonmembers)
+      false_positives += static_cast<bool>(table.lookup(key));
+   CHECK(false_positives == 0);
+
+   std::cout << Table::name() << "<" << Table::hash_name() << "> (" << variant << ") checked" << std::endl;
+}
+
+template<class Hashfn>
+static void check_tables(const std::vector<HASH_128>& members, const std::vector<HASH_128>& nonmembers) {
+   using namespace Hashtable;
+   using Reducer = Reduction::FastModulo<HASH_64>;
+
+   check_table<Probing<HASH_128, uint64_t, Hashfn, Reducer, LinearProbingFunc>>(members, nonmembers,
+                                                                                "payload, sentinel occupancy");
+   check_table<Probing<HASH_128, uint64_t, Hashfn, Reducer, LinearProbingFunc, 4, std::numeric_limits<HASH_128>::max(),
+                       SlotOccupancy::Bitmap>>(members, nonmembers, "payload, bitmap occupancy");
+   // Set buckets span one register for 4 (AVX-512), 2 (AVX2) or 1 (SSE4.1) keys
+   check_table<Probing<HASH_128, void, Hashfn, Reducer, LinearProbingFunc, 4>>(members, nonmembers,
+                                                                               "set, 4 per bucket");
+   check_table<Probing<HASH_128, void, Hashfn, Reducer, LinearProbingFunc, 2>>(members, nonmembers,
+                                                                               "set, 2 per bucket");
+   check_table<Probing<HASH_128, void, Hashfn, Reducer, LinearProbingFunc, 1>>(members, nonmembers,
+                                                                               "set, 1 per bucket");
+
+   check_table<Cuckoo<HASH_128, uint64_t, 8, Hashfn, DoubleHashingCuckoo2Func, Reducer, Reducer, BalancedKicking>>(
+      members, nonmembers, "payload, 8 per bucket");
+   check_table<Cuckoo<HASH_128, void, 4, Hashfn, DoubleHashingCuckoo2Func, Reducer, Reducer, BalancedKicking>>(
+      members, nonmembers, "set, 4 per bucket");
+}
+
+int main() {
+   // (tenant_id, object_id) pairs: 50 tenants with the same 1000 objects each
+   const auto objects = Check::distinct_keys<uint64_t>(1000);
+   std::vector<HASH_128> members, nonmembers;
+   for (uint64_t tenant = 1; tenant <= 60; tenant++)
+      for (const auto& object : objects)
+         (tenant <= 50 ? members : nonmembers).push_back(to_hash128(tenant, object));
+   // halves swapped, i.e., equal to a member in one 64-bit lane after a lane mixup
+   for (size_t i = 0; i < 1000; i++)
+      nonmembers.push_back(to_hash128(objects[i], 1 + i % 50));
+
+   check_tables<MurmurFinalizer<HASH_128>>(members, nonmembers);
+   check_tables<XXHash3<HASH_128>>(members, nonmembers);
+   if (Cpu::has_aes())
+      check_tables<AquaHash<HASH_128>>(members, nonmembers);
+
+   return Check::result();
+}
@@ -14,15 +14,22 @@
 
 using Args = BenchmarkArgs::HashThroughputArgs;
 
-template<class Hashfn, class Reducerfn, class Data>
+/**
+ * @tparam Batched whether to hash via hash_batch() (vectorized if supported),
+ *    reported as hash "<name>_batch". Batched measurements run on the
+ *    instruction set selected at runtime, scalar ones on the build's target
+ */
+template<class Hashfn, class Reducerfn, bool Batched = false, class Data>
 static void
 measure(const std::string& dataset_name, const std::vector<Data>& dataset, CSV& outfile, std::mutex& iomutex) {
    const auto str = [](auto s) { return std::to_string(s); };
+   const std::string hash_name = Batched ? Hashfn::name() + "_batch" : Hashfn::name();
    std::map<std::string, std::string> datapoint({
       {"dataset", dataset_name},
       {"numelements", str(dataset.size())},
-      {"hash", Hashfn::name()},
+      {"hash", hash_name},
       {"reducer", Reducerfn::name()},
+      {"isa", Batched ? Cpu::isa_name() : Cpu::name(Cpu::static_isa())},
    });
 
    if (outfile.exists(datapoint)) {
@@ -41,11 +48,12 @@ measure(const std::string& dataset_name, const std::vector<Data>& dataset, CSV&
    }
 
    // Measure & log
-   const auto stats = Benchmark::measure_throughput<Hashfn, Reducerfn>(dataset);
+   const auto stats = Batched ? Benchmark::measure_batch_throughput<Hashfn, Reducerfn>(dataset)
+                              : Benchmark::measure_throughput<Hashfn, Reducerfn>(dataset);
 #ifdef VERBOSE
    {
       std::unique_lock<std::mutex> lock(iomutex);
-      std::cout << std::setw(55) << std::right << Reducerfn::name() + "(" + Hashfn::name() + "): "
+      std::cout << std::setw(55) << std::right << Reducerfn::name() + "(" + hash_name + "): "
                 << relative_to(stats.average_total_inference_reduction_ns, dataset.size()) << " ns/key on average for "
                 << stats.repeatCnt << " repetitions ("
                 << nanoseconds_to_seconds(stats.average_total_inference_reduction_ns) << " s total)" << std::endl;
@@ -61,15 +69,17 @@ measure(const std::string& dataset_name, const std::vector<Data>& dataset, CSV&
    outfile.write(datapoint);
 };
 
-template<class Hashfn, class Dataset>
+template<class Hashfn, bool Batched = false, class Dataset>
 static void measure64(const std::string& dataset_name, const Dataset& dataset, CSV& outfile, std::mutex& iomutex) {
    using namespace Reduction;
-   measure<Hashfn, DoNothing<HASH_64>>(dataset_name, dataset, outfile, iomutex);
-   measure<Hashfn, Fastrange<HASH_32>>(dataset_name, dataset, outfile, iomutex);
-   measure<Hashfn, Fastrange<HASH_64>>(dataset_name, dataset, outfile, iomutex);
-   measure<Hashfn, Modulo<HASH_64>>(dataset_name, dataset, outfile, iomutex);
-   measure<Hashfn, FastModulo<HASH_64>>(dataset_name, dataset, outfile, iomutex);
-   measure<Hashfn, BranchlessFastModulo<HASH_64>>(dataset_name, dataset, outfile, iomutex);
+   measure<Hashfn, DoNothing<HASH_64>, Batched>(dataset_name, dataset, outfile, iomutex);
+   measure<Hashfn, Fastrange<HASH_32>, Batched>(dataset_name, dataset, outfile, iomutex);
+   measure<Hashfn, Fastrange<HASH_64>, Batched>(dataset_name, dataset, outfile, iomutex);
+   measure<Hashfn, Modulo<HASH_64>, Batched>(dataset_name, dataset, outfile, iomutex);
+   measure<Hashfn, FastModulo<HASH_64>, Batched>(dataset_name, dataset, outfile, iomutex);
+   measure<Hashfn, BranchlessFastModulo<HASH_64>, Batched>(dataset_name, dataset, outfile, iomutex);
+   measure<Hashfn, DirectFastMod<HASH_32>, Batched>(dataset_name, dataset, outfile, iomutex);
+   measure<Hashfn, DirectFastMod<HASH_64>, Batched>(dataset_name, dataset, outfile, iomutex);
 }
 
 template<class Hashfn, class Dataset>
@@ -92,11 +102,17 @@ int main(int argc, char* argv[]) {
                      "numelements",
                      "hash",
                      "reducer",
+                     "isa",
                      "nanoseconds_total",
                      "nanoseconds_per_key",
                      "benchmark_repeat_cnt",
                   });
 
+#ifdef VERBOSE
+      std::cout << "Vectorized kernels use " << Cpu::isa_name() << ", scalar code is compiled for "
+                << Cpu::name(Cpu::static_isa()) << (Cpu::has_aes() ? " (aes)" : " (no aes)") << std::endl;
+#endif
+
       // Worker pool for speeding up the benchmarking
       std::mutex iomutex;
       std_ext::counting_semaphore cpu_blocker(args.max_threads);
@@ -143,15 +159,34 @@ int main(int argc, char* argv[]) {
             measure64<SmallTabulationHash<Data>>(name, dataset, outfile, iomutex);
             measure64<MediumTabulationHash<Data>>(name, dataset, outfile, iomutex);
             measure64<LargeTabulationHash<Data>>(name, dataset, outfile, iomutex);
+            measure64<CompactTabulationHash<Data>>(name, dataset, outfile, iomutex);
+            measure64<TwistedTabulationHash<Data>>(name, dataset, outfile, iomutex);
 
             measure64<CityHash64<Data>>(name, dataset, outfile, iomutex);
             measure128<CityHash128<Data>>(name, dataset, outfile, iomutex);
 
-            measure64<MeowHash64<Data, 0>>(name, dataset, outfile, iomutex);
-            measure64<MeowHash64<Data, 1>>(name, dataset, outfile, iomutex);
-
-            measure64<AquaHash<Data, 0>>(name, dataset, outfile, iomutex);
-            measure64<AquaHash<Data, 1>>(name, dataset, outfile, iomutex);
+            if (Cpu::has_aes()) {
+               measure64<MeowHash64<Data, 0>>(name, dataset, outfile, iomutex);
+               measure64<MeowHash64<Data, 1>>(name, dataset, outfile, iomutex);
+
+               measure64<AquaHash<Data, 0>>(name, dataset, outfile, iomutex);
+               measure64<AquaHash<Data, 1>>(name, dataset, outfile, iomutex);
+            }
+
+            // Batched hashing, vectorized for functors that provide a hash_batch() kernel
+            measure64<FibonacciHash64, true>(name, dataset, outfile, iomutex);
+            measure64<FibonacciPrimeShiftHash64<p>, true>(name, dataset, outfile, iomutex);
+            measure64<MultAddHash64, true>(name, dataset, outfile, iomutex);
+            measure64<MurmurFinalizer<Data>, true>(name, dataset, outfile, iomutex);
+            measure64<XXHash3<Data>, true>(name, dataset, outfile, iomutex);
+            measure64<SmallTabulationHash<Data>, true>(name, dataset, outfile, iomutex);
+            measure64<LargeTabulationHash<Data>, true>(name, dataset, outfile, iomutex);
+            measure64<CompactTabulationHash<Data>, true>(name, dataset, outfile, iomutex);
+            measure64<TwistedTabulationHash<Data>, true>(name, dataset, outfile, iomutex);
+            if (Cpu::has_aes()) {
+               measure64<MeowHash64<Data, 0>, true>(name, dataset, outfile, iomutex);
+               measure64<AquaHash<Data, 0>, true>(name, dataset, outfile, iomutex);
+            }
 
             cpu_blocker.release();
          }));
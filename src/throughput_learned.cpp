@@ -2,6 +2,7 @@
 #include <iomanip>
 #include <iostream>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <thread>
 #include <vector>
@@ -13,21 +14,69 @@
 #include "include/args.hpp"
 #include "include/benchmark.hpp"
 #include "include/csv.hpp"
+#include "include/sample.hpp"
 
 using Args = BenchmarkArgs::LearnedThroughputArgs;
 
+/// Trained models are loaded from/added to this cache, if configured
+static std::optional<learned::ModelCache> model_cache;
+
+/**
+ * Sorted sample of a dataset, shared by all models measured on it. Without a
+ * model cache, the sample is drawn while the dataset is sorted on load, i.e.,
+ * needs no sorting. With a model cache, it is drawn (and sorted) on first use,
+ * i.e., only once a model is not cached
+ */
+template<class Data>
+struct LazySample {
+   LazySample(const std::vector<Data>& dataset, const double rate) : dataset(dataset), rate(rate) {}
+
+   LazySample(const std::vector<Data>& dataset, const double rate, std::vector<Data>&& keys, const uint64_t ns)
+      : dataset(dataset), rate(rate), keys(std::move(keys)), ns(ns), drawn(true) {}
+
+   /**
+    * @return sorted sample keys, drawn on first call
+    */
+   const std::vector<Data>& get() {
+      if (!drawn) {
+         const auto start_time = std::chrono::steady_clock::now();
+         keys = Sampling::sorted_sample(dataset, rate);
+         ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time)
+               .count());
+         drawn = true;
+      }
+      return keys;
+   }
+
+   /**
+    * @return nanoseconds it took to draw the sample
+    */
+   uint64_t nanoseconds() const {
+      return ns;
+   }
+
+  private:
+   const std::vector<Data>& dataset;
+   const double rate;
+   std::vector<Data> keys;
+   uint64_t ns = 0;
+   bool drawn = false;
+};
+
 const std::vector<std::string> csv_columns = {"dataset",
                                               "numelements",
                                               "model",
                                               "reducer",
                                               "sample_size",
+                                              "build_threads",
                                               "model_count",
+                                              "model_bytes",
                                               "sample_nanoseconds_total",
                                               "sample_nanoseconds_per_key",
-                                              "prepare_nanoseconds_total",
-                                              "prepare_nanoseconds_per_key",
                                               "build_nanoseconds_total",
                                               "build_nanoseconds_per_key",
+                                              "model_cached",
                                               "hashing_nanoseconds_total",
                                               "hashing_nanoseconds_per_key",
                                               "total_nanoseconds",
@@ -35,9 +84,8 @@ const std::vector<std::string> csv_columns = {"dataset",
                                               "benchmark_repeat_cnt"};
 
 template<class Hashfn, class Reducerfn, class Data>
-static void measure(const std::string& dataset_name, const std::vector<Data>& dataset, const std::vector<Data>& sample,
-                    const double& sample_size, const uint64_t& sample_ns, const uint64_t& prepare_ns, CSV& outfile,
-                    std::mutex& iomutex) {
+static void measure(const std::string& dataset_name, const std::vector<Data>& dataset, LazySample<Data>& sample,
+                    const double& sample_size, CSV& outfile, std::mutex& iomutex, const size_t build_threads = 1) {
    const size_t N = dataset.size();
 
    const auto str = [](auto s) { return std::to_string(s); };
@@ -45,7 +93,8 @@ static void measure(const std::string& dataset_name, const std::vector<Data>& da
                                                  {"numelements", str(dataset.size())},
                                                  {"model", Hashfn::name()},
                                                  {"reducer", Reducerfn::name()},
-                                                 {"sample_size", str(sample_size)}});
+                                                 {"sample_size", str(sample_size)},
+                                                 {"build_threads", str(build_threads)}});
 
    if (outfile.exists(datapoint)) {
       std::unique_lock<std::mutex> lock(iomutex);
@@ -62,17 +111,33 @@ static void measure(const std::string& dataset_name, const std::vector<Data>& da
       return;
    }
 
-   // Build the model (e2e time)
+   // Build the model (e2e time), or load it from the model cache. Build scalability is always measured by training
+   const bool use_cache = model_cache.has_value() && build_threads == 1;
+   auto cached = use_cache ? model_cache->load<Hashfn>(dataset, sample_size, N) : std::nullopt;
+   // Cached models need no sample, i.e., sampling neither happens nor counts. Otherwise draw it (if not done
+   // already) before the build time is taken
+   if (!cached)
+      sample.get();
+   const uint64_t sample_ns = cached ? 0 : sample.nanoseconds();
    auto start_time = std::chrono::steady_clock::now();
-   Hashfn hashfn(sample.begin(), sample.end(), N);
+   auto hashfn = cached ? std::move(*cached) : [&] {
+      const auto& keys = sample.get();
+      // models that support parallel training are built with build_threads threads
+      if constexpr (std::is_constructible_v<Hashfn, decltype(keys.begin()), decltype(keys.end()), size_t, size_t>)
+         return Hashfn(keys.begin(), keys.end(), N, build_threads);
+      else
+         return Hashfn(keys.begin(), keys.end(), N);
+   }();
    uint64_t build_ns = static_cast<uint64_t>(
       std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count());
+   if (use_cache && !cached)
+      model_cache->save(hashfn, dataset, sample_size, N);
 
    // Measure throughput
    const auto stats = Benchmark::measure_throughput<Hashfn, Reducerfn>(dataset, hashfn);
 
    // Sum up for easier access
-   const auto total_ns = sample_ns + prepare_ns + build_ns + stats.average_total_inference_reduction_ns;
+   const auto total_ns = sample_ns + build_ns + stats.average_total_inference_reduction_ns;
 
 #ifdef VERBOSE
    {
@@ -84,12 +149,12 @@ static void measure(const std::string& dataset_name, const std::vector<Data>& da
 #endif
 
    datapoint.emplace("model_count", str(hashfn.model_count()));
+   datapoint.emplace("model_bytes", str(hashfn.byte_size()));
    datapoint.emplace("sample_nanoseconds_total", str(sample_ns));
    datapoint.emplace("sample_nanoseconds_per_key", str(relative_to(sample_ns, dataset.size())));
-   datapoint.emplace("prepare_nanoseconds_total", str(prepare_ns));
-   datapoint.emplace("prepare_nanoseconds_per_key", str(relative_to(prepare_ns, dataset.size())));
    datapoint.emplace("build_nanoseconds_total", str(build_ns));
    datapoint.emplace("build_nanoseconds_per_key", str(relative_to(build_ns, dataset.size())));
+   datapoint.emplace("model_cached", str(cached.has_value()));
    datapoint.emplace("hashing_nanoseconds_total", str(stats.average_total_inference_reduction_ns));
    datapoint.emplace("hashing_nanoseconds_per_key",
                      str(relative_to(stats.average_total_inference_reduction_ns, dataset.size())));
@@ -101,138 +166,154 @@ static void measure(const std::string& dataset_name, const std::vector<Data>& da
    outfile.write(datapoint);
 }
 
+/**
+ * @param sample sorted sample, drawn from the sorted dataset or on demand. There is no separate prepare (sort) phase
+ *    anymore, hence no prepare_nanoseconds_* columns: sorting the sample is part of sample_nanoseconds_*
+ */
 template<class Data>
 static void benchmark(const std::string& dataset_name, const std::vector<Data>& dataset, const double sample_chance,
-                      CSV& outfile, std::mutex& iomutex) {
-   uint64_t sample_ns = 0, prepare_ns = 0;
-
-   // Take a random sample
-   std::vector<Data> sample;
-   {
-      auto start_time = std::chrono::steady_clock::now();
-      if (sample_chance == 1.0) {
-         sample = dataset;
-      } else {
-         sample.reserve(sample_chance * dataset.size());
-         std::random_device seed_gen;
-         std::default_random_engine gen(seed_gen());
-         std::uniform_real_distribution<double> dist(0, 1);
-
-         for (size_t i = 0; i < dataset.size(); i++)
-            if (dist(gen) < sample_chance)
-               sample.push_back(dataset[i]);
-      }
-      sample_ns = static_cast<uint64_t>(
-         std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count());
-   }
-
-   // Prepare the sample
-   {
-      auto start_time = std::chrono::steady_clock::now();
-      std::sort(sample.begin(), sample.end());
-      prepare_ns = static_cast<uint64_t>(
-         std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count());
-   }
-
+                      LazySample<Data>& sample, CSV& outfile, std::mutex& iomutex) {
    /// RMI
-   measure<rmi::RMIHash<Data, 10>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, sample_ns,
-                                                             prepare_ns, outfile, iomutex);
-   measure<rmi::RMIHash<Data, 100>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, sample_ns,
-                                                              prepare_ns, outfile, iomutex);
-   measure<rmi::RMIHash<Data, 1000>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, sample_ns,
-                                                               prepare_ns, outfile, iomutex);
-   measure<rmi::RMIHash<Data, 10000>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, sample_ns,
-                                                                prepare_ns, outfile, iomutex);
-   measure<rmi::RMIHash<Data, 100000>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                 sample_ns, prepare_ns, outfile, iomutex);
-   measure<rmi::RMIHash<Data, 1000000>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                  sample_ns, prepare_ns, outfile, iomutex);
+   measure<rmi::RMIHash<Data, 10>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, outfile,
+                                                             iomutex);
+   measure<rmi::RMIHash<Data, 100>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, outfile,
+                                                              iomutex);
+   measure<rmi::RMIHash<Data, 1000>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, outfile,
+                                                               iomutex);
+   measure<rmi::RMIHash<Data, 10000>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, outfile,
+                                                                iomutex);
+   measure<rmi::RMIHash<Data, 100000>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, outfile,
+                                                                 iomutex);
+   measure<rmi::RMIHash<Data, 1000000>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, outfile,
+                                                                  iomutex);
    measure<rmi::RMIHash<Data, 10000000>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                   sample_ns, prepare_ns, outfile, iomutex);
+                                                                   outfile, iomutex);
+
+   /// RMI with quantized second level models
+   measure<rmi::QuantizedRMIHash<Data, 100000, 16>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample,
+                                                                              sample_chance, outfile, iomutex);
+   measure<rmi::QuantizedRMIHash<Data, 1000000, 16>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample,
+                                                                               sample_chance, outfile, iomutex);
+   measure<rmi::QuantizedRMIHash<Data, 10000000, 16>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample,
+                                                                                sample_chance, outfile, iomutex);
+   measure<rmi::QuantizedRMIHash<Data, 100000, 32>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample,
+                                                                              sample_chance, outfile, iomutex);
+   measure<rmi::QuantizedRMIHash<Data, 1000000, 32>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample,
+                                                                               sample_chance, outfile, iomutex);
+   measure<rmi::QuantizedRMIHash<Data, 10000000, 32>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample,
+                                                                                sample_chance, outfile, iomutex);
+
+   /// RMI build scalability, i.e., second level trained by 2, 4, ... threads
+   for (size_t threads = 2; threads <= std::thread::hardware_concurrency(); threads *= 2) {
+      measure<rmi::RMIHash<Data, 100000>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
+                                                                    outfile, iomutex, threads);
+      measure<rmi::RMIHash<Data, 1000000>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
+                                                                     outfile, iomutex, threads);
+      measure<rmi::RMIHash<Data, 10000000>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
+                                                                      outfile, iomutex, threads);
+   }
+
+   /// RMI topologies
+   measure<rmi::RMI<Data, rmi::Layers<rmi::LinearImpl, rmi::LinearImpl, rmi::LinearImpl>, rmi::Sizes<1, 1024, 1 << 20>>,
+           Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, outfile, iomutex);
+   measure<rmi::RMI<Data, rmi::Layers<rmi::CubicImpl, rmi::LinearImpl>, rmi::Sizes<1, 1 << 20>>,
+           Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, outfile, iomutex);
+   measure<rmi::RMI<Data, rmi::Layers<rmi::RadixImpl, rmi::LinearImpl>, rmi::Sizes<1, 1 << 20>>,
+           Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, outfile, iomutex);
 
    /// RadixSpline
    measure<rs::RadixSplineHash<Data, 8, 1>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                      sample_ns, prepare_ns, outfile, iomutex);
+                                                                      outfile, iomutex);
    measure<rs::RadixSplineHash<Data, 12, 1>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                       sample_ns, prepare_ns, outfile, iomutex);
+                                                                       outfile, iomutex);
    measure<rs::RadixSplineHash<Data, 16, 1>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                       sample_ns, prepare_ns, outfile, iomutex);
+                                                                       outfile, iomutex);
    measure<rs::RadixSplineHash<Data, 18, 1>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                       sample_ns, prepare_ns, outfile, iomutex);
+                                                                       outfile, iomutex);
    measure<rs::RadixSplineHash<Data, 20, 1>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                       sample_ns, prepare_ns, outfile, iomutex);
+                                                                       outfile, iomutex);
 
    measure<rs::RadixSplineHash<Data, 8, 8>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                      sample_ns, prepare_ns, outfile, iomutex);
+                                                                      outfile, iomutex);
    measure<rs::RadixSplineHash<Data, 12, 8>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                       sample_ns, prepare_ns, outfile, iomutex);
+                                                                       outfile, iomutex);
    measure<rs::RadixSplineHash<Data, 16, 8>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                       sample_ns, prepare_ns, outfile, iomutex);
+                                                                       outfile, iomutex);
    measure<rs::RadixSplineHash<Data, 18, 8>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                       sample_ns, prepare_ns, outfile, iomutex);
+                                                                       outfile, iomutex);
    measure<rs::RadixSplineHash<Data, 20, 8>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                       sample_ns, prepare_ns, outfile, iomutex);
+                                                                       outfile, iomutex);
 
    measure<rs::RadixSplineHash<Data, 8, 16>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                       sample_ns, prepare_ns, outfile, iomutex);
+                                                                       outfile, iomutex);
    measure<rs::RadixSplineHash<Data, 12, 16>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                        sample_ns, prepare_ns, outfile, iomutex);
+                                                                        outfile, iomutex);
    measure<rs::RadixSplineHash<Data, 16, 16>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                        sample_ns, prepare_ns, outfile, iomutex);
+                                                                        outfile, iomutex);
    measure<rs::RadixSplineHash<Data, 18, 16>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                        sample_ns, prepare_ns, outfile, iomutex);
+                                                                        outfile, iomutex);
    measure<rs::RadixSplineHash<Data, 20, 16>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                        sample_ns, prepare_ns, outfile, iomutex);
+                                                                        outfile, iomutex);
 
    measure<rs::RadixSplineHash<Data, 8, 32>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                       sample_ns, prepare_ns, outfile, iomutex);
+                                                                       outfile, iomutex);
    measure<rs::RadixSplineHash<Data, 12, 32>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                        sample_ns, prepare_ns, outfile, iomutex);
+                                                                        outfile, iomutex);
    measure<rs::RadixSplineHash<Data, 16, 32>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                        sample_ns, prepare_ns, outfile, iomutex);
+                                                                        outfile, iomutex);
    measure<rs::RadixSplineHash<Data, 18, 32>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                        sample_ns, prepare_ns, outfile, iomutex);
+                                                                        outfile, iomutex);
    measure<rs::RadixSplineHash<Data, 20, 32>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
-                                                                        sample_ns, prepare_ns, outfile, iomutex);
+                                                                        outfile, iomutex);
+
+   /// RadixSpline build scalability, i.e., spline built by 2, 4, ... threads
+   for (size_t threads = 2; threads <= std::thread::hardware_concurrency(); threads *= 2) {
+      measure<rs::RadixSplineHash<Data, 18, 32>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
+                                                                           outfile, iomutex, threads);
+      measure<rs::RadixSplineHash<Data, 20, 8>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
+                                                                          outfile, iomutex, threads);
+   }
 
    //   /// PGM (eps_rec 4)
-   //   measure<PGMHash<Data, 256, 4>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, sample_ns, prepare_ns,
+   //   measure<PGMHash<Data, 256, 4>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
    //                                                            outfile, iomutex);
-   //   measure<PGMHash<Data, 128, 4>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, sample_ns, prepare_ns,
+   //   measure<PGMHash<Data, 128, 4>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
    //                                                            outfile, iomutex);
-   //   measure<PGMHash<Data, 64, 4>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, sample_ns, prepare_ns,
+   //   measure<PGMHash<Data, 64, 4>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
    //                                                           outfile, iomutex);
-   //   measure<PGMHash<Data, 16, 4>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, sample_ns, prepare_ns,
+   //   measure<PGMHash<Data, 16, 4>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
    //                                                           outfile, iomutex);
-   //   measure<PGMHash<Data, 4, 4>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, sample_ns, prepare_ns, outfile,
+   //   measure<PGMHash<Data, 4, 4>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, outfile,
    //                                                          iomutex);
    //   /// PGM (eps_rec 1)
-   //   measure<PGMHash<Data, 256, 1>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, sample_ns, prepare_ns,
+   //   measure<PGMHash<Data, 256, 1>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
    //                                                            outfile, iomutex);
-   //   measure<PGMHash<Data, 128, 1>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, sample_ns, prepare_ns,
+   //   measure<PGMHash<Data, 128, 1>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
    //                                                            outfile, iomutex);
-   //   measure<PGMHash<Data, 64, 1>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, sample_ns, prepare_ns,
+   //   measure<PGMHash<Data, 64, 1>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
    //                                                           outfile, iomutex);
-   //   measure<PGMHash<Data, 16, 1>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, sample_ns, prepare_ns,
+   //   measure<PGMHash<Data, 16, 1>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
    //                                                           outfile, iomutex);
-   //   measure<PGMHash<Data, 4, 1>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, sample_ns, prepare_ns, outfile,
+   //   measure<PGMHash<Data, 4, 1>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, outfile,
    //                                                          iomutex);
    //   /// PGM (eps_rec 0)
-   //   measure<PGMHash<Data, 256, 0>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, sample_ns, prepare_ns,
+   //   measure<PGMHash<Data, 256, 0>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
    //                                                            outfile, iomutex);
-   //   measure<PGMHash<Data, 128, 0>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, sample_ns, prepare_ns,
+   //   measure<PGMHash<Data, 128, 0>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
    //                                                            outfile, iomutex);
-   //   measure<PGMHash<Data, 64, 0>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, sample_ns, prepare_ns,
+   //   measure<PGMHash<Data, 64, 0>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
    //                                                           outfile, iomutex);
-   //   measure<PGMHash<Data, 16, 0>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, sample_ns, prepare_ns,
+   //   measure<PGMHash<Data, 16, 0>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance,
    //                                                           outfile, iomutex);
-   //   measure<PGMHash<Data, 4, 0>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, sample_ns, prepare_ns, outfile,
+   //   measure<PGMHash<Data, 4, 0>, Reduction::Clamp<size_t>>(dataset_name, dataset, sample, sample_chance, outfile,
    //                                                          iomutex);
 }
 
 int main(int argc, char* argv[]) {
    try {
       Args args(argc, argv);
+      if (!args.model_cache.empty())
+         model_cache.emplace(args.model_cache);
 #if VERBOSE
       auto spawned_thread_count = args.datasets.size();
       const auto max_thread_count = std::min(static_cast<size_t>(args.max_threads), spawned_thread_count);
@@ -279,8 +360,23 @@ int main(int argc, char* argv[]) {
             threads.emplace_back(std::thread([&, it, sample_size] {
                cpu_blocker.aquire();
 
-               auto dataset = it.load(iomutex);
-               benchmark(it.name(), dataset, sample_size, outfile, iomutex);
+               // Without model cache, sample while the dataset is sorted, i.e., the sample needs no sorting.
+               // Otherwise only sample once a model is not cached, see LazySample
+               std::vector<uint64_t> keys;
+               uint64_t sample_ns = 0;
+               auto dataset = it.load(iomutex, [&](const std::vector<uint64_t>& sorted) {
+                  if (model_cache.has_value())
+                     return;
+                  const auto start_time = std::chrono::steady_clock::now();
+                  keys = Sampling::bernoulli(sorted, sample_size);
+                  sample_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                       std::chrono::steady_clock::now() - start_time)
+                                                       .count());
+               });
+               auto sample = model_cache.has_value()
+                  ? LazySample<uint64_t>(dataset, sample_size)
+                  : LazySample<uint64_t>(dataset, sample_size, std::move(keys), sample_ns);
+               benchmark(it.name(), dataset, sample_size, sample, outfile, iomutex);
 
                cpu_blocker.release();
             }));